@@ -0,0 +1,108 @@
+/**
+ * @file wlog_bench_alloc.cpp
+ * @brief 写日志路径上的malloc/free次数与长日志的单条耗时：短日志、超过栈上缓冲与暂存缓冲的长日志、logXXXN、logText混合写.
+ * <pre>编译运行：
+		g++ -O2 -I../inc wlog_bench_alloc.cpp -o wlog_bench_alloc -lpthread && ./wlog_bench_alloc [每线程轮数] [线程数]
+		还可以加-DWLOG_TO=WLOG_TO_MMAP、-DWLOG_TO='(WLOG_TO_CONSOLE|WLOG_TO_FILE)' -DWLOG_CONSOLE_TYPES=0、-DWLOG_JSON=1、
+		-DWLOG_BINARY=1、-std=c++17(同时测logInfoF)等对比其他输出。
+		替换了malloc、calloc、realloc、free，每个线程先不计数地把同样的内容写一轮(第一次遇到长日志、新线程的暂存缓冲等)，
+		之后计数，稳定运行时"allocations"与"frees"都应为0，不为0时输出FAILED并返回1。
+	</pre>
+ * @os linux
+ */
+#ifndef WLOG_FILE_NAME
+	#define WLOG_FILE_NAME "wlog_bench_alloc.log"
+#endif
+#include <wlog.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <string>
+
+extern "C" void* __libc_malloc(size_t nSize);
+extern "C" void* __libc_calloc(size_t nCount, size_t nSize);
+extern "C" void* __libc_realloc(void* pData, size_t nSize);
+extern "C" void __libc_free(void* pData);
+
+static __thread int g_bCounting = 0;
+static unsigned long g_nAllocs = 0;
+static unsigned long g_nFrees = 0;
+
+extern "C" void* malloc(size_t nSize) {
+	if (g_bCounting) __atomic_add_fetch(&g_nAllocs, 1, __ATOMIC_RELAXED);
+	return __libc_malloc(nSize);
+}
+extern "C" void* calloc(size_t nCount, size_t nSize) {
+	if (g_bCounting) __atomic_add_fetch(&g_nAllocs, 1, __ATOMIC_RELAXED);
+	return __libc_calloc(nCount, nSize);
+}
+extern "C" void* realloc(void* pData, size_t nSize) {
+	if (g_bCounting) __atomic_add_fetch(&g_nAllocs, 1, __ATOMIC_RELAXED);
+	return __libc_realloc(pData, nSize);
+}
+extern "C" void free(void* pData) {
+	if (g_bCounting && NULL != pData) __atomic_add_fetch(&g_nFrees, 1, __ATOMIC_RELAXED);
+	__libc_free(pData);
+}
+
+static unsigned long g_nRounds = 20000;
+static std::string g_strMedium(2000, 'm');
+static std::string g_strLarge(40000, 'L');
+static std::string g_strHuge(300000, 'H');
+static double g_fLargeNs[64];
+
+static double bench_now_ns() {
+	struct timespec tsNow;
+	clock_gettime(CLOCK_MONOTONIC, &tsNow);
+	return tsNow.tv_sec * 1e9 + tsNow.tv_nsec;
+}
+
+static void bench_large(unsigned long nIdx) {
+	logError("large %lu %s", nIdx, g_strLarge.c_str());
+}
+
+static void bench_round(unsigned long nIdx) {
+	logInfo("short %lu", nIdx);
+	logWarning("medium %lu %s", nIdx, g_strMedium.c_str());
+	logDebugN("%02X ", g_strMedium.c_str(), 1500, "dump %lu", nIdx);
+	logText("text %s\n", g_strMedium.c_str());
+	if (0 == nIdx % 10) bench_large(nIdx);
+	if (0 == nIdx % 1000) logNotice("huge %lu %s", nIdx, g_strHuge.c_str());
+	#if defined(__cplusplus) && (__cplusplus >= 201703L)
+		logInfoF("fmt {} {}", nIdx, g_strMedium.c_str());
+	#endif
+}
+
+static void* bench_thread(void* pArg) {
+	unsigned long nThread = (unsigned long)pArg;
+	for (unsigned long nIdx = 0; nIdx < 1000; ++nIdx) bench_round(nIdx);
+	g_bCounting = 1;
+	for (unsigned long nIdx = 0; nIdx < g_nRounds; ++nIdx) bench_round(nIdx);
+	double fStart = bench_now_ns();
+	for (unsigned long nIdx = 0; nIdx < 1000; ++nIdx) bench_large(nIdx);
+	double fCost = (bench_now_ns() - fStart) / 1000;
+	g_bCounting = 0;
+	g_fLargeNs[nThread] = fCost;
+	return NULL;
+}
+
+int main(int argc, char* argv[]) {
+	g_nRounds = (argc > 1) ? strtoul(argv[1], NULL, 10) : 20000;
+	unsigned int nThreads = (argc > 2) ? (unsigned int)strtoul(argv[2], NULL, 10) : 4;
+	if (nThreads < 1) nThreads = 1;
+	remove(WLOG_FILE_NAME);
+	pthread_t hThreads[64];
+	if (nThreads > 64) nThreads = 64;
+	for (unsigned int nIdx = 0; nIdx < nThreads; ++nIdx) pthread_create(&hThreads[nIdx], NULL, bench_thread, (void*)(unsigned long)nIdx);
+	for (unsigned int nIdx = 0; nIdx < nThreads; ++nIdx) pthread_join(hThreads[nIdx], NULL);
+	wlogFlush();
+	double fLargeNs = 0;
+	for (unsigned int nIdx = 0; nIdx < nThreads; ++nIdx) fLargeNs += g_fLargeNs[nIdx] / nThreads;
+	fprintf(stderr, "threads %u, rounds %lu per thread\n", nThreads, g_nRounds);
+	fprintf(stderr, "allocations %lu, frees %lu\n", g_nAllocs, g_nFrees);
+	fprintf(stderr, "40K record   %.1f ns/record\n", fLargeNs);
+	if (0 != g_nAllocs || 0 != g_nFrees) {
+		fprintf(stderr, "FAILED: steady-state logging still calls malloc/free\n");
+		return 1;
+	}
+	return 0;
+}
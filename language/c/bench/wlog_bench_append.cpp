@@ -0,0 +1,110 @@
+/**
+ * @file wlog_bench_append.cpp
+ * @brief 多个进程同时追加写同一个日志文件：stdio(fopen "a" + fprintf)与wlog同步模式(O_APPEND，每批一次write)的吞吐量与日志完整性对比.
+ * <pre>编译运行：
+		g++ -O2 -I../inc wlog_bench_append.cpp -o bench_append -lpthread
+		g++ -O2 -I../inc -DWLOG_FLUSH_RECORDS=0 -DWLOG_FLUSH_BYTES=65536 wlog_bench_append.cpp -o bench_append_batch -lpthread
+		./bench_append <stdio|stdio-batch|wlog> [进程数] [每进程条数] [每条日志内容的字节数]
+		stdio每条fprintf后fflush(以前的默认行为)，stdio-batch只在stdio缓冲满时写出，wlog按编译时的WLOG_FLUSH_XXX分组。
+		计时包括所有进程退出为止。之后逐行检查文件，输出完整的条数与被其他进程的日志截断、插入的行数；
+		每条日志超过stdio缓冲(BUFSIZ)或stdio-batch时stdio会把一条日志分成几次write，与其他进程的日志交错。
+	</pre>
+ * @os linux
+ */
+#ifndef WLOG_FILE_NAME
+	#define WLOG_FILE_NAME "wlog_bench_append.log"
+#endif
+#include <wlog.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <string>
+
+static double bench_now_ns() {
+	struct timespec tsNow;
+	clock_gettime(CLOCK_MONOTONIC, &tsNow);
+	return tsNow.tv_sec * 1e9 + tsNow.tv_nsec;
+}
+
+static void bench_child(const char* szMode, unsigned long nRecords, const std::string& strPayload) {
+	int nPid = (int)getpid();
+	if (0 == strcmp(szMode, "wlog")) {
+		for (unsigned long nIdx = 0; nIdx < nRecords; ++nIdx) {
+			logInfo("pid %d seq %lu %s end", nPid, nIdx, strPayload.c_str());
+		}
+		wlogFlush();
+		return;
+	}
+	int bBatch = (0 == strcmp(szMode, "stdio-batch"));
+	FILE* hFile = fopen(WLOG_FILE_NAME, "a");
+	if (NULL == hFile) return;
+	for (unsigned long nIdx = 0; nIdx < nRecords; ++nIdx) {
+		//与logInfo相同的前缀，只比较写文件的方式
+		char szTime[WLOG_TIME_BUFFER_SIZE];
+		__wlog_format_time_imp(szTime, WLOG_TIME_BUFFER_SIZE);
+		fprintf(hFile, "%s %c %s:%-4d| pid %d seq %lu %s end\n", szTime, 'I', "wlog_bench_append.cpp", __LINE__, nPid, nIdx, strPayload.c_str());
+		if (!bBatch) fflush(hFile);
+	}
+	fclose(hFile);
+}
+
+//每行应以"pid P seq N xxx...x end"结尾，且内容长度正确
+static void bench_check(size_t nPayload, unsigned long* pGood, unsigned long* pBad) {
+	FILE* hFile = fopen(WLOG_FILE_NAME, "r");
+	*pGood = *pBad = 0;
+	if (NULL == hFile) return;
+	std::string strLine;
+	int nChar;
+	while (EOF != (nChar = fgetc(hFile))) {
+		if ('\n' != nChar) {
+			strLine += (char)nChar;
+			continue;
+		}
+		if (!strLine.empty() && std::string::npos == strLine.find("WLOG")) {
+			size_t nPos = strLine.find("pid ");
+			int nPid = 0;
+			unsigned long nSeq = 0;
+			int nHead = 0;
+			int bGood = std::string::npos != nPos && 2 == sscanf(strLine.c_str() + nPos, "pid %d seq %lu %n", &nPid, &nSeq, &nHead) && nHead > 0;
+			if (bGood) {
+				std::string strRest = strLine.substr(nPos + (size_t)nHead);
+				bGood = strRest.size() == nPayload + 4 && strRest.compare(nPayload, 4, " end") == 0
+					&& strRest.find_first_not_of('x') == nPayload;
+			}
+			if (bGood) ++*pGood;
+			else ++*pBad;
+		}
+		strLine.clear();
+	}
+	fclose(hFile);
+}
+
+int main(int argc, char* argv[]) {
+	if (argc < 2) {
+		fprintf(stderr, "usage: %s <stdio|stdio-batch|wlog> [processes] [records per process] [payload bytes]\n", argv[0]);
+		return 1;
+	}
+	const char* szMode = argv[1];
+	unsigned int nProcs = (argc > 2) ? (unsigned int)strtoul(argv[2], NULL, 10) : 4;
+	unsigned long nRecords = (argc > 3) ? strtoul(argv[3], NULL, 10) : 200000;
+	size_t nPayload = (argc > 4) ? strtoul(argv[4], NULL, 10) : 64;
+	if (nProcs < 1) nProcs = 1;
+	std::string strPayload(nPayload, 'x');
+	remove(WLOG_FILE_NAME);
+	double fStart = bench_now_ns();
+	for (unsigned int nIdx = 0; nIdx < nProcs; ++nIdx) {
+		if (0 == fork()) {
+			bench_child(szMode, nRecords, strPayload);
+			_exit(0);
+		}
+	}
+	while (wait(NULL) > 0) {}
+	double fCost = bench_now_ns() - fStart;
+	unsigned long nTotal = nProcs * nRecords;
+	unsigned long nGood = 0, nBad = 0;
+	bench_check(nPayload, &nGood, &nBad);
+	printf("%s, %u processes, %lu records of %lu bytes: %.0f records/s, %.1f ns/record\n", szMode, nProcs, nTotal,
+		(unsigned long)nPayload, nTotal / (fCost / 1e9), fCost / nTotal);
+	printf("intact %lu, torn %lu, missing %ld\n", nGood, nBad, (long)nTotal - (long)nGood);
+	return 0;
+}
@@ -0,0 +1,89 @@
+/**
+ * @file wlog_bench_binary.cpp
+ * @brief 对比文本模式与WLOG_BINARY模式下logInfo的单次耗时与文件大小.
+ * <pre>同一份代码编译两次：
+		g++ -O2 -I../inc wlog_bench_binary.cpp -o wlog_bench_text -lpthread && ./wlog_bench_text [调用次数]
+		g++ -O2 -I../inc -DWLOG_BINARY=1 wlog_bench_binary.cpp -o wlog_bench_binary -lpthread && ./wlog_bench_binary [调用次数]
+		可以再加-DWLOG_ASYNC=1看异步写文件时调用线程的耗时，两种模式下WLOG_FLUSH_RECORDS都设成0，只比格式化的开销
+		二进制模式下先检查一组格式串：参数编码后用__wlog_bin_format(wlog_decode与飞行记录器都用它)还原，
+		必须与文本模式的snprintf结果完全相同，不同时输出两边的结果并返回1
+	</pre>
+ * @os linux
+ */
+#define WLOG_FLUSH_RECORDS 0
+#define WLOG_FLUSH_BYTES (256 * 1024)
+#if WLOG_BINARY
+	#define WLOG_FILE_NAME "wlog_bench.bin"
+	#define BENCH_MODE "binary"
+#else
+	#define WLOG_FILE_NAME "wlog_bench.log"
+	#define BENCH_MODE "text"
+#endif
+#if WLOG_ASYNC
+	#define BENCH_SINK " async"
+#else
+	#define BENCH_SINK ""
+#endif
+#include <wlog.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+static double bench_now_ns() {
+	struct timespec tsNow;
+	clock_gettime(CLOCK_MONOTONIC, &tsNow);
+	return tsNow.tv_sec * 1e9 + tsNow.tv_nsec;
+}
+
+static double bench_run(unsigned long nCount) {
+	double fStart = bench_now_ns();
+	for (unsigned long nIdx = 0; nIdx < nCount; ++nIdx) {
+		logInfo("request %lu from %s took %d us, ratio %.3f", nIdx, "client-01", (int)(nIdx & 1023), nIdx * 0.001);
+	}
+	wlogFlush();
+	return (bench_now_ns() - fStart) / nCount;
+}
+
+#if WLOG_BINARY
+//参数编码后还原的结果与snprintf比较，返回不同的个数
+template <typename... Args> static int bench_check(const char* szFormat, Args... args) {
+	char szArgs[1024], szText[512], szDecoded[512];
+	size_t nArgs = (size_t)(__wlog_bin_put_args(szArgs, args...) - szArgs);
+	snprintf(szText, sizeof(szText), szFormat, args...);
+	__wlog_bin_format(szDecoded, sizeof(szDecoded), szFormat, szArgs, nArgs);
+	if (0 == strcmp(szText, szDecoded)) return 0;
+	fprintf(stderr, "round-trip mismatch for \"%s\"\n  text    \"%s\"\n  decoded \"%s\"\n", szFormat, szText, szDecoded);
+	return 1;
+}
+
+static int bench_check_all() {
+	int nBad = 0;
+	nBad += bench_check("hh=%hhu h=%hd hhd=%hhd hx=%hx hhX=%hhX", 300, 70000, 200, -1, 0x1234);
+	nBad += bench_check("%d %5d %-5d| %+d %05d %x %X %#o %c", -2, -14, 3, 7, -42, -1, 255u, 8, 'A');
+	nBad += bench_check("%ld %lu %lld %llx %zu %jd", -100000000000L, 18446744073709551615UL, -1LL, 0x123456789abcULL, (size_t)42, (long long)-7);
+	nBad += bench_check("%-6s| %.2s %8s|%*s|%-*.*s|%.*s|%5.3s", "ab", "xyz", "abc", 4, "q", 6, 2, "wxyz", 3, "abcdef", "hello");
+	nBad += bench_check("%.3f %10.2e %g %G %a %p %% done", 1.5, -1e10, 1.0 / 3, 1e-20, 0.5, (void*)0x1000);
+	return nBad;
+}
+#endif
+
+int main(int argc, char* argv[]) {
+	unsigned long nCount = (argc > 1) ? strtoul(argv[1], NULL, 10) : 1000000;
+	#if WLOG_BINARY
+		int nBad = bench_check_all();
+		if (0 != nBad) {
+			fprintf(stderr, "FAILED: %d format(s) decode differently from text mode\n", nBad);
+			return 1;
+		}
+	#endif
+	remove(WLOG_FILE_NAME);
+	bench_run(nCount / 10);
+	double fCost = bench_run(nCount);
+	struct stat stFile;
+	if (0 != stat(WLOG_FILE_NAME, &stFile)) stFile.st_size = 0;
+	printf("mode         %s\n", BENCH_MODE BENCH_SINK);
+	printf("calls        %lu\n", nCount);
+	printf("logInfo      %8.1f ns/call\n", fCost);
+	printf("file         %s %.1f bytes/record\n", WLOG_FILE_NAME, (double)stFile.st_size / (nCount + nCount / 10));
+	return 0;
+}
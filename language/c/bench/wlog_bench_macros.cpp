@@ -0,0 +1,270 @@
+/**
+ * @file wlog_bench_macros.cpp
+ * @brief 各系列日志宏(logText、logBase、各级别、C/N/CN)的吞吐量、单次延迟分位数与多线程扩展，以及关闭时的开销.
+ * <pre>输出目标在编译时确定，同一份代码按目标编译多次：
+		文件：    g++ -O2 -I../inc wlog_bench_macros.cpp -o wlog_bench_file -lpthread && ./wlog_bench_file [每项条数] [最多线程数]
+		/dev/null：g++ -O2 -I../inc -DWLOG_FILE_NAME='"/dev/null"' wlog_bench_macros.cpp -o wlog_bench_null -lpthread && ./wlog_bench_null
+		控制台：  g++ -O2 -I../inc -DWLOG_TO=WLOG_TO_CONSOLE wlog_bench_macros.cpp -o wlog_bench_console -lpthread && ./wlog_bench_console > /dev/null
+		          控制台模式下结果输出到stderr，stdout是日志本身，可以重定向到文件、/dev/null或者直接看终端
+		控制台+文件：g++ -O2 -I../inc -DWLOG_TO='(WLOG_TO_CONSOLE|WLOG_TO_FILE)' -DWLOG_CONSOLE_TYPES=WLOG_TYPE_ERROR wlog_bench_macros.cpp -o wlog_bench_multi -lpthread
+		加-std=c++17时还会测logInfoF。还可以加-DWLOG_TO=WLOG_TO_MMAP、-DWLOG_ASYNC=1、-DWLOG_FLUSH_RECORDS=0 -DWLOG_FLUSH_BYTES=65536等与默认配置对比。
+		每项先不计时连续调用得到吞吐量，再逐条计时得到p50/p99/p99.9/max，逐条计时包含一次clock_gettime的开销，
+		见"empty"一行。启用了WLOG_DYNAMIC_TYPE_SWITCH(与线上配置相同)，静态关闭的是Trace级别，
+		动态关闭的是Debug级别，这几行应当与"empty"一行相同。
+		升级版本前在同一台机器上新旧版本各跑一次，对比每一行即可发现性能回退。
+	</pre>
+ * @os linux
+ */
+#ifndef WLOG_FILE_NAME
+	#define WLOG_FILE_NAME "wlog_bench_macros.log"
+#endif
+#define WLOG_STATIC_TYPE_SWITCH (WLOG_TYPE_ALL & ~WLOG_TYPE_TRACE)
+#define WLOG_DYNAMIC_TYPE_SWITCH 1
+#include <wlog.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <algorithm>
+
+unsigned int g_wlogDynamicTypeSwitch = WLOG_TYPE_ALL;
+
+#if (WLOG_TO == WLOG_TO_CONSOLE)
+	#define BENCH_SINK "console"
+	#undef WLOG_FILE_NAME
+	#define WLOG_FILE_NAME "stdout"
+	#define BENCH_OUT stderr
+#elif WLOG_MULTI_SINK
+	#define BENCH_SINK "console+file"
+	#define BENCH_OUT stderr
+#elif (WLOG_TO == WLOG_TO_MMAP)
+	#define BENCH_SINK "mmap"
+	#define BENCH_OUT stdout
+#else
+	#define BENCH_SINK "file"
+	#define BENCH_OUT stdout
+#endif
+
+static unsigned long g_nCount = 200000;
+static const char g_szPayload[] = "0123456789abcdef0123456789abcdef0123456789abcdef0123456789abcdef";
+static pthread_barrier_t g_hBarrier;
+
+static double bench_now_ns() {
+	struct timespec tsNow;
+	clock_gettime(CLOCK_MONOTONIC, &tsNow);
+	return tsNow.tv_sec * 1e9 + tsNow.tv_nsec;
+}
+
+//每一项是一次宏调用，都经函数指针调用，与"empty"一行的差就是宏本身的开销
+typedef void (*bench_case_fn)(unsigned long nIdx);
+
+static void bench_case_empty(unsigned long nIdx) {
+	__asm__ __volatile__("" : : "r"(nIdx) : "memory");
+}
+static void bench_case_text(unsigned long nIdx) {
+	logText("request %lu from %s took %d us\n", nIdx, "client-01", (int)(nIdx & 1023));
+}
+static void bench_case_text_n(unsigned long nIdx) {
+	(void)nIdx;
+	logTextN("%02X", g_szPayload, 32);
+}
+static void bench_case_base(unsigned long nIdx) {
+	logBase(WLOG_TYPE_BASE, 'B', "request %lu from %s took %d us", nIdx, "client-01", (int)(nIdx & 1023));
+}
+static void bench_case_debug(unsigned long nIdx) {
+	logDebug("request %lu from %s took %d us", nIdx, "client-01", (int)(nIdx & 1023));
+}
+static void bench_case_info(unsigned long nIdx) {
+	logInfo("request %lu from %s took %d us", nIdx, "client-01", (int)(nIdx & 1023));
+}
+static void bench_case_warning(unsigned long nIdx) {
+	logWarning("request %lu from %s took %d us", nIdx, "client-01", (int)(nIdx & 1023));
+}
+static void bench_case_error(unsigned long nIdx) {
+	logError("request %lu from %s took %d us", nIdx, "client-01", (int)(nIdx & 1023));
+}
+static void bench_case_info_c(unsigned long nIdx) {
+	logInfoC(nIdx != (unsigned long)-1, "request %lu from %s took %d us", nIdx, "client-01", (int)(nIdx & 1023));
+}
+static void bench_case_info_n(unsigned long nIdx) {
+	logInfoN("%02X", g_szPayload, 32, "request %lu", nIdx);
+}
+static void bench_case_info_cn(unsigned long nIdx) {
+	logInfoCN(nIdx != (unsigned long)-1, "%02X", g_szPayload, 32, "request %lu", nIdx);
+}
+static void bench_case_off_c(unsigned long nIdx) {
+	logInfoC(nIdx == (unsigned long)-1, "request %lu from %s took %d us", nIdx, "client-01", (int)(nIdx & 1023));
+}
+static void bench_case_off_static(unsigned long nIdx) {
+	(void)nIdx;
+	logTrace("request %lu from %s took %d us", nIdx, "client-01", (int)(nIdx & 1023));
+}
+static void bench_case_off_static_n(unsigned long nIdx) {
+	(void)nIdx;
+	logTraceN("%02X", g_szPayload, 32, "request %lu", nIdx);
+}
+static void bench_case_off_dynamic(unsigned long nIdx) {
+	logDebug("request %lu from %s took %d us", nIdx, "client-01", (int)(nIdx & 1023));
+}
+static void bench_case_off_dynamic_n(unsigned long nIdx) {
+	logDebugN("%02X", g_szPayload, 32, "request %lu", nIdx);
+}
+#ifdef logInfoF
+static void bench_case_info_f(unsigned long nIdx) {
+	logInfoF("request {} from {} took {} us", nIdx, "client-01", (int)(nIdx & 1023));
+}
+static void bench_case_off_static_f(unsigned long nIdx) {
+	(void)nIdx;
+	logTraceF("request {} from {} took {} us", nIdx, "client-01", (int)(nIdx & 1023));
+}
+#endif
+static void bench_case_off_sample(unsigned long nIdx) {
+	logInfoS(0x40000000, "request %lu from %s took %d us", nIdx, "client-01", (int)(nIdx & 1023));
+}
+
+typedef struct bench_case_t {
+	const char* szName;
+	bench_case_fn pfnCase;
+	unsigned int nDisableTypes;		//运行这一项时动态关闭的类型
+} bench_case_t;
+
+static const bench_case_t g_benchCases[] = {
+	{"empty",              bench_case_empty,        0},
+	{"logText",            bench_case_text,         0},
+	{"logTextN",           bench_case_text_n,       0},
+	{"logBase",            bench_case_base,         0},
+	{"logDebug",           bench_case_debug,        0},
+	{"logInfo",            bench_case_info,         0},
+	{"logWarning",         bench_case_warning,      0},
+	{"logError",           bench_case_error,        0},
+	{"logInfoC",           bench_case_info_c,       0},
+	{"logInfoN",           bench_case_info_n,       0},
+	{"logInfoCN",          bench_case_info_cn,      0},
+#ifdef logInfoF
+	{"logInfoF",           bench_case_info_f,       0},
+#endif
+	{"off: logInfoC false",bench_case_off_c,        0},
+	{"off: static Trace",  bench_case_off_static,   0},
+	{"off: static TraceN", bench_case_off_static_n, 0},
+	{"off: dynamic Debug", bench_case_off_dynamic,  WLOG_TYPE_DEBUG},
+	{"off: dynamic DebugN",bench_case_off_dynamic_n,WLOG_TYPE_DEBUG},
+	{"off: sampled InfoS", bench_case_off_sample,   0},
+#ifdef logInfoF
+	{"off: static TraceF", bench_case_off_static_f, 0},
+#endif
+};
+
+typedef struct bench_latency_t {
+	double fP50;
+	double fP99;
+	double fP999;
+	double fMax;
+} bench_latency_t;
+
+//排序后取分位数，pSamples会被打乱
+static bench_latency_t bench_percentiles(float* pSamples, unsigned long nSamples) {
+	bench_latency_t latency = {0, 0, 0, 0};
+	if (0 == nSamples) return latency;
+	std::sort(pSamples, pSamples + nSamples);
+	latency.fP50 = pSamples[nSamples / 2];
+	latency.fP99 = pSamples[(unsigned long)(nSamples * 0.99)];
+	latency.fP999 = pSamples[(unsigned long)(nSamples * 0.999)];
+	latency.fMax = pSamples[nSamples - 1];
+	return latency;
+}
+
+static void bench_single(const bench_case_t* pCase, float* pSamples) {
+	bench_case_fn volatile pfnCase = pCase->pfnCase;
+	g_wlogDynamicTypeSwitch = WLOG_TYPE_ALL & ~pCase->nDisableTypes;
+	for (unsigned long nIdx = 0; nIdx < g_nCount / 10; ++nIdx) {
+		pfnCase(nIdx);
+	}
+	wlogFlush();
+	double fStart = bench_now_ns();
+	for (unsigned long nIdx = 0; nIdx < g_nCount; ++nIdx) {
+		pfnCase(nIdx);
+	}
+	wlogFlush();
+	double fCost = bench_now_ns() - fStart;
+	for (unsigned long nIdx = 0; nIdx < g_nCount; ++nIdx) {
+		double fBegin = bench_now_ns();
+		pfnCase(nIdx);
+		pSamples[nIdx] = (float)(bench_now_ns() - fBegin);
+	}
+	wlogFlush();
+	g_wlogDynamicTypeSwitch = WLOG_TYPE_ALL;
+	bench_latency_t latency = bench_percentiles(pSamples, g_nCount);
+	fprintf(BENCH_OUT, "%-20s %12.0f %9.1f %8.0f %8.0f %8.0f %9.0f\n", pCase->szName, g_nCount / (fCost / 1e9),
+		fCost / g_nCount, latency.fP50, latency.fP99, latency.fP999, latency.fMax);
+}
+
+typedef struct bench_thread_t {
+	pthread_t hThread;
+	unsigned long nThread;
+	float* pSamples;
+} bench_thread_t;
+
+static void* bench_worker(void* pArg) {
+	bench_thread_t* pThread = (bench_thread_t*)pArg;
+	pthread_barrier_wait(&g_hBarrier);
+	for (unsigned long nIdx = 0; nIdx < g_nCount; ++nIdx) {
+		double fBegin = bench_now_ns();
+		logInfo("thread %lu request %lu from %s took %d us", pThread->nThread, nIdx, "client-01", (int)(nIdx & 1023));
+		pThread->pSamples[nIdx] = (float)(bench_now_ns() - fBegin);
+	}
+	return NULL;
+}
+
+//nThreads个线程同时logInfo，返回每秒总条数，所有线程的单次延迟合在一起算分位数
+static double bench_threads(unsigned int nThreads, float* pSamples, bench_latency_t* pLatency) {
+	bench_thread_t threads[256];
+	pthread_barrier_init(&g_hBarrier, NULL, nThreads + 1);
+	for (unsigned int nIdx = 0; nIdx < nThreads; ++nIdx) {
+		threads[nIdx].nThread = nIdx;
+		threads[nIdx].pSamples = pSamples + nIdx * g_nCount;
+		pthread_create(&threads[nIdx].hThread, NULL, bench_worker, &threads[nIdx]);
+	}
+	pthread_barrier_wait(&g_hBarrier);
+	double fStart = bench_now_ns();
+	for (unsigned int nIdx = 0; nIdx < nThreads; ++nIdx) {
+		pthread_join(threads[nIdx].hThread, NULL);
+	}
+	wlogFlush();
+	double fCost = bench_now_ns() - fStart;
+	pthread_barrier_destroy(&g_hBarrier);
+	*pLatency = bench_percentiles(pSamples, nThreads * g_nCount);
+	return nThreads * g_nCount / (fCost / 1e9);
+}
+
+int main(int argc, char* argv[]) {
+	long nCpus = sysconf(_SC_NPROCESSORS_ONLN);
+	if (argc > 1) g_nCount = strtoul(argv[1], NULL, 10);
+	unsigned int nMaxThreads = (argc > 2) ? (unsigned int)strtoul(argv[2], NULL, 10) : (unsigned int)(nCpus > 0 ? nCpus : 1);
+	if (g_nCount < 1000) g_nCount = 1000;
+	if (nMaxThreads < 1) nMaxThreads = 1;
+	if (nMaxThreads > 256) nMaxThreads = 256;
+	float* pSamples = (float*)malloc(sizeof(float) * g_nCount * nMaxThreads);
+	if (NULL == pSamples) {
+		fprintf(stderr, "out of memory\n");
+		return 1;
+	}
+	#if (WLOG_TO == WLOG_TO_FILE)
+		if (0 != strcmp(WLOG_FILE_NAME, "/dev/null")) remove(WLOG_FILE_NAME);
+	#endif
+	fprintf(BENCH_OUT, "sink %s (%s), cpus %ld, %lu calls/case\n", BENCH_SINK, WLOG_FILE_NAME, nCpus, g_nCount);
+	fprintf(BENCH_OUT, "%-20s %12s %9s %8s %8s %8s %9s\n", "case", "calls/s", "ns/call", "p50", "p99", "p99.9", "max");
+	for (unsigned int nCase = 0; nCase < sizeof(g_benchCases) / sizeof(g_benchCases[0]); ++nCase) {
+		bench_single(&g_benchCases[nCase], pSamples);
+	}
+	fprintf(BENCH_OUT, "\nlogInfo from N threads, %lu calls/thread\n", g_nCount);
+	fprintf(BENCH_OUT, "threads   records/s   per-thread  speedup %8s %8s %8s %9s\n", "p50", "p99", "p99.9", "max");
+	double fBase = 0;
+	for (unsigned int nThreads = 1; ; nThreads = (nThreads * 2 > nMaxThreads && nThreads < nMaxThreads) ? nMaxThreads : nThreads * 2) {
+		bench_latency_t latency;
+		double fRate = bench_threads(nThreads, pSamples, &latency);
+		if (1 == nThreads) fBase = fRate;
+		fprintf(BENCH_OUT, "%7u %11.0f %12.0f %7.2fx %8.0f %8.0f %8.0f %9.0f\n", nThreads, fRate, fRate / nThreads, fRate / fBase,
+			latency.fP50, latency.fP99, latency.fP999, latency.fMax);
+		if (nThreads >= nMaxThreads) break;
+	}
+	free(pSamples);
+	return 0;
+}
@@ -0,0 +1,54 @@
+/**
+ * @file wlog_bench_span.cpp
+ * @brief logSpan的单次耗时：打开时记录一个区间(两次读时钟+记进线程缓冲，含缓冲满时写文件的分摊)，动态开关关掉时只多一次判断.
+ * <pre>编译运行：
+		g++ -O2 -I../inc wlog_bench_span.cpp -o wlog_bench_span -lpthread && ./wlog_bench_span [调用次数]
+		生成的wlog.trace.json可以用chrome://tracing或ui.perfetto.dev打开
+	</pre>
+ * @os linux
+ */
+#define WLOG_SPAN 1
+#define WLOG_DYNAMIC_TYPE_SWITCH 1
+#include <wlog.h>
+#include <stdlib.h>
+
+unsigned int g_wlogDynamicTypeSwitch = WLOG_TYPE_ALL;
+
+static double bench_now_ns() {
+	struct timespec tsNow;
+	clock_gettime(CLOCK_MONOTONIC, &tsNow);
+	return tsNow.tv_sec * 1e9 + tsNow.tv_nsec;
+}
+
+static __attribute__((noinline)) void bench_work(unsigned long* pSum, unsigned long nIdx) {
+	*pSum += nIdx;
+	__asm__ __volatile__("" : : "r"(pSum) : "memory");
+}
+
+static double bench_run(int bSpan, unsigned long nCount) {
+	unsigned long nSum = 0;
+	double fStart = bench_now_ns();
+	for (unsigned long nIdx = 0; nIdx < nCount; ++nIdx) {
+		if (bSpan) {
+			logSpan("bench_work");
+			bench_work(&nSum, nIdx);
+		} else {
+			bench_work(&nSum, nIdx);
+		}
+	}
+	return (bench_now_ns() - fStart) / nCount;
+}
+
+int main(int argc, char* argv[]) {
+	unsigned long nCount = (argc > 1) ? strtoul(argv[1], NULL, 10) : 2000000;
+	bench_run(1, nCount / 10);
+	double fBase = bench_run(0, nCount);
+	double fOn = bench_run(1, nCount);
+	g_wlogDynamicTypeSwitch = WLOG_TYPE_ALL & ~WLOG_SPAN_TYPE;
+	double fOff = bench_run(1, nCount);
+	printf("calls                 %lu\n", nCount);
+	printf("no span               %8.1f ns/call\n", fBase);
+	printf("logSpan enabled       %8.1f ns/call\n", fOn);
+	printf("logSpan dynamic off   %8.1f ns/call\n", fOff);
+	return 0;
+}
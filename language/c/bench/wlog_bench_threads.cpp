@@ -0,0 +1,71 @@
+/**
+ * @file wlog_bench_threads.cpp
+ * @brief 1到N个线程同时写同一个日志文件时的总吞吐量，看写文件能否随线程数扩展.
+ * <pre>编译运行：
+		g++ -O2 -I../inc wlog_bench_threads.cpp -o wlog_bench_threads -lpthread && ./wlog_bench_threads [最多线程数] [每线程条数]
+		最多线程数默认是CPU核数，线程数按1、2、4...翻倍直到最多线程数。默认每条日志一次write，
+		可以加-DWLOG_FLUSH_RECORDS=0 -DWLOG_FLUSH_BYTES=65536看每个线程攒满64K再写的情况，
+		或者加-DWLOG_ASYNC=1与异步写文件对比。
+	</pre>
+ * @os linux
+ */
+#define WLOG_FILE_NAME "wlog_bench_threads.log"
+#include <wlog.h>
+#include <stdlib.h>
+#include <pthread.h>
+
+static unsigned long g_nPerThread = 200000;
+static pthread_barrier_t g_hBarrier;
+
+static double bench_now_ns() {
+	struct timespec tsNow;
+	clock_gettime(CLOCK_MONOTONIC, &tsNow);
+	return tsNow.tv_sec * 1e9 + tsNow.tv_nsec;
+}
+
+static void* bench_worker(void* pArg) {
+	unsigned long nThread = (unsigned long)pArg;
+	pthread_barrier_wait(&g_hBarrier);
+	for (unsigned long nIdx = 0; nIdx < g_nPerThread; ++nIdx) {
+		logInfo("thread %lu request %lu from %s took %d us", nThread, nIdx, "client-01", (int)(nIdx & 1023));
+	}
+	return NULL;
+}
+
+//返回每秒写入的条数
+static double bench_run(unsigned int nThreads) {
+	pthread_t hThreads[256];
+	pthread_barrier_init(&g_hBarrier, NULL, nThreads + 1);
+	for (unsigned int nIdx = 0; nIdx < nThreads; ++nIdx) {
+		pthread_create(&hThreads[nIdx], NULL, bench_worker, (void*)(unsigned long)nIdx);
+	}
+	pthread_barrier_wait(&g_hBarrier);
+	double fStart = bench_now_ns();
+	for (unsigned int nIdx = 0; nIdx < nThreads; ++nIdx) {
+		pthread_join(hThreads[nIdx], NULL);
+	}
+	wlogFlush();
+	double fCost = bench_now_ns() - fStart;
+	pthread_barrier_destroy(&g_hBarrier);
+	return nThreads * g_nPerThread / (fCost / 1e9);
+}
+
+int main(int argc, char* argv[]) {
+	long nCpus = sysconf(_SC_NPROCESSORS_ONLN);
+	unsigned int nMaxThreads = (argc > 1) ? (unsigned int)strtoul(argv[1], NULL, 10) : (unsigned int)(nCpus > 0 ? nCpus : 1);
+	if (argc > 2) g_nPerThread = strtoul(argv[2], NULL, 10);
+	if (nMaxThreads < 1) nMaxThreads = 1;
+	if (nMaxThreads > 256) nMaxThreads = 256;
+	remove(WLOG_FILE_NAME);
+	bench_run(1);
+	printf("cpus %ld, %lu records/thread\n", nCpus, g_nPerThread);
+	printf("threads   records/s   per-thread  speedup\n");
+	double fBase = 0;
+	for (unsigned int nThreads = 1; ; nThreads = (nThreads * 2 > nMaxThreads && nThreads < nMaxThreads) ? nMaxThreads : nThreads * 2) {
+		double fRate = bench_run(nThreads);
+		if (1 == nThreads) fBase = fRate;
+		printf("%7u %11.0f %12.0f %7.2fx\n", nThreads, fRate, fRate / nThreads, fRate / fBase);
+		if (nThreads >= nMaxThreads) break;
+	}
+	return 0;
+}
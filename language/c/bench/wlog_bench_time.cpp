@@ -0,0 +1,53 @@
+/**
+ * @file wlog_bench_time.cpp
+ * @brief 对比logBase时间前缀的旧实现(time+localtime+snprintf)与每线程缓存的__wlog_format_time_imp的单次耗时.
+ * <pre>编译运行：
+		g++ -O2 -I../inc wlog_bench_time.cpp -o wlog_bench_time -lpthread && ./wlog_bench_time [调用次数]
+	</pre>
+ * @os linux
+ */
+#include <wlog.h>
+#include <stdlib.h>
+
+//V2.06及以前的实现，原样保留用于对比
+static void __wlog_format_time_old(char * pOutBuffer, unsigned int nBufferCount) {
+	time_t timeData = time(NULL);
+	struct tm *p = localtime(&timeData);
+	p->tm_mon += 1;
+	snprintf(pOutBuffer,nBufferCount,"%02d-%02d %02d:%02d:%02d", p->tm_mon, p->tm_mday,p->tm_hour,p->tm_min,p->tm_sec);
+}
+
+static double bench_now_ns() {
+	struct timespec tsNow;
+	clock_gettime(CLOCK_MONOTONIC, &tsNow);
+	return tsNow.tv_sec * 1e9 + tsNow.tv_nsec;
+}
+
+static double bench_run(void (*pfnFormat)(char*, unsigned int), unsigned long nCount) {
+	char szBuf[WLOG_TIME_BUFFER_SIZE + 8];
+	unsigned long nCheck = 0;
+	double fStart = bench_now_ns();
+	for (unsigned long nIdx = 0; nIdx < nCount; ++nIdx) {
+		pfnFormat(szBuf, sizeof(szBuf));
+		nCheck += (unsigned char)szBuf[13];
+		__asm__ __volatile__("" : : "r"(szBuf) : "memory");
+	}
+	double fCost = (bench_now_ns() - fStart) / nCount;
+	if (nCheck == 1) printf(" ");
+	return fCost;
+}
+
+int main(int argc, char* argv[]) {
+	unsigned long nCount = (argc > 1) ? strtoul(argv[1], NULL, 10) : 5000000;
+	char szSample[WLOG_TIME_BUFFER_SIZE];
+	bench_run(__wlog_format_time_old, nCount / 10);
+	bench_run(__wlog_format_time_imp, nCount / 10);
+	double fOld = bench_run(__wlog_format_time_old, nCount);
+	double fNew = bench_run(__wlog_format_time_imp, nCount);
+	__wlog_format_time_imp(szSample, sizeof(szSample));
+	printf("calls                 %lu\n", nCount);
+	printf("old time+localtime    %8.1f ns/call\n", fOld);
+	printf("cached (precision %d)  %8.1f ns/call  sample \"%s\"\n", WLOG_TIME_PRECISION, fNew, szSample);
+	printf("speedup               %8.1fx\n", fOld / fNew);
+	return 0;
+}
@@ -0,0 +1,73 @@
+/**
+ * @file wlog_bench_writev.cpp
+ * @brief 同步写文件(__wlog_file_write_valist_imp)与异步写线程三种写法(fwrite、writev、io_uring)的吞吐量对比.
+ * <pre>编译运行(每种写法单独编译一次)：
+		g++ -O2 -I../inc wlog_bench_writev.cpp -o bench_sync -lpthread
+		g++ -O2 -I../inc -DWLOG_ASYNC=1 -DWLOG_ASYNC_IO=WLOG_ASYNC_IO_STDIO wlog_bench_writev.cpp -o bench_stdio -lpthread
+		g++ -O2 -I../inc -DWLOG_ASYNC=1 -DWLOG_ASYNC_IO=WLOG_ASYNC_IO_WRITEV wlog_bench_writev.cpp -o bench_writev -lpthread
+		g++ -O2 -I../inc -DWLOG_ASYNC=1 -DWLOG_ASYNC_IO=WLOG_ASYNC_IO_URING wlog_bench_writev.cpp -o bench_uring -lpthread
+		./bench_xxx [线程数] [每线程条数]
+		计时包括最后的wlogFlush，即全部写进文件为止。异步时另外输出写线程写文件的次数和平均每次写出的条数。
+	</pre>
+ * @os linux
+ */
+#define WLOG_FILE_NAME "wlog_bench_writev.log"
+#include <wlog.h>
+#include <stdlib.h>
+#include <pthread.h>
+
+static unsigned long g_nPerThread = 500000;
+static pthread_barrier_t g_hBarrier;
+
+static double bench_now_ns() {
+	struct timespec tsNow;
+	clock_gettime(CLOCK_MONOTONIC, &tsNow);
+	return tsNow.tv_sec * 1e9 + tsNow.tv_nsec;
+}
+
+static void* bench_worker(void* pArg) {
+	unsigned long nThread = (unsigned long)pArg;
+	pthread_barrier_wait(&g_hBarrier);
+	for (unsigned long nIdx = 0; nIdx < g_nPerThread; ++nIdx) {
+		logInfo("thread %lu request %lu from %s took %d us", nThread, nIdx, "client-01", (int)(nIdx & 1023));
+	}
+	return NULL;
+}
+
+int main(int argc, char* argv[]) {
+	unsigned int nThreads = (argc > 1) ? (unsigned int)strtoul(argv[1], NULL, 10) : 1;
+	if (argc > 2) g_nPerThread = strtoul(argv[2], NULL, 10);
+	if (nThreads < 1) nThreads = 1;
+	if (nThreads > 256) nThreads = 256;
+	remove(WLOG_FILE_NAME);
+	#if !WLOG_ASYNC
+		const char* szMode = "sync";
+	#elif (WLOG_ASYNC_IO == WLOG_ASYNC_IO_URING)
+		const char* szMode = "async io_uring";
+	#elif (WLOG_ASYNC_IO == WLOG_ASYNC_IO_WRITEV)
+		const char* szMode = "async writev";
+	#else
+		const char* szMode = "async fwrite";
+	#endif
+	pthread_t hThreads[256];
+	pthread_barrier_init(&g_hBarrier, NULL, nThreads + 1);
+	for (unsigned int nIdx = 0; nIdx < nThreads; ++nIdx) {
+		pthread_create(&hThreads[nIdx], NULL, bench_worker, (void*)(unsigned long)nIdx);
+	}
+	pthread_barrier_wait(&g_hBarrier);
+	double fStart = bench_now_ns();
+	for (unsigned int nIdx = 0; nIdx < nThreads; ++nIdx) {
+		pthread_join(hThreads[nIdx], NULL);
+	}
+	wlogFlush();
+	double fCost = bench_now_ns() - fStart;
+	pthread_barrier_destroy(&g_hBarrier);
+	unsigned long nTotal = nThreads * g_nPerThread;
+	printf("%s, %u threads, %lu records: %.0f records/s, %.1f ns/record\n", szMode, nThreads, nTotal,
+		nTotal / (fCost / 1e9), fCost / nTotal);
+	#if WLOG_ASYNC
+		unsigned long nWrites = wlogAsyncWrites();
+		printf("writes %lu, %.1f records/write, dropped %lu\n", nWrites, nWrites ? (double)nTotal / nWrites : 0.0, wlogAsyncDropped());
+	#endif
+	return 0;
+}
@@ -8,28 +8,83 @@
         why？wlog里面使用的大量的内联与宏，如果你要定义自己的宏宏配置选项，
         在多个地方include <wlog.h>而忘记同步修改宏配置选项，会生成多种
         不同的展开表达式，导致最终结果并不是你想要的。
-        此日志当前支持4种风格，皆为变参：
+        此日志当前支持6种风格，皆为变参：
             1. logXXX   最常用，注意由于使用宏的原因，第一个参数不要直接输出非常量字符串，如要输出string str;需要logXXX(_T("%s"), str.c_str()); 而不是直接logXXX(str.c_str())。
             2. logXXXC  带条件的输出，此条件放在第一个参数上，条件为动态检测，如logXXXC(nAge > 18, "你已经大于18岁了，年龄(%d)", nAge)。
             3. logXXXN  此系列是用来输出没有结尾标志'\0'的字符串的，但可以将字符输出成其他格式，如logXXXN("%02X", szBuf, 10, "将szBuf前10位当成整数输出，真实长度(%d)", 444)。
             4. logXXXCN 此系列结合了C与N的功能，除了系统一个参数是条件外，与logXXXN功用法相同。
+            5. logXXXR  限速输出，第一个参数是每秒最多输出的条数，每个调用点单独计数，如logErrorR(10, "recv failed(%d)", nErr)。
+            6. logXXXS  采样输出，第一个参数N表示每N次只输出1次，如logDebugS(1000, "packet(%u)", nSeq)。
+               这两种被丢弃的条数会在下一条输出的日志前面以"(suppressed K) "注明，详见wlog_limit.h
+            另外linux下C++17还可以用logXXXF，以"{}"占位，格式串在编译时按参数类型检查，如logInfoF("x={} y={:.2f}", x, y)，详见wlog_fmt.h
+            linux下C++还可以用logXXXKV附带键值对，如logInfoKV(("user", nUserId, "ip", szIp), "login %s", szName)，详见wlog_json.h
  * usage:
 		你可以在include之前修改“宏”配置，包括
-		1. WLOG_TO, 用户太默认是输出到CONSOLE，内核态默认输出到KERNEL
+		1. WLOG_TO, 用户太默认是输出到CONSOLE，内核态默认输出到KERNEL；linux用户态下还可以是WLOG_TO_MMAP，
+			即预分配并映射WLOG_FILE_NAME后直接memcpy写入，写日志没有系统调用，详见wlog_mmap.h；
+			还可以是WLOG_TO_SHM，多个进程把日志放进共享内存WLOG_SHM_NAME的环形队列，由收集进程tools/wlog_collect
+			写进切换的日志文件，写日志的进程不碰文件系统，详见wlog_shm.h；
+			还可以是WLOG_TO_SOCKET，按RFC 5424格式成批经unix域套接字(默认/dev/log)交给本机的syslog或日志代理，详见wlog_socket.h；
+			linux用户态下还可以把WLOG_TO_CONSOLE与WLOG_TO_FILE或WLOG_TO_MMAP或起来同时输出，
+			用WLOG_CONSOLE_TYPES、WLOG_FILE_TYPES分别设置各自输出的日志类型，日志只格式化一次，详见wlog_sink.h
 		2. WLOG_STATIC_TYPE_SWITCH，设置静态(编译时)开关，默认是输出所有日志类型，
 			即#define WLOG_STATIC_TYPE_SWITCH (WLOG_TYPE_ALL)
 		3. WLOG_DYNAMIC_TYPE_SWITCH，是否启动动态(运行时)开关，默认不启用，
 			即#define WLOG_DYNAMIC_TYPE_SWITCH 0，如果启用的话需要定义全局变量
 			unsigned int g_wlogDynamicTypeSwitch = (这里调节你要动态开启的日志类型);
-		4. WLOG_DYNAMIC_CHECK_LOG_FILE，如果当前WLOG_TO定义成WLOG_TO_FILE，此值可
+			linux用户态下还可以用WLOG_CATEGORY_NAME给编译单元分类，分别设置开关，
+			用WLOG_CONFIG_FILE指定配置文件，修改后自动生效，详见wlog_level.h
+		4. WLOG_DYNAMIC_CHECK_LOG_FILE，如果当前WLOG_TO定义成WLOG_TO_FILE或WLOG_TO_MMAP，此值可
 			设置是否检测日志文件存在才写日志，默认是如果不存在直接创建，即
 			#define WLOG_DYNAMIC_CHECK_LOG_FILE 0，一般在Release版本开启此开关有利于今后调试
-		5. WLOG_FILE_NAME，如果当前WLOG_TO定义成WLOG_TO_FILE，此值可
+		5. WLOG_FILE_NAME，如果当前WLOG_TO定义成WLOG_TO_FILE或WLOG_TO_MMAP，此值可
 			设置日志文件存放的具体路径，默认是 #define WLOG_FILE_NAME _T("wlog.default.log")
+		6. WLOG_ASYNC，如果当前WLOG_TO定义成WLOG_TO_FILE，设置成1后写文件改为异步，调用线程只格式化到
+			无锁环形队列，由后台线程批量写入，默认是0，即同步写入。队列大小、满时策略等见wlog_async.h，
+			linux下还可用WLOG_ASYNC_IO选择writev或io_uring直接从队列整批写出，见wlog_writev.h
+		7. WLOG_FLUSH_RECORDS、WLOG_FLUSH_BYTES、WLOG_FLUSH_INTERVAL_MS、WLOG_FLUSH_TYPES、WLOG_FLUSH_SYNC_TYPES，
+			如果当前WLOG_TO定义成WLOG_TO_FILE，设置按条数、字节数、时间间隔、日志类型分组刷新文件，
+			默认仍是每条日志fflush一次，详见wlog_file.h
+		8. WLOG_TIME_PRECISION，linux用户态下logBase时间的秒以下位数，可以是0、3、6，默认3，
+			即"MM-DD HH:MM:SS.mmm"，定义成0时与以前的格式相同
+		9. WLOG_BINARY，如果当前WLOG_TO定义成WLOG_TO_FILE，设置成1后logBase系列只把调用点编号、时间与参数
+			原始字节写入文件，不再格式化，需要C++，用tools/wlog_decode还原成文本，详见wlog_binary.h
+		10. WLOG_FULL_FILE_PATH，logBase默认只输出不含路径的文件名(编译时计算)，设置成1时输出完整的__FILE__，详见wlog_site.h
+		11. WLOG_ROTATE_SIZE、WLOG_ROTATE_INTERVAL_SEC、WLOG_ROTATE_KEEP、WLOG_ROTATE_COMPRESS，如果当前WLOG_TO定义成
+			WLOG_TO_FILE(linux)，按大小或按时间切换日志文件并只保留最近的几个，旧文件可由后台线程压缩，详见wlog_rotate.h
+		12. WLOG_STAGE_SIZE，linux下WLOG_TO_FILE同步写文件时每个线程先格式化到自己的暂存缓冲，再按刷新策略
+			一次write写入文件，线程之间不再争用FILE锁，此值为每个线程的缓冲大小，默认16K；文件以O_APPEND | O_CLOEXEC打开，
+			多个进程写同一个文件或管道时日志也不会交错，超过PIPE_BUF的日志写管道时用flock互斥，详见wlog_stage.h
+		13. WLOG_JSON，linux用户态下设置成1后logBase系列每条日志输出成一行JSON(时间、级别、文件、行号、线程号、消息)，
+			C++下还可以用logXXXKV附带键值对字段，详见wlog_json.h
+		14. WLOG_FLIGHT，linux下C++11设置成1后WLOG_STATIC_TYPE_SWITCH关掉的TRACE、DEBUG不再丢弃，而是以原始字节记进
+			每个线程的环形缓冲，出现ERROR以上的日志、logVerify失败或程序崩溃时才格式化写出，详见wlog_flight.h
+		15. WLOG_STATS，linux用户态下设置成1后统计日志自身的开销：按类型的条数、写出的字节数、丢弃与写失败的条数、
+			格式化与写输出耗时的直方图，每个线程单独计数，可用WLOG_STATS_FILE定期写进单独的文件，详见wlog_stats.h
+		16. WLOG_SPAN，linux用户态下设置成1后可以用logSpan("name")记录作用域的纳秒级耗时，logCounter、logInstant记录计数与事件，
+			先记进每个线程的缓冲，再写成Chrome/Perfetto能打开的trace-event JSON文件WLOG_SPAN_FILE，
+			受WLOG_SPAN_TYPE(默认WLOG_TYPE_TRACE)的静态、动态开关控制，详见wlog_span.h
+		17. WLOG_ARENA_MIN_BITS、WLOG_ARENA_MAX_BITS、WLOG_ARENA_CACHE，linux用户态下超过栈上缓冲的长日志从每个线程
+			按大小类缓存的缓冲池取缓冲，稳定运行后写日志不再malloc/free，长日志也只格式化一遍，详见wlog_arena.h
+		18. WLOG_INDEX、WLOG_INDEX_RECORDS、WLOG_INDEX_BYTES，linux下WLOG_TO_FILE设置成1后每隔一段日志在WLOG_FILE_NAME.idx
+			记下偏移、时间范围与出现过的级别，用tools/wlog_query按时间、级别、子串查询时只扫描可能匹配的块，详见wlog_index.h
 		#include <wlog.h>
 		你可以在这里修改变量配置，包括
 		1. unsigned int g_wlogDynamicTypeSwitch，如果WLOG_DYNAMIC_TYPE_SWITCH定义成1，需要定义此变量，并可动态改变此变量的值
 			如g_wlogDynamicTypeSwitch = (WLOG_TYPE_TEXT | WLOG_TYPE_BASE | WLOG_TYPE_DEBUG | WLOG_TYPE_NOTICE);  
+		你可以调用的函数
+		1. wlogFlush()，把还在缓冲里的日志写出，程序退出前或需要确保日志落地的地方调用
+		2. wlogSiteCount()、wlogSiteGet(nId)，C++下枚举程序里所有的logBase调用点，详见wlog_site.h
+		3. wlogMmapDropped()，WLOG_TO_MMAP下因空间不足丢弃的日志条数
+		4. wlogSetTypeSwitch(szCategory, nMask)、wlogGetTypeSwitch(szCategory)、wlogReloadConfig()，
+			WLOG_DYNAMIC_TYPE_SWITCH下运行时修改全局或某个分类的开关、重新加载WLOG_CONFIG_FILE，详见wlog_level.h
+		5. wlogSetSinkTypes(nSink, nMask)、wlogGetSinkTypes(nSink)，WLOG_TO为多个输出时运行时修改、读取某个输出的日志类型
+		6. wlogFlightDump()，WLOG_FLIGHT下写出所有线程在内存里的记录
+		7. wlogGetStats(pStats)、wlogStatsPercentile(pHist, fPercent)、wlogStatsDump(hOut)，WLOG_STATS下读取、写出统计
+		8. wlogShmDropped()，WLOG_TO_SHM下队列满丢弃的条数；wlogShmCollect(szName, pbStop)、wlogShmDrain()，
+			WLOG_SHM_COLLECTOR下在自己的程序里做收集进程
+		9. wlogSocketDropped()，WLOG_TO_SOCKET下日志代理跟不上、缓冲满丢弃的条数
+		10. wlogSpanFlush()，WLOG_SPAN下把所有线程缓冲里的事件写进WLOG_SPAN_FILE
 	</pre>
  * @os windows, linux
  * @author wtd, weitidong220@163.com
@@ -51,6 +106,29 @@
        <li>20110113 --- V2.02   将logXXXN系列修改成变参方式</li>
        <li>20110121 --- V2.03   修改写文件预定义，对于没有预定义WLOG_TO的，如果定义了WLOG_FILE_NAME也默认写入文件</li>
        <li>20110226 --- V2.04   添加一些用法注释，发布成公共代码</li>
+       <li>20261017 --- V2.05   linux下增加WLOG_ASYNC异步写文件模式，logFatal/logVerify在返回前等待队列写空</li>
+       <li>20261017 --- V2.06   写文件增加分组刷新策略WLOG_FLUSH_XXX，不再每条日志都fflush，增加wlogFlush()</li>
+       <li>20261017 --- V2.07   linux下logBase时间改为每线程缓存，不再调用非线程安全的localtime，增加毫秒/微秒精度WLOG_TIME_PRECISION</li>
+       <li>20261017 --- V2.08   linux用户态下logXXXN系列整段编码后作为一条日志一次写出，"%02X"、"%02x"、"%c"走查表/SSSE3编码</li>
+       <li>20261017 --- V2.09   增加WLOG_BINARY二进制日志模式与解码工具tools/wlog_decode</li>
+       <li>20261017 --- V2.10   文件名改为编译时计算的不含路径的文件名，修复windows下路径没有'\'时崩溃，增加调用点静态登记wlogSiteXXX</li>
+       <li>20261017 --- V2.11   linux下增加WLOG_TO_MMAP内存映射写文件，正常退出时截断到实际长度，崩溃后自动找回文件尾</li>
+       <li>20261017 --- V2.12   linux下写文件增加按大小/时间切换WLOG_ROTATE_XXX，切换无锁，改名、压缩、删除旧文件在后台线程</li>
+       <li>20261017 --- V2.13   linux下同步写文件改为每线程暂存缓冲+一次write，不再经过stdio锁，第一次打开文件加锁，不再重复打开</li>
+       <li>20261017 --- V2.14   动态开关改为原子读，增加按分类的开关WLOG_CATEGORY_NAME与配置文件WLOG_CONFIG_FILE热加载(inotify/SIGHUP)</li>
+       <li>20261017 --- V2.15   增加logXXXR限速与logXXXS采样系列，每个调用点无锁计数</li>
+       <li>20261017 --- V2.16   linux下C++17增加类型安全的logXXXF系列，编译时检查格式串，数字用to_chars转换</li>
+       <li>20261017 --- V2.17   linux下WLOG_TO可以同时指定控制台与文件，每个输出单独设置日志类型，日志只格式化一次</li>
+       <li>20261017 --- V2.18   linux下增加WLOG_JSON结构化JSON行输出，不分配内存，SSE2转义字符串，增加logXXXKV键值对</li>
+       <li>20261017 --- V2.19   linux下增加飞行记录器WLOG_FLIGHT，静态关掉的级别以原始字节记进每线程环形缓冲，出错或崩溃时写出</li>
+       <li>20261017 --- V2.20   linux下异步写文件增加WLOG_ASYNC_IO，可用writev或io_uring不复制地从队列整批写出，增加wlogAsyncWrites()</li>
+       <li>20261017 --- V2.21   linux下增加WLOG_STATS统计日志自身的条数、字节数、丢弃、写失败与耗时直方图，增加wlogGetStats()</li>
+       <li>20261017 --- V2.22   linux下增加WLOG_TO_SHM多进程共享内存环形队列输出与收集进程tools/wlog_collect，崩溃时写了一半的日志自动跳过</li>
+       <li>20261017 --- V2.23   linux下增加WLOG_TO_SOCKET，RFC 5424格式经unix域套接字成批(sendmmsg/sendmsg)非阻塞发给本机日志代理</li>
+       <li>20261017 --- V2.24   linux下日志文件以O_APPEND | O_CLOEXEC打开，写管道时按PIPE_BUF分批、超长日志flock互斥，增加bench/wlog_bench_append</li>
+       <li>20261017 --- V2.25   linux下增加WLOG_SPAN，logSpan作用域计时、logCounter、logInstant输出Chrome trace-event JSON</li>
+       <li>20261017 --- V2.26   linux下长日志改用每线程按大小类缓存的缓冲池，写日志不再malloc/free；windows下IDE输出不再每条计算两遍长度</li>
+       <li>20261017 --- V2.27   linux下增加WLOG_INDEX日志稀疏索引与tools/wlog_query按时间、级别、子串查询</li>
 	</ul>
  */
 
@@ -59,6 +137,9 @@
 #define WLOG_TO_IDE			(0x01 << 2)
 #define WLOG_TO_KERNEL		(0x01 << 3)
 #define WLOG_TO_FILE		(0x01 << 4)
+#define WLOG_TO_MMAP		(0x01 << 5)
+#define WLOG_TO_SHM			(0x01 << 6)
+#define WLOG_TO_SOCKET		(0x01 << 7)
 
 //默认输出
 #ifndef WLOG_TO
@@ -84,6 +165,24 @@
 	
 #endif
 
+//多个输出或起来，如(WLOG_TO_CONSOLE | WLOG_TO_FILE)：WLOG_TO换成其中的文件输出，控制台由wlog_sink.h分发
+#if ((WLOG_TO) & ((WLOG_TO) - 1))
+	#if defined(_WIN32) || defined(__KERNEL__)
+		#error "haven't implement!"
+	#endif
+	#if ((WLOG_TO) & ~(WLOG_TO_CONSOLE | WLOG_TO_FILE | WLOG_TO_MMAP)) || !((WLOG_TO) & WLOG_TO_CONSOLE) || (((WLOG_TO) & WLOG_TO_FILE) && ((WLOG_TO) & WLOG_TO_MMAP))
+		#error "multiple WLOG_TO must be WLOG_TO_CONSOLE with WLOG_TO_FILE or WLOG_TO_MMAP!"
+	#endif
+	#define WLOG_MULTI_SINK 1
+	#if ((WLOG_TO) & WLOG_TO_MMAP)
+		#undef WLOG_TO
+		#define WLOG_TO WLOG_TO_MMAP
+	#else
+		#undef WLOG_TO
+		#define WLOG_TO WLOG_TO_FILE
+	#endif
+#endif
+
 //include
 #ifdef _WIN32
 	#if	  (WLOG_TO == WLOG_TO_CONSOLE)
@@ -110,12 +209,16 @@
 	#elif (WLOG_TO == WLOG_TO_IDE)
 	#elif (WLOG_TO == WLOG_TO_KERNEL)
 	#elif (WLOG_TO == WLOG_TO_FILE)
+	#elif (WLOG_TO == WLOG_TO_MMAP)
+	#elif (WLOG_TO == WLOG_TO_SHM)
+	#elif (WLOG_TO == WLOG_TO_SOCKET)
 	#else
 		#error "you must define WLOG_TO to a valid type!"
 	#endif
 	
-	#if (WLOG_TO == WLOG_TO_CONSOLE) || (WLOG_TO == WLOG_TO_IDE) || (WLOG_TO == WLOG_TO_FILE)
+	#if (WLOG_TO == WLOG_TO_CONSOLE) || (WLOG_TO == WLOG_TO_IDE) || (WLOG_TO == WLOG_TO_FILE) || (WLOG_TO == WLOG_TO_MMAP) || (WLOG_TO == WLOG_TO_SHM) || (WLOG_TO == WLOG_TO_SOCKET)
         #include <stdio.h>
+		#include <string.h>
 		#include <time.h>
 		#include <assert.h>
 	#endif
@@ -149,13 +252,85 @@
 //是否使用动态编译日志类型开关
 #if WLOG_DYNAMIC_TYPE_SWITCH
 	extern unsigned int g_wlogDynamicTypeSwitch;
-	#define WLOG_DYNAMIC_CHECK(type) if (!(type & g_wlogDynamicTypeSwitch)) break
-	#define WLOG_DYNAMIC_CHECK_TEXT if (WLOG_TYPE_TEXT & g_wlogDynamicTypeSwitch)
+	#if defined(__GNUC__) && !defined(_WIN32) && (WLOG_TO != WLOG_TO_KERNEL)
+		//原子读，支持分类与配置文件热加载
+		#include "wlog_level.h"
+	#else
+		#define WLOG_DYNAMIC_MASK() (*(volatile unsigned int*)&g_wlogDynamicTypeSwitch)
+	#endif
+	#define WLOG_DYNAMIC_CHECK(type) if (!((type) & WLOG_DYNAMIC_MASK())) break
+	#define WLOG_DYNAMIC_CHECK_TEXT if (WLOG_TYPE_TEXT & WLOG_DYNAMIC_MASK())
 #else
 	#define WLOG_DYNAMIC_CHECK(type)
 	#define WLOG_DYNAMIC_CHECK_TEXT
 #endif
 
+//logBase时间的秒以下精度，linux用户态有效，0表示精确到秒，3为毫秒，6为微秒
+#ifndef WLOG_TIME_PRECISION
+	#define WLOG_TIME_PRECISION 3
+#endif
+#if (WLOG_TIME_PRECISION == 0)
+	#define WLOG_TIME_BUFFER_SIZE 15
+	#define WLOG_TIME_CLOCK CLOCK_REALTIME_COARSE
+#elif (WLOG_TIME_PRECISION == 3)
+	#define WLOG_TIME_BUFFER_SIZE 19
+	#define WLOG_TIME_FRACTION_DIV 1000000
+	#define WLOG_TIME_CLOCK CLOCK_REALTIME
+#elif (WLOG_TIME_PRECISION == 6)
+	#define WLOG_TIME_BUFFER_SIZE 22
+	#define WLOG_TIME_FRACTION_DIV 1000
+	#define WLOG_TIME_CLOCK CLOCK_REALTIME
+#else
+	#error "WLOG_TIME_PRECISION must be 0, 3 or 6!"
+#endif
+
+//二进制日志只在WLOG_TO_FILE实现，详见wlog_binary.h
+#if WLOG_BINARY && (WLOG_TO != WLOG_TO_FILE)
+	#error "WLOG_BINARY only support WLOG_TO_FILE!"
+#endif
+
+//JSON行输出只在linux用户态实现，详见wlog_json.h
+#if WLOG_JSON && (defined(_WIN32) || defined(__KERNEL__))
+	#error "haven't implement!"
+#endif
+
+//飞行记录器同样只在linux用户态实现，详见wlog_flight.h
+#if WLOG_FLIGHT && (defined(_WIN32) || defined(__KERNEL__))
+	#error "haven't implement!"
+#endif
+
+//logSpan系列同样只在linux用户态实现，详见wlog_span.h
+#if WLOG_SPAN && (defined(_WIN32) || defined(__KERNEL__))
+	#error "haven't implement!"
+#endif
+
+//日志文件的稀疏索引只在linux下WLOG_TO_FILE实现，详见wlog_index.h
+#if WLOG_INDEX && (defined(_WIN32) || defined(__KERNEL__) || (WLOG_TO != WLOG_TO_FILE))
+	#error "haven't implement!"
+#endif
+
+//异步模式下logFatal/logVerify/logAssert需要等待队列写空，其他模式为空
+#ifndef WLOG_ASYNC_DRAIN_CHECK
+	#define WLOG_ASYNC_DRAIN_CHECK(nType)
+#endif
+
+//WLOG_FLIGHT下ERROR以上的日志写出之前先写出本线程在内存里的记录，其他模式为空
+#ifndef WLOG_FLIGHT_CHECK
+	#define WLOG_FLIGHT_CHECK(nType)
+#endif
+
+//WLOG_STATS下统计logBase系列的条数与耗时，详见wlog_stats.h；其他模式为空
+#if WLOG_STATS
+	#if defined(_WIN32) || defined(__KERNEL__)
+		#error "haven't implement!"
+	#endif
+	#include "wlog_stats.h"
+#else
+	#define WLOG_STATS_BEGIN()
+	#define WLOG_STATS_END(nType)
+	#define WLOG_STATS_SUPPRESSED(nType)
+#endif
+
 //unicode处理事务
 #if defined(_UNICODE) || defined(UNICODE)
 	#define _STR2WIDE(x) L ## x
@@ -176,7 +351,7 @@
 #endif
 
 //输出设置
-#if (WLOG_TO == WLOG_TO_FILE)
+#if (WLOG_TO == WLOG_TO_FILE) || (WLOG_TO == WLOG_TO_MMAP)
 	#ifndef WLOG_FILE_NAME
 		#define WLOG_FILE_NAME _T("w.log")
 	#endif
@@ -191,55 +366,81 @@
 	#define WLOG_CHECK_FILE_EXIST 
 #endif
 
+//调用点的文件名与静态登记
+#if (WLOG_TO != WLOG_TO_KERNEL)
+	#include "wlog_site.h"
+#endif
+
+//logXXXR限速、logXXXS采样
+#include "wlog_limit.h"
+
+//长日志的每线程缓冲池，写日志不再malloc/free，详见wlog_arena.h
+#if !defined(_WIN32) && (WLOG_TO != WLOG_TO_KERNEL)
+	#include "wlog_arena.h"
+#endif
+
 //针对windows版本的日志接口定义
 #ifdef _WIN32	
 	//logText
 	#if (WLOG_STATIC_TYPE_SWITCH&WLOG_TYPE_TEXT)
 		#if (WLOG_TO == WLOG_TO_CONSOLE)
 			#define logText(format, ...)  WLOG_DYNAMIC_CHECK_TEXT _tprintf(format,__VA_ARGS__)
-		#elif (WLOG_TO == WLOG_TO_KERNEL)
+			#define __wlog_log_text_t(nType, format, ...) logText(format, __VA_ARGS__)
+			#define wlogFlush() fflush(stdout)
+		#elif (WLOG_TO == WLOG_TO_KERNEL) || (WLOG_TO == WLOG_TO_MMAP)
 			#error "haven't implement!"
 		#elif (WLOG_TO == WLOG_TO_IDE)
+			//先格式化到栈上，只有放不下时才计算长度、分配内存再格式化一遍
 			inline void __wlog_ide_write_imp(const TCHAR* format, ...) {
 				va_list arglist;
 				va_start(arglist, format);
 				TCHAR buffer[WLOG_MAX_BUFFER_SIZE];
-				TCHAR* pBuffer = buffer;
-				int nNeedSize = _vsctprintf(format, arglist) + 1;// _vscprintf doesn't count
-				if (nNeedSize > WLOG_MAX_BUFFER_SIZE) {
-					pBuffer = (TCHAR*)malloc(nNeedSize * sizeof(TCHAR));
-				}
-				if ((NULL != pBuffer) && (nNeedSize-1) == _vstprintf_s(pBuffer, nNeedSize, format, arglist)) {
-					OutputDebugString(pBuffer);
+				if (_vsntprintf_s(buffer, WLOG_MAX_BUFFER_SIZE, _TRUNCATE, format, arglist) >= 0) {
+					OutputDebugString(buffer);
+				} else {
+					int nNeedSize = _vsctprintf(format, arglist) + 1;// _vscprintf doesn't count
+					TCHAR* pBuffer = (nNeedSize > 1) ? (TCHAR*)malloc(nNeedSize * sizeof(TCHAR)) : NULL;
+					if ((NULL != pBuffer) && (nNeedSize-1) == _vstprintf_s(pBuffer, nNeedSize, format, arglist)) {
+						OutputDebugString(pBuffer);
+					}
+					free(pBuffer);
 				}
-				if (nNeedSize > WLOG_MAX_BUFFER_SIZE && NULL != pBuffer)free(pBuffer);
 				va_end(arglist);
 			}
 			#define logText(format, ...)  WLOG_DYNAMIC_CHECK_TEXT __wlog_ide_write_imp(format,__VA_ARGS__)
+			#define __wlog_log_text_t(nType, format, ...) logText(format, __VA_ARGS__)
 		#else
-			inline void __wlog_file_write_valist_imp(const TCHAR* format, va_list arglist) {
-				static FILE *g_wlogOutFileHandle = NULL;
-				if (g_wlogOutFileHandle == NULL) {
+			#include "wlog_file.h"
+			inline void __wlog_file_write_valist_imp(unsigned int nType, const TCHAR* format, va_list arglist) {
+				FILE** ppHandle = __wlog_file_handle();
+				FILE* hFile = *ppHandle;
+				if (hFile == NULL) {
 					WLOG_CHECK_FILE_EXIST;
-					g_wlogOutFileHandle = _tfsopen(WLOG_FILE_NAME, _T("a"), _SH_DENYNO);
+					hFile = *ppHandle = _tfsopen(WLOG_FILE_NAME, _T("a"), _SH_DENYNO);
 					//if (0 != _tfopen_s(&g_wlogOutFileHandle, WLOG_FILE_NAME,_T("w")WLOG_OPEN_APPEND)) return;
-					if(g_wlogOutFileHandle) {
-						_ftprintf(g_wlogOutFileHandle,_T("\n++++++++++W+++++++++++\n"));
+					if(hFile) {
+						_ftprintf(hFile,_T("\n++++++++++W+++++++++++\n"));
+						__wlog_flush_reset_imp(__wlog_flush_state());
 					} else return;
 				}
-				if(_vftprintf_s(g_wlogOutFileHandle, format, arglist) < 0) {
-					g_wlogOutFileHandle = NULL;
+				__wlog_file_lock(hFile);
+				int nWritten = _vftprintf_s(hFile, format, arglist);
+				if(nWritten < 0) {
+					*ppHandle = NULL;
 				} else {		
-					fflush(g_wlogOutFileHandle);
+					__wlog_flush_policy_imp(hFile, nType, 1, (unsigned long)nWritten);
 				}
+				__wlog_file_unlock(hFile);
 			}
-			inline void __wlog_file_write_imp(const TCHAR* format, ...) {
+			inline void __wlog_file_write_imp(unsigned int nType, const TCHAR* format, ...) {
 				va_list arglist;
 				va_start(arglist, format);
-				__wlog_file_write_valist_imp(format, arglist);
+				__wlog_file_write_valist_imp(nType, format, arglist);
 				va_end(arglist);
 			}
-			#define logText(format, ...) WLOG_DYNAMIC_CHECK_TEXT __wlog_file_write_imp(format, __VA_ARGS__)
+			#define logText(format, ...) WLOG_DYNAMIC_CHECK_TEXT __wlog_file_write_imp(WLOG_TYPE_TEXT, format, __VA_ARGS__)
+			#define __wlog_log_text_t(nType, format, ...) WLOG_DYNAMIC_CHECK_TEXT __wlog_file_write_imp(nType, format, __VA_ARGS__)
+			#define wlogFlush() __wlog_file_flush_imp()
 		#endif				
 		inline void __wlog_log_text_n(const TCHAR* szFormat, const TCHAR* szBuf, int nPrintCount) {
 			if(0 == szFormat || 0 == szBuf || nPrintCount == 0) {
@@ -280,9 +481,10 @@
 		}
 		#define logBase(nType, chType, format, ...)  do {\
 			WLOG_DYNAMIC_CHECK(nType);\
+			WLOG_SITE_DEFINE(nType, chType, format);\
 			TCHAR __wlog_tmp_ctime_buf[15];\
 			__wlog_format_time_imp(__wlog_tmp_ctime_buf, 15);\
-			logText(_T("%s %c %s:%-4d| ") format _T("\n"), __wlog_tmp_ctime_buf, chType, _tcsrchr(__TFILE__, _T('\\'))+1,__LINE__,__VA_ARGS__);\
+			__wlog_log_text_t(nType, _T("%s %c %s:%-4d| ") format _T("\n"), __wlog_tmp_ctime_buf, chType, WLOG_SITE_FILE,__LINE__,__VA_ARGS__);\
 		} while (0)
 		#define logBaseC(condition, nType, chType, format, ...) if(condition) logBase(nType, chType, format, __VA_ARGS__)
 		#define logBaseN(nType, chType, szFormat, szBuf, nPrintCount, format, ...) do {\
@@ -292,6 +494,23 @@
 			logBase(nType, chType, _T("[E.N.D]"));\
 		} while (0)
 		#define logBaseCN(condition, nType, chType, szFormat, szBuf, nPrintCount, format, ...) if(condition) logBaseN(nType, chType, szFormat, szBuf, nPrintCount, format, __VA_ARGS__)
+		//限速、采样，被丢弃的条数在下一条输出的日志前面注明
+		#define logBaseR(nPerSecond, nType, chType, format, ...) do {\
+			WLOG_DYNAMIC_CHECK(nType);\
+			static __wlog_limit_t __wlog_limit = {0, 0};\
+			long __wlog_suppressed = 0;\
+			if (!__wlog_limit_rate_imp(&__wlog_limit, nPerSecond, &__wlog_suppressed)) break;\
+			if (0 == __wlog_suppressed) logBase(nType, chType, format, __VA_ARGS__);\
+			else logBase(nType, chType, _T("(suppressed %ld) ") format, __wlog_suppressed, __VA_ARGS__);\
+		} while (0)
+		#define logBaseS(nSample, nType, chType, format, ...) do {\
+			WLOG_DYNAMIC_CHECK(nType);\
+			static __wlog_limit_t __wlog_limit = {0, 0};\
+			long __wlog_suppressed = 0;\
+			if (!__wlog_limit_sample_imp(&__wlog_limit, nSample, &__wlog_suppressed)) break;\
+			if (0 == __wlog_suppressed) logBase(nType, chType, format, __VA_ARGS__);\
+			else logBase(nType, chType, _T("(suppressed %ld) ") format, __wlog_suppressed, __VA_ARGS__);\
+		} while (0)
 	#endif
 
 	//log other type
@@ -300,30 +519,40 @@
 		#define logTraceC(condition, format, ...) logBaseC(condition, WLOG_TYPE_TRACE, _T('T'), format, __VA_ARGS__)
 		#define logTraceN(szFormat, szBuf, nPrintCount, format, ...) logBaseN(WLOG_TYPE_TRACE, _T('T'), szFormat, szBuf, nPrintCount, format, __VA_ARGS__)
 		#define logTraceCN(condition, szFormat, szBuf, nPrintCount, format, ...) logBaseCN(condition, WLOG_TYPE_TRACE, _T('T'), szFormat, szBuf, nPrintCount, format, __VA_ARGS__)
+		#define logTraceR(nPerSecond, format, ...) logBaseR(nPerSecond, WLOG_TYPE_TRACE, _T('T'), format, __VA_ARGS__)
+		#define logTraceS(nSample, format, ...) logBaseS(nSample, WLOG_TYPE_TRACE, _T('T'), format, __VA_ARGS__)
 	#endif
 	#if (WLOG_STATIC_TYPE_SWITCH&WLOG_TYPE_DEBUG)
 		#define logDebug(format, ...) logBase(WLOG_TYPE_DEBUG, _T('D'), format, __VA_ARGS__)
 		#define logDebugC(condition, format, ...) logBaseC(condition, WLOG_TYPE_DEBUG, _T('D'), format, __VA_ARGS__)
 		#define logDebugN(szFormat, szBuf, nPrintCount, format, ...) logBaseN(WLOG_TYPE_DEBUG, _T('D'), szFormat, szBuf, nPrintCount, format, __VA_ARGS__)
 		#define logDebugCN(condition, szFormat, szBuf, nPrintCount, format, ...) logBaseCN(condition, WLOG_TYPE_DEBUG, _T('D'), szFormat, szBuf, nPrintCount, format, __VA_ARGS__)
+		#define logDebugR(nPerSecond, format, ...) logBaseR(nPerSecond, WLOG_TYPE_DEBUG, _T('D'), format, __VA_ARGS__)
+		#define logDebugS(nSample, format, ...) logBaseS(nSample, WLOG_TYPE_DEBUG, _T('D'), format, __VA_ARGS__)
 	#endif
 	#if (WLOG_STATIC_TYPE_SWITCH&WLOG_TYPE_INFO)
 		#define logInfo(format, ...) logBase(WLOG_TYPE_INFO, _T('I'), format, __VA_ARGS__)
 		#define logInfoC(condition, format, ...) logBaseC(condition, WLOG_TYPE_INFO, _T('I'), format, __VA_ARGS__)
 		#define logInfoN(szFormat, szBuf, nPrintCount, format, ...) logBaseN(WLOG_TYPE_INFO, _T('I'), szFormat, szBuf, nPrintCount, format, __VA_ARGS__)
 		#define logInfoCN(condition, szFormat, szBuf, nPrintCount, format, ...) logBaseCN(condition, WLOG_TYPE_INFO, _T('I'), szFormat, szBuf, nPrintCount, format, __VA_ARGS__)
+		#define logInfoR(nPerSecond, format, ...) logBaseR(nPerSecond, WLOG_TYPE_INFO, _T('I'), format, __VA_ARGS__)
+		#define logInfoS(nSample, format, ...) logBaseS(nSample, WLOG_TYPE_INFO, _T('I'), format, __VA_ARGS__)
 	#endif
 	#if (WLOG_STATIC_TYPE_SWITCH&WLOG_TYPE_NOTICE)
 		#define logNotice(format, ...) logBase(WLOG_TYPE_NOTICE, _T('N'), format, __VA_ARGS__)
 		#define logNoticeC(condition, format, ...) logBaseC(condition, WLOG_TYPE_NOTICE, _T('N'), format, __VA_ARGS__)
 		#define logNoticeN(szFormat, szBuf, nPrintCount, format, ...) logBaseN(WLOG_TYPE_NOTICE, _T('N'), szFormat, szBuf, nPrintCount, format, __VA_ARGS__)
 		#define logNoticeCN(condition, szFormat, szBuf, nPrintCount, format, ...) logBaseCN(condition, WLOG_TYPE_NOTICE, _T('N'), szFormat, szBuf, nPrintCount, format, __VA_ARGS__)
+		#define logNoticeR(nPerSecond, format, ...) logBaseR(nPerSecond, WLOG_TYPE_NOTICE, _T('N'), format, __VA_ARGS__)
+		#define logNoticeS(nSample, format, ...) logBaseS(nSample, WLOG_TYPE_NOTICE, _T('N'), format, __VA_ARGS__)
 	#endif
 	#if (WLOG_STATIC_TYPE_SWITCH&WLOG_TYPE_WARNING)
 		#define logWarning(format, ...) logBase(WLOG_TYPE_WARNING, _T('W'), format, __VA_ARGS__)
 		#define logWarningC(condition, format, ...) logBaseC(condition, WLOG_TYPE_WARNING, _T('W'), format, __VA_ARGS__)
 		#define logWarningN(szFormat, szBuf, nPrintCount, format, ...) logBaseN(WLOG_TYPE_WARNING, _T('W'), szFormat, szBuf, nPrintCount, format, __VA_ARGS__)
 		#define logWarningCN(condition, szFormat, szBuf, nPrintCount, format, ...) logBaseCN(condition, WLOG_TYPE_WARNING, _T('W'), szFormat, szBuf, nPrintCount, format, __VA_ARGS__)
+		#define logWarningR(nPerSecond, format, ...) logBaseR(nPerSecond, WLOG_TYPE_WARNING, _T('W'), format, __VA_ARGS__)
+		#define logWarningS(nSample, format, ...) logBaseS(nSample, WLOG_TYPE_WARNING, _T('W'), format, __VA_ARGS__)
 	#endif	
 	#if (WLOG_STATIC_TYPE_SWITCH&WLOG_TYPE_VERIFY)
 		#define logVerify(condition) if(!(condition)){logBase(WLOG_TYPE_VERIFY, _T('V'), _T(#condition));abort();}
@@ -336,59 +565,103 @@
 		#define logErrorC(condition, format, ...) logBaseC(condition, WLOG_TYPE_ERROR, _T('E'), format, __VA_ARGS__)
 		#define logErrorN(szFormat, szBuf, nPrintCount, format, ...) logBaseN(WLOG_TYPE_ERROR, _T('E'), szFormat, szBuf, nPrintCount, format, __VA_ARGS__)
 		#define logErrorCN(condition, szFormat, szBuf, nPrintCount, format, ...) logBaseCN(condition, WLOG_TYPE_ERROR, _T('E'), szFormat, szBuf, nPrintCount, format, __VA_ARGS__)
+		#define logErrorR(nPerSecond, format, ...) logBaseR(nPerSecond, WLOG_TYPE_ERROR, _T('E'), format, __VA_ARGS__)
+		#define logErrorS(nSample, format, ...) logBaseS(nSample, WLOG_TYPE_ERROR, _T('E'), format, __VA_ARGS__)
 	#endif
 	#if (WLOG_STATIC_TYPE_SWITCH&WLOG_TYPE_FATAL)
 		#define logFatal(format, ...) logBase(WLOG_TYPE_FATAL, _T('F'), format, __VA_ARGS__)
 		#define logFatalC(condition, format, ...) logBaseC(condition, WLOG_TYPE_FATAL, _T('F'), format, __VA_ARGS__)
 		#define logFatalN(szFormat, szBuf, nPrintCount, format, ...) logBaseN(WLOG_TYPE_FATAL, _T('F'), szFormat, szBuf, nPrintCount, format, __VA_ARGS__)
 		#define logFatalCN(condition, szFormat, szBuf, nPrintCount, format, ...) logBaseCN(condition, WLOG_TYPE_FATAL, _T('F'), szFormat, szBuf, nPrintCount, format, __VA_ARGS__)
+		#define logFatalR(nPerSecond, format, ...) logBaseR(nPerSecond, WLOG_TYPE_FATAL, _T('F'), format, __VA_ARGS__)
+		#define logFatalS(nSample, format, ...) logBaseS(nSample, WLOG_TYPE_FATAL, _T('F'), format, __VA_ARGS__)
 	#endif
 #else// not _WIN32
 	#if (WLOG_STATIC_TYPE_SWITCH&WLOG_TYPE_TEXT)
 		#if (WLOG_TO == WLOG_TO_CONSOLE)
 			#define logText(format, args...)  WLOG_DYNAMIC_CHECK_TEXT printf(format,##args)
+			#define __wlog_log_text_t(nType, format, args...) logText(format, ##args)
+			#define wlogFlush() fflush(stdout)
+			inline void __wlog_sink_write_imp(unsigned int nType, const char* pRecord, size_t nLen) {
+				(void)nType;
+				fwrite(pRecord, 1, nLen, stdout);
+			}
 		#elif (WLOG_TO == WLOG_TO_KERNEL)
 			#define logText(format, args...)  WLOG_DYNAMIC_CHECK_TEXT printk(format,##args)
+			#define __wlog_log_text_t(nType, format, args...) logText(format, ##args)
+		#elif (WLOG_TO == WLOG_TO_MMAP)
+			#include "wlog_mmap.h"
+			#define logText(format, args...) WLOG_DYNAMIC_CHECK_TEXT __wlog_mmap_write_imp(WLOG_TYPE_TEXT, format, ##args)
+			#define __wlog_log_text_t(nType, format, args...) WLOG_DYNAMIC_CHECK_TEXT __wlog_mmap_write_imp(nType, format, ##args)
+		#elif (WLOG_TO == WLOG_TO_SHM)
+			#include "wlog_shm.h"
+			#define logText(format, args...) WLOG_DYNAMIC_CHECK_TEXT __wlog_shm_write_imp(WLOG_TYPE_TEXT, format, ##args)
+			#define __wlog_log_text_t(nType, format, args...) WLOG_DYNAMIC_CHECK_TEXT __wlog_shm_write_imp(nType, format, ##args)
+		#elif (WLOG_TO == WLOG_TO_SOCKET)
+			#include "wlog_socket.h"
+			#define logText(format, args...) WLOG_DYNAMIC_CHECK_TEXT __wlog_socket_write_imp(WLOG_TYPE_TEXT, format, ##args)
+			#define __wlog_log_text_t(nType, format, args...) WLOG_DYNAMIC_CHECK_TEXT __wlog_socket_write_imp(nType, format, ##args)
 		#else
-			inline void __wlog_file_write_valist_imp(const char* format, va_list arglist) {
-				static FILE *g_wlogOutFileHandle = NULL;
-				if (g_wlogOutFileHandle == NULL) {
-					WLOG_CHECK_FILE_EXIST;
-					g_wlogOutFileHandle = fopen(WLOG_FILE_NAME,_T("a"));
-					if(g_wlogOutFileHandle) {
-						fprintf(g_wlogOutFileHandle,_T("\n++++++++++WLOG+++++++++++\n"));
-					} else return;
+			#include "wlog_file.h"
+			#if WLOG_ASYNC
+				#include "wlog_async.h"
+			#else
+				#include "wlog_stage.h"
+			#endif
+			#if WLOG_BINARY
+				#include "wlog_binary.h"
+				#define logText(format, args...) WLOG_DYNAMIC_CHECK_TEXT __wlog_bin_text_imp(WLOG_TYPE_TEXT, format, ##args)
+				#define __wlog_log_text_t(nType, format, args...) WLOG_DYNAMIC_CHECK_TEXT __wlog_bin_text_imp(nType, format, ##args)
+			#else
+				inline void __wlog_file_write_imp(unsigned int nType, const char* format, ...) {
+					va_list arglist;
+					va_start(arglist, format);
+					__wlog_file_write_valist_imp(nType, format, arglist);
+					va_end(arglist);
 				}
-				if (vfprintf(g_wlogOutFileHandle, format, arglist) < 0) {
-					g_wlogOutFileHandle = NULL;
-				} else {
-					fflush(g_wlogOutFileHandle);
+				#define logText(format, args...) WLOG_DYNAMIC_CHECK_TEXT __wlog_file_write_imp(WLOG_TYPE_TEXT, format, ##args)
+				#define __wlog_log_text_t(nType, format, args...) WLOG_DYNAMIC_CHECK_TEXT __wlog_file_write_imp(nType, format, ##args)
+			#endif
+			//收集进程：把WLOG_TO_SHM的共享内存队列写进WLOG_FILE_NAME
+			#if WLOG_SHM_COLLECTOR
+				#include "wlog_shm.h"
+			#endif
+		#endif
+		#if WLOG_MULTI_SINK
+			#include "wlog_sink.h"
+		#elif (WLOG_TO != WLOG_TO_KERNEL) && !(WLOG_BINARY && (WLOG_TO == WLOG_TO_FILE))
+			inline void __wlog_write_record_imp(unsigned int nType, const char* pRecord, size_t nLen) {
+				__wlog_sink_write_imp(nType, pRecord, nLen);
+			}
+		#endif
+		#if (WLOG_TO == WLOG_TO_KERNEL)
+			inline void __wlog_log_text_n(const char* szFormat, const char* szBuf, int nPrintCount) {
+				if(0 == szFormat || 0 == szBuf || nPrintCount == 0) {
+					logText(_T("CAN'T LOG TEXT N {format(%p), szBuf(%p), printcount(%d)}\n"), (void*)szFormat, szBuf, nPrintCount);
+					return;
+				}		    
+				unsigned char* pPrintStart = (unsigned char*)szBuf;
+				if(nPrintCount < 0) {
+					pPrintStart = pPrintStart + nPrintCount;
+					nPrintCount = -nPrintCount;
+				}		    
+				unsigned int nIdx = 0;
+				while(nIdx < (unsigned int)nPrintCount) {
+					logText(szFormat, (unsigned char)pPrintStart[nIdx++]);
 				}
+				logText(_T("\n"));
 			}
-			inline void __wlog_file_write_imp(const char* format, ...) {
-				va_list arglist;
-				va_start(arglist, format);
-				__wlog_file_write_valist_imp(format, arglist);
-				va_end(arglist);
+		#else
+			#include "wlog_dump.h"
+			inline void __wlog_log_text_n(const char* szFormat, const char* szBuf, int nPrintCount) {
+				char szStack[WLOG_DUMP_STACK_SIZE];
+				__wlog_dump_buf_t dumpBuf;
+				__wlog_dump_init(&dumpBuf, szStack, sizeof(szStack));
+				__wlog_dump_payload(&dumpBuf, szFormat, szBuf, nPrintCount);
+				__wlog_write_record_imp(WLOG_TYPE_TEXT, dumpBuf.pData, dumpBuf.nLen);
+				__wlog_dump_free(&dumpBuf);
 			}
-			#define logText(format, args...) WLOG_DYNAMIC_CHECK_TEXT __wlog_file_write_imp(format, ##args)
 		#endif
-		inline void __wlog_log_text_n(const char* szFormat, const char* szBuf, int nPrintCount) {
-			if(0 == szFormat || 0 == szBuf || nPrintCount == 0) {
-				logText(_T("CAN'T LOG TEXT N {format(%p), szBuf(%p), printcount(%d)}\n"), (void*)szFormat, szBuf, nPrintCount);
-				return;
-			}		    
-			unsigned char* pPrintStart = (unsigned char*)szBuf;
-			if(nPrintCount < 0) {
-				pPrintStart = pPrintStart + nPrintCount;
-				nPrintCount = -nPrintCount;
-			}		    
-			unsigned int nIdx = 0;
-			while(nIdx < (unsigned int)nPrintCount) {
-				logText(szFormat, (unsigned char)pPrintStart[nIdx++]);
-			}
-			logText(_T("\n"));
-		}
 		#define logTextC(condition, format, args...) if(condition) logText(format, ##args)		
 		#define logTextN(szFormat, szBuf, nPrintCount) WLOG_DYNAMIC_CHECK_TEXT __wlog_log_text_n(szFormat, szBuf, nPrintCount)
 		#define logTextCN(condition, szFormat, szBuf, nPrintCount) if(condition) logTextN(szFormat, szBuf, nPrintCount)
@@ -402,27 +675,168 @@
                 logText(_T("%lu %c %s:%-4d| ")format _T("\n"), jiffies, chType, __FILE__,__LINE__,##args);\
             } while (0)
         #else
+			//取当前时间，按值返回
+			inline struct timespec __wlog_time_now_imp() {
+				struct timespec tsNow;
+				clock_gettime(WLOG_TIME_CLOCK, &tsNow);
+				return tsNow;
+			}
+			//把nSecond格式化成"MM-DD HH:MM:SS "写进pCached，失败返回0
+			inline int __wlog_format_second_imp(time_t nSecond, char * pCached) {
+				struct tm tmNow;
+				if (NULL == localtime_r(&nSecond, &tmNow)) return 0;
+				unsigned int nFields[5] = {(unsigned int)tmNow.tm_mon + 1, (unsigned int)tmNow.tm_mday,
+					(unsigned int)tmNow.tm_hour, (unsigned int)tmNow.tm_min, (unsigned int)tmNow.tm_sec};
+				unsigned int nField = 0;
+				for (; nField < 5; ++nField) {
+					pCached[nField * 3] = (char)('0' + nFields[nField] / 10 % 10);
+					pCached[nField * 3 + 1] = (char)('0' + nFields[nField] % 10);
+					pCached[nField * 3 + 2] = _T("- :: ")[nField];
+				}
+				return 1;
+			}
+			//每个线程缓存"MM-DD HH:MM:SS"，秒变化时才调用localtime_r重新生成，同一秒内只补毫秒/微秒；
+			//取时间和localtime_r都放在上面两个函数里，本函数没有取过地址的局部变量，
+			//否则GCC 12在WLOG_TIME_PRECISION=0、-O2下会误报-Wdangling-pointer
 			inline void __wlog_format_time_imp(char * pOutBuffer, unsigned int nBufferCount) {
-				time_t timeData = time(NULL);
-				struct tm *p = localtime(&timeData);
-				p->tm_mon += 1;
-				snprintf(pOutBuffer,nBufferCount,_T("%02d-%02d %02d:%02d:%02d"), p->tm_mon, p->tm_mday,p->tm_hour,p->tm_min,p->tm_sec);
+				static __thread time_t g_wlogCachedSecond = -1;
+				static __thread char g_wlogCachedTime[15];
+				if (nBufferCount < WLOG_TIME_BUFFER_SIZE) {
+					pOutBuffer[0] = 0;
+					return;
+				}
+				struct timespec tsNow = __wlog_time_now_imp();
+				if (tsNow.tv_sec != g_wlogCachedSecond) {
+					if (!__wlog_format_second_imp(tsNow.tv_sec, g_wlogCachedTime)) {
+						memcpy(pOutBuffer, _T("<error time>"), 13);
+						return;
+					}
+					g_wlogCachedSecond = tsNow.tv_sec;
+				}
+				memcpy(pOutBuffer, g_wlogCachedTime, 14);
+				#if (WLOG_TIME_PRECISION > 0)
+					unsigned int nFraction = (unsigned int)(tsNow.tv_nsec / WLOG_TIME_FRACTION_DIV);
+					int nIdx = 14 + WLOG_TIME_PRECISION;
+					pOutBuffer[14] = '.';
+					for (; nIdx > 14; --nIdx) {
+						pOutBuffer[nIdx] = (char)('0' + nFraction % 10);
+						nFraction /= 10;
+					}
+				#endif
+				pOutBuffer[WLOG_TIME_BUFFER_SIZE - 1] = 0;
 			}
-            #define logBase(nType, chType, format, args...)  do {\
-                WLOG_DYNAMIC_CHECK(nType); \
-                char __wlog_tmp_ctime_buf[15];\
-                __wlog_format_time_imp(__wlog_tmp_ctime_buf, 15);\
-                logText(_T("%s %c %s:%-4d| ") format _T("\n"), __wlog_tmp_ctime_buf, chType, __FILE__,__LINE__,##args);\
-            } while (0)
+            #if WLOG_BINARY && (WLOG_TO == WLOG_TO_FILE) && (WLOG_STATIC_TYPE_SWITCH&WLOG_TYPE_TEXT)
+                //二进制模式：每个调用点一个静态登记项，只写编号、时间与参数
+                #define logBase(nType, chType, format, args...)  do {\
+                    WLOG_DYNAMIC_CHECK(nType); \
+                    WLOG_SITE_DEFINE(nType, chType, format);\
+                    static __wlog_bin_site_t __wlog_bin_site = {0, 0, &__wlog_site};\
+                    WLOG_STATS_BEGIN();\
+                    WLOG_DYNAMIC_CHECK_TEXT __wlog_bin_log(&__wlog_bin_site, ##args);\
+                    WLOG_STATS_END(nType);\
+                    WLOG_ASYNC_DRAIN_CHECK(nType);\
+                } while (0)
+            #elif WLOG_JSON && (WLOG_STATIC_TYPE_SWITCH&WLOG_TYPE_TEXT)
+                //JSON模式：每条日志编码成一行JSON，见wlog_json.h
+                #define logBase(nType, chType, format, args...)  do {\
+                    WLOG_DYNAMIC_CHECK(nType); \
+                    WLOG_SITE_DEFINE(nType, chType, format);\
+                    WLOG_STATS_BEGIN();\
+                    WLOG_DYNAMIC_CHECK_TEXT __wlog_json_log_imp(nType, WLOG_SITE_FILE, __LINE__, format, ##args);\
+                    WLOG_STATS_END(nType);\
+                    WLOG_ASYNC_DRAIN_CHECK(nType);\
+                } while (0)
+            #else
+                #define logBase(nType, chType, format, args...)  do {\
+                    WLOG_DYNAMIC_CHECK(nType); \
+                    WLOG_SITE_DEFINE(nType, chType, format);\
+                    WLOG_FLIGHT_CHECK(nType);\
+                    WLOG_STATS_BEGIN();\
+                    char __wlog_tmp_ctime_buf[WLOG_TIME_BUFFER_SIZE];\
+                    __wlog_format_time_imp(__wlog_tmp_ctime_buf, WLOG_TIME_BUFFER_SIZE);\
+                    __wlog_log_text_t(nType, _T("%s %c %s:%-4d| ") format _T("\n"), __wlog_tmp_ctime_buf, chType, WLOG_SITE_FILE,__LINE__,##args);\
+                    WLOG_STATS_END(nType);\
+                    WLOG_ASYNC_DRAIN_CHECK(nType);\
+                } while (0)
+            #endif
         #endif
         #define logBaseC(condition, nType, chType, format, args...) if(condition) logBase(nType, chType, format, ##args)
-		#define logBaseN(nType, chType, szFormat, szBuf, nPrintCount, format, args...) do {\
-			WLOG_DYNAMIC_CHECK(nType); \
-			logBase(nType, chType, _T("[START](%d) ")format, nPrintCount, ##args);\
-			logTextN(szFormat, szBuf, nPrintCount);\
-			logBase(nType, chType, _T("[E.N.D]"));\
-		} while (0)
+		#if (WLOG_TO == WLOG_TO_KERNEL) || !(WLOG_STATIC_TYPE_SWITCH&WLOG_TYPE_TEXT)
+			#define logBaseN(nType, chType, szFormat, szBuf, nPrintCount, format, args...) do {\
+				WLOG_DYNAMIC_CHECK(nType); \
+				logBase(nType, chType, _T("[START](%d) ")format, nPrintCount, ##args);\
+				logTextN(szFormat, szBuf, nPrintCount);\
+				logBase(nType, chType, _T("[E.N.D]"));\
+			} while (0)
+		#elif WLOG_JSON
+			//JSON模式：数据放在同一条日志的"data"字段里
+			#define logBaseN(nType, chType, szFormat, szBuf, nPrintCount, format, args...) do {\
+				WLOG_DYNAMIC_CHECK(nType); \
+				WLOG_SITE_DEFINE(nType, chType, format);\
+				WLOG_STATS_BEGIN();\
+				WLOG_DYNAMIC_CHECK_TEXT __wlog_json_log_n_imp(nType, WLOG_SITE_FILE, __LINE__, szFormat, szBuf, nPrintCount, format, ##args);\
+				WLOG_STATS_END(nType);\
+				WLOG_ASYNC_DRAIN_CHECK(nType);\
+			} while (0)
+		#else
+			//[START]行、数据、[E.N.D]行拼成一条日志一次写出，避免与其他线程的日志交错
+			inline void __wlog_log_base_n(unsigned int nType, char chType, const char* szFile, int nLine,
+				const char* szFormat, const char* szBuf, int nPrintCount, const char* format, ...) {
+				char szTime[WLOG_TIME_BUFFER_SIZE];
+				char szStack[WLOG_DUMP_STACK_SIZE];
+				__wlog_dump_buf_t dumpBuf;
+				__wlog_dump_init(&dumpBuf, szStack, sizeof(szStack));
+				__wlog_format_time_imp(szTime, WLOG_TIME_BUFFER_SIZE);
+				__wlog_dump_append(&dumpBuf, _T("%s %c %s:%-4d| "), szTime, chType, szFile, nLine);
+				size_t nHeadLen = dumpBuf.nLen;
+				va_list arglist;
+				va_start(arglist, format);
+				__wlog_dump_append_valist(&dumpBuf, format, arglist);
+				va_end(arglist);
+				__wlog_dump_append(&dumpBuf, _T("\n"));
+				__wlog_dump_payload(&dumpBuf, szFormat, szBuf, nPrintCount);
+				if (__wlog_dump_reserve(&dumpBuf, nHeadLen + 8)) {
+					memcpy(dumpBuf.pData + dumpBuf.nLen, dumpBuf.pData, nHeadLen);
+					memcpy(dumpBuf.pData + dumpBuf.nLen + nHeadLen, _T("[E.N.D]\n"), 8);
+					dumpBuf.nLen += nHeadLen + 8;
+				}
+				__wlog_write_record_imp(nType, dumpBuf.pData, dumpBuf.nLen);
+				__wlog_dump_free(&dumpBuf);
+			}
+			#define logBaseN(nType, chType, szFormat, szBuf, nPrintCount, format, args...) do {\
+				WLOG_DYNAMIC_CHECK(nType); \
+				WLOG_SITE_DEFINE(nType, chType, _T("[START](%d) ")format);\
+				WLOG_FLIGHT_CHECK(nType);\
+				WLOG_STATS_BEGIN();\
+				WLOG_DYNAMIC_CHECK_TEXT __wlog_log_base_n(nType, chType, WLOG_SITE_FILE, __LINE__, szFormat, szBuf, nPrintCount, _T("[START](%d) ")format, nPrintCount, ##args);\
+				WLOG_STATS_END(nType);\
+				WLOG_ASYNC_DRAIN_CHECK(nType);\
+			} while (0)
+		#endif
 		#define logBaseCN(condition, nType, chType, szFormat, szBuf, nPrintCount, format, args...) if(condition) logBaseN(nType, chType, szFormat, szBuf, nPrintCount, format, ##args)
+		//限速、采样，被丢弃的条数在下一条输出的日志前面注明
+		#define logBaseR(nPerSecond, nType, chType, format, args...) do {\
+			WLOG_DYNAMIC_CHECK(nType);\
+			static __wlog_limit_t __wlog_limit = {0, 0};\
+			long __wlog_suppressed = 0;\
+			if (!__wlog_limit_rate_imp(&__wlog_limit, nPerSecond, &__wlog_suppressed)) {\
+				WLOG_STATS_SUPPRESSED(nType);\
+				break;\
+			}\
+			if (0 == __wlog_suppressed) logBase(nType, chType, format, ##args);\
+			else logBase(nType, chType, _T("(suppressed %ld) ") format, __wlog_suppressed, ##args);\
+		} while (0)
+		#define logBaseS(nSample, nType, chType, format, args...) do {\
+			WLOG_DYNAMIC_CHECK(nType);\
+			static __wlog_limit_t __wlog_limit = {0, 0};\
+			long __wlog_suppressed = 0;\
+			if (!__wlog_limit_sample_imp(&__wlog_limit, nSample, &__wlog_suppressed)) {\
+				WLOG_STATS_SUPPRESSED(nType);\
+				break;\
+			}\
+			if (0 == __wlog_suppressed) logBase(nType, chType, format, ##args);\
+			else logBase(nType, chType, _T("(suppressed %ld) ") format, __wlog_suppressed, ##args);\
+		} while (0)
 	#endif
 
 	//log other type
@@ -431,30 +845,40 @@
         #define logTraceC(condition, format, args...) logBaseC(condition, WLOG_TYPE_TRACE, _T('T'), format, ##args)
 		#define logTraceN(szFormat, szBuf, nPrintCount, format, args...) logBaseN(WLOG_TYPE_TRACE, _T('T'), szFormat, szBuf, nPrintCount, format, ##args)
 		#define logTraceCN(condition, szFormat, szBuf, nPrintCount, format, args...) logBaseCN(condition, WLOG_TYPE_TRACE, _T('T'), szFormat, szBuf, nPrintCount, format, ##args)
+		#define logTraceR(nPerSecond, format, args...) logBaseR(nPerSecond, WLOG_TYPE_TRACE, _T('T'), format, ##args)
+		#define logTraceS(nSample, format, args...) logBaseS(nSample, WLOG_TYPE_TRACE, _T('T'), format, ##args)
 	#endif
 	#if (WLOG_STATIC_TYPE_SWITCH&WLOG_TYPE_DEBUG)
 		#define logDebug(format, args...) logBase(WLOG_TYPE_DEBUG, _T('D'), format, ##args)
 		#define logDebugC(condition, format, args...) logBaseC(condition, WLOG_TYPE_DEBUG, _T('D'), format, ##args)
 		#define logDebugN(szFormat, szBuf, nPrintCount, format, args...) logBaseN(WLOG_TYPE_DEBUG, _T('D'), szFormat, szBuf, nPrintCount, format, ##args)
 		#define logDebugCN(condition, szFormat, szBuf, nPrintCount, format, args...) logBaseCN(condition, WLOG_TYPE_DEBUG, _T('D'), szFormat, szBuf, nPrintCount, format, ##args)
+		#define logDebugR(nPerSecond, format, args...) logBaseR(nPerSecond, WLOG_TYPE_DEBUG, _T('D'), format, ##args)
+		#define logDebugS(nSample, format, args...) logBaseS(nSample, WLOG_TYPE_DEBUG, _T('D'), format, ##args)
 	#endif
 	#if (WLOG_STATIC_TYPE_SWITCH&WLOG_TYPE_INFO)
 		#define logInfo(format, args...) logBase(WLOG_TYPE_INFO, _T('I'), format, ##args)
 		#define logInfoC(condition, format, args...) logBaseC(condition, WLOG_TYPE_INFO, _T('I'), format, ##args)
 		#define logInfoN(szFormat, szBuf, nPrintCount, format, args...) logBaseN(WLOG_TYPE_INFO, _T('I'), szFormat, szBuf, nPrintCount, format, ##args)
 		#define logInfoCN(condition, szFormat, szBuf, nPrintCount, format, args...) logBaseCN(condition, WLOG_TYPE_INFO, _T('I'), szFormat, szBuf, nPrintCount, format, ##args)
+		#define logInfoR(nPerSecond, format, args...) logBaseR(nPerSecond, WLOG_TYPE_INFO, _T('I'), format, ##args)
+		#define logInfoS(nSample, format, args...) logBaseS(nSample, WLOG_TYPE_INFO, _T('I'), format, ##args)
 	#endif
 	#if (WLOG_STATIC_TYPE_SWITCH&WLOG_TYPE_NOTICE)
 		#define logNotice(format, args...) logBase(WLOG_TYPE_NOTICE, _T('N'), format, ##args)
 		#define logNoticeC(condition, format, args...) logBaseC(condition, WLOG_TYPE_NOTICE, _T('N'), format, ##args)
 		#define logNoticeN(szFormat, szBuf, nPrintCount, format, args...) logBaseN(WLOG_TYPE_NOTICE, _T('N'), szFormat, szBuf, nPrintCount, format, ##args)
 		#define logNoticeCN(condition, szFormat, szBuf, nPrintCount, format, args...) logBaseCN(condition, WLOG_TYPE_NOTICE, _T('N'), szFormat, szBuf, nPrintCount, format, ##args)
+		#define logNoticeR(nPerSecond, format, args...) logBaseR(nPerSecond, WLOG_TYPE_NOTICE, _T('N'), format, ##args)
+		#define logNoticeS(nSample, format, args...) logBaseS(nSample, WLOG_TYPE_NOTICE, _T('N'), format, ##args)
 	#endif
 	#if (WLOG_STATIC_TYPE_SWITCH&WLOG_TYPE_WARNING)
 		#define logWarning(format, args...) logBase(WLOG_TYPE_WARNING, _T('W'), format, ##args)
 		#define logWarningC(condition, format, args...) logBaseC(condition, WLOG_TYPE_WARNING, _T('W'), format, ##args)
 		#define logWarningN(szFormat, szBuf, nPrintCount, format, args...) logBaseN(WLOG_TYPE_WARNING, _T('W'), szFormat, szBuf, nPrintCount, format, ##args)
 		#define logWarningCN(condition, szFormat, szBuf, nPrintCount, format, args...) logBaseCN(condition, WLOG_TYPE_WARNING, _T('W'), szFormat, szBuf, nPrintCount, format, ##args)
+		#define logWarningR(nPerSecond, format, args...) logBaseR(nPerSecond, WLOG_TYPE_WARNING, _T('W'), format, ##args)
+		#define logWarningS(nSample, format, args...) logBaseS(nSample, WLOG_TYPE_WARNING, _T('W'), format, ##args)
 	#endif
 	#if (WLOG_STATIC_TYPE_SWITCH&WLOG_TYPE_VERIFY)
 		#define logVerify(condition) if(!(condition)){logBase(WLOG_TYPE_VERIFY, _T('V'), _T(#condition)); abort();}
@@ -467,12 +891,21 @@
 		#define logErrorC(condition, format, args...) logBaseC(condition, WLOG_TYPE_ERROR, _T('E'), format, ##args)
 		#define logErrorN(szFormat, szBuf, nPrintCount, format, args...) logBaseN(WLOG_TYPE_ERROR, _T('E'), szFormat, szBuf, nPrintCount, format, ##args)
 		#define logErrorCN(condition, szFormat, szBuf, nPrintCount, format, args...) logBaseCN(condition, WLOG_TYPE_ERROR, _T('E'), szFormat, szBuf, nPrintCount, format, ##args)
+		#define logErrorR(nPerSecond, format, args...) logBaseR(nPerSecond, WLOG_TYPE_ERROR, _T('E'), format, ##args)
+		#define logErrorS(nSample, format, args...) logBaseS(nSample, WLOG_TYPE_ERROR, _T('E'), format, ##args)
 	#endif
 	#if (WLOG_STATIC_TYPE_SWITCH&WLOG_TYPE_FATAL)
 		#define logFatal(format, args...) logBase(WLOG_TYPE_FATAL, _T('F'), format, ##args)
 		#define logFatalC(condition, format, args...) logBaseC(condition, WLOG_TYPE_FATAL, _T('F'), format, ##args)
 		#define logFatalN(szFormat, szBuf, nPrintCount, format, args...) logBaseN(WLOG_TYPE_FATAL, _T('F'), szFormat, szBuf, nPrintCount, format, ##args)
 		#define logFatalCN(condition, szFormat, szBuf, nPrintCount, format, args...) logBaseCN(condition, WLOG_TYPE_FATAL, _T('F'), szFormat, szBuf, nPrintCount, format, ##args)
+		#define logFatalR(nPerSecond, format, args...) logBaseR(nPerSecond, WLOG_TYPE_FATAL, _T('F'), format, ##args)
+		#define logFatalS(nSample, format, args...) logBaseS(nSample, WLOG_TYPE_FATAL, _T('F'), format, ##args)
+	#endif
+
+	//静态关掉的级别记进内存，出错时再写出
+	#if WLOG_FLIGHT && (WLOG_TO != WLOG_TO_KERNEL) && (WLOG_STATIC_TYPE_SWITCH&WLOG_TYPE_TEXT)
+		#include "wlog_flight.h"
 	#endif
 #endif//_WIN32
 
@@ -482,42 +915,58 @@
 		#define logTextC(condition, format, ...)
 		#define logTextN(szFormat, szBuf, nPrintCount)
 		#define logTextCN(condition, szFormat, szBuf, nPrintCount)
+		#define __wlog_log_text_t(nType, format, ...)
+	#endif
+	#ifndef wlogFlush
+		#define wlogFlush()
 	#endif
 	#ifndef logBase
 		#define logBase(nType, chType, format, ...)
 		#define logBaseC(condition, nType, chType, format, ...)
 		#define logBaseN(nType, chType, szFormat, szBuf, nPrintCount, format, ...)
 		#define logBaseCN(condition, nType, chType, szFormat, szBuf, nPrintCount, format, ...)
+		#define logBaseR(nPerSecond, nType, chType, format, ...)
+		#define logBaseS(nSample, nType, chType, format, ...)
 	#endif
 	#ifndef logTrace
 		#define logTrace(format, ...)
 		#define logTraceC(condition, format, ...)
 		#define logTraceN(szFormat, szBuf, nPrintCount, format, ...)
 		#define logTraceCN(condition, szFormat, szBuf, nPrintCount, format, ...)
+		#define logTraceR(nPerSecond, format, ...)
+		#define logTraceS(nSample, format, ...)
 	#endif
 	#ifndef logDebug
 		#define logDebug(format, ...)
 		#define logDebugC(condition, format, ...)
 		#define logDebugN(szFormat, szBuf, nPrintCount, format, ...)
 		#define logDebugCN(condition, szFormat, szBuf, nPrintCount, format, ...)
+		#define logDebugR(nPerSecond, format, ...)
+		#define logDebugS(nSample, format, ...)
 	#endif
 	#ifndef logInfo
 		#define logInfo(format, ...)
 		#define logInfoC(condition, format, ...)
 		#define logInfoN(szFormat, szBuf, nPrintCount, format, ...)
 		#define logInfoCN(condition, szFormat, szBuf, nPrintCount, format, ...)
+		#define logInfoR(nPerSecond, format, ...)
+		#define logInfoS(nSample, format, ...)
 	#endif
 	#ifndef logNotice
 		#define logNotice(format, ...)
 		#define logNoticeC(condition, format, ...)
 		#define logNoticeN(szFormat, szBuf, nPrintCount, format, ...)
 		#define logNoticeCN(condition, szFormat, szBuf, nPrintCount, format, ...)
+		#define logNoticeR(nPerSecond, format, ...)
+		#define logNoticeS(nSample, format, ...)
 	#endif
 	#ifndef logWarning
 		#define logWarning(format, ...)
 		#define logWarningC(condition, format, ...)
 		#define logWarningN(szFormat, szBuf, nPrintCount, format, ...)
 		#define logWarningCN(condition, szFormat, szBuf, nPrintCount, format, ...)
+		#define logWarningR(nPerSecond, format, ...)
+		#define logWarningS(nSample, format, ...)
 	#endif
 	#ifndef logVerify
 		#define logVerify(format, ...)
@@ -530,12 +979,16 @@
 		#define logErrorC(condition, format, ...)
 		#define logErrorN(szFormat, szBuf, nPrintCount, format, ...)
 		#define logErrorCN(condition, szFormat, szBuf, nPrintCount, format, ...)
+		#define logErrorR(nPerSecond, format, ...)
+		#define logErrorS(nSample, format, ...)
 	#endif	
 	#ifndef logFatal
 		#define logFatal(format, ...)
 		#define logFatalC(condition, format, ...)
 		#define logFatalN(szFormat, szBuf, nPrintCount, format, ...)
 		#define logFatalCN(condition, szFormat, szBuf, nPrintCount, format, ...)
+		#define logFatalR(nPerSecond, format, ...)
+		#define logFatalS(nSample, format, ...)
 	#endif
 #else //not windows
 	#ifndef logText
@@ -543,42 +996,58 @@
 		#define logTextC(condition, format, args...)
 		#define logTextN(szFormat, szBuf, nPrintCount)
 		#define logTextCN(condition, szFormat, szBuf, nPrintCount)
+		#define __wlog_log_text_t(nType, format, args...)
+	#endif
+	#ifndef wlogFlush
+		#define wlogFlush()
 	#endif
 	#ifndef logBase
 		#define logBase(nType, chType, format, args...)
 		#define logBaseC(condition, nType, chType, format, args...)
 		#define logBaseN(nType, chType, szFormat, szBuf, nPrintCount, format, args...)
 		#define logBaseCN(condition, nType, chType, szFormat, szBuf, nPrintCount, format, args...)
+		#define logBaseR(nPerSecond, nType, chType, format, args...)
+		#define logBaseS(nSample, nType, chType, format, args...)
 	#endif
 	#ifndef logTrace
 		#define logTrace(format, args...)
 		#define logTraceC(condition, format, args...)
 		#define logTraceN(szFormat, szBuf, nPrintCount, format, args...)
 		#define logTraceCN(condition, szFormat, szBuf, nPrintCount, format, args...)
+		#define logTraceR(nPerSecond, format, args...)
+		#define logTraceS(nSample, format, args...)
 	#endif
 	#ifndef logDebug
 		#define logDebug(format, args...)
 		#define logDebugC(condition, format, args...)
 		#define logDebugN(szFormat, szBuf, nPrintCount, format, args...)
 		#define logDebugCN(condition, szFormat, szBuf, nPrintCount, format, args...)
+		#define logDebugR(nPerSecond, format, args...)
+		#define logDebugS(nSample, format, args...)
 	#endif
 	#ifndef logInfo
 		#define logInfo(format, args...)
 		#define logInfoC(condition, format, args...)
 		#define logInfoN(szFormat, szBuf, nPrintCount, format, args...)
 		#define logInfoCN(condition, szFormat, szBuf, nPrintCount, format, args...)
+		#define logInfoR(nPerSecond, format, args...)
+		#define logInfoS(nSample, format, args...)
 	#endif
 	#ifndef logNotice
 		#define logNotice(format, args...)
 		#define logNoticeC(condition, format, args...)
 		#define logNoticeN(szFormat, szBuf, nPrintCount, format, args...)
 		#define logNoticeCN(condition, szFormat, szBuf, nPrintCount, format, args...)
+		#define logNoticeR(nPerSecond, format, args...)
+		#define logNoticeS(nSample, format, args...)
 	#endif
 	#ifndef logWarning
 		#define logWarning(format, args...)
 		#define logWarningC(condition, format, args...)
 		#define logWarningN(szFormat, szBuf, nPrintCount, format, args...)
 		#define logWarningCN(condition, szFormat, szBuf, nPrintCount, format, args...)
+		#define logWarningR(nPerSecond, format, args...)
+		#define logWarningS(nSample, format, args...)
 	#endif	
 	#ifndef logVerify
 		#define logVerify(format, args...)
@@ -591,13 +1060,42 @@
 		#define logErrorC(condition, format, args...)
 		#define logErrorN(szFormat, szBuf, nPrintCount, format, args...)
 		#define logErrorCN(condition, szFormat, szBuf, nPrintCount, format, args...)
+		#define logErrorR(nPerSecond, format, args...)
+		#define logErrorS(nSample, format, args...)
 	#endif
 	#ifndef logFatal
 		#define logFatal(format, args...)
 		#define logFatalC(condition, format, args...)
 		#define logFatalN(szFormat, szBuf, nPrintCount, format, args...)
 		#define logFatalCN(condition, szFormat, szBuf, nPrintCount, format, args...)
+		#define logFatalR(nPerSecond, format, args...)
+		#define logFatalS(nSample, format, args...)
 	#endif
 #endif
 
+//JSON行输出与logXXXKV键值对
+#if !defined(_WIN32) && (WLOG_TO != WLOG_TO_KERNEL) && (WLOG_STATIC_TYPE_SWITCH&WLOG_TYPE_TEXT)
+	#include "wlog_json.h"
+#endif
+
+//C++17类型安全的logXXXF系列
+#if defined(__cplusplus) && (__cplusplus >= 201703L) && !defined(_WIN32) && (WLOG_TO != WLOG_TO_KERNEL)
+	#include "wlog_fmt.h"
+#endif
+
+//logSpan计时区间、logCounter计数、logInstant事件，静态开关关掉WLOG_SPAN_TYPE时展开为空
+#ifndef WLOG_SPAN_TYPE
+	#define WLOG_SPAN_TYPE WLOG_TYPE_TRACE
+#endif
+#if WLOG_SPAN && (WLOG_STATIC_TYPE_SWITCH&WLOG_SPAN_TYPE)
+	#include "wlog_span.h"
+#else
+	#define logSpan(szName)
+	#define logSpanBegin(szName)
+	#define logSpanEnd(szName)
+	#define logCounter(szName, fValue)
+	#define logInstant(szName)
+	#define wlogSpanFlush()
+#endif
+
 #endif //__WLOG_H__
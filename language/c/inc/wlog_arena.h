@@ -0,0 +1,171 @@
+#ifndef __WLOG_ARENA_H__
+#define __WLOG_ARENA_H__
+/**
+ * @file wlog_arena.h
+ * @brief 每个线程的缓冲池：放不进栈上缓冲的长日志从这里取缓冲，稳定运行后写日志不再malloc/free，由wlog.h在linux用户态自动包含，不要单独include.
+ * <pre>以前各输出的格式化函数先vsnprintf到WLOG_MAX_BUFFER_SIZE的栈上缓冲，放不下时malloc一块再格式化一遍，用完free；
+        logXXXN与JSON的编码缓冲、logXXXF的缓冲、WLOG_BINARY的长记录、暂存缓冲放不下的日志也一样，长日志每条一次malloc/free。
+        现在这些地方都从本线程的缓冲池取：缓冲按2的幂分成大小类，从2^WLOG_ARENA_MIN_BITS到2^WLOG_ARENA_MAX_BITS字节，
+        每个线程每个大小类最多缓存WLOG_ARENA_CACHE块，用完还回来留给下一条日志，线程退出时释放。
+        另外每个线程记下最近的长日志需要多大的缓冲，之后的日志直接格式化到这么大的缓冲里，只格式化一遍，
+        只有本线程第一次遇到更长的日志时才格式化两遍。超过2^WLOG_ARENA_MAX_BITS的日志仍然临时malloc，不缓存。
+        取到的缓冲都是malloc分配的，也可以直接free。
+        可在include <wlog.h>之前修改的“宏”配置：
+		1. WLOG_ARENA_MIN_BITS，最小的大小类为2^WLOG_ARENA_MIN_BITS字节，默认10(1K)
+		2. WLOG_ARENA_MAX_BITS，最大的大小类为2^WLOG_ARENA_MAX_BITS字节，默认20(1M)
+		3. WLOG_ARENA_CACHE，每个线程每个大小类最多缓存的块数，默认2
+	</pre>
+ * @os linux
+ */
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifndef WLOG_ARENA_MIN_BITS
+	#define WLOG_ARENA_MIN_BITS 10
+#endif
+#ifndef WLOG_ARENA_MAX_BITS
+	#define WLOG_ARENA_MAX_BITS 20
+#endif
+#ifndef WLOG_ARENA_CACHE
+	#define WLOG_ARENA_CACHE 2
+#endif
+
+#if (WLOG_ARENA_MIN_BITS < 4) || (WLOG_ARENA_MAX_BITS < WLOG_ARENA_MIN_BITS) || (WLOG_ARENA_MAX_BITS > 30) || (WLOG_ARENA_CACHE < 1)
+	#error "WLOG_ARENA_MIN_BITS, WLOG_ARENA_MAX_BITS or WLOG_ARENA_CACHE is invalid!"
+#endif
+
+#define __WLOG_ARENA_CLASSES (WLOG_ARENA_MAX_BITS - WLOG_ARENA_MIN_BITS + 1)
+#define __WLOG_ARENA_MAX_SIZE ((size_t)1 << WLOG_ARENA_MAX_BITS)
+
+//每个线程一个，只有本线程访问；nHint为本线程最近的长日志需要的缓冲大小
+typedef struct __wlog_arena_t {
+	char* pBlocks[__WLOG_ARENA_CLASSES][WLOG_ARENA_CACHE];
+	unsigned int nBlocks[__WLOG_ARENA_CLASSES];
+	size_t nHint;
+	int bRegistered;
+} __wlog_arena_t;
+
+inline __wlog_arena_t* __wlog_arena_tls() {
+	static __thread __wlog_arena_t g_wlogArena;
+	return &g_wlogArena;
+}
+
+//线程退出时释放缓存的缓冲
+inline void __wlog_arena_release_imp(void* pData) {
+	__wlog_arena_t* pArena = (__wlog_arena_t*)pData;
+	unsigned int nClass = 0;
+	for (; nClass < __WLOG_ARENA_CLASSES; ++nClass) {
+		while (pArena->nBlocks[nClass] > 0) {
+			free(pArena->pBlocks[nClass][--pArena->nBlocks[nClass]]);
+		}
+	}
+	pArena->nHint = 0;
+	pArena->bRegistered = 0;
+}
+
+inline pthread_key_t* __wlog_arena_key() {
+	static pthread_key_t g_wlogArenaKey;
+	return &g_wlogArenaKey;
+}
+
+inline void __wlog_arena_init_imp() {
+	pthread_key_create(__wlog_arena_key(), __wlog_arena_release_imp);
+}
+
+//本线程第一次缓存缓冲时登记，线程退出时才能释放
+inline void __wlog_arena_register_imp(__wlog_arena_t* pArena) {
+	static pthread_once_t g_wlogArenaOnce = PTHREAD_ONCE_INIT;
+	pthread_once(&g_wlogArenaOnce, __wlog_arena_init_imp);
+	pthread_setspecific(*__wlog_arena_key(), pArena);
+	pArena->bRegistered = 1;
+}
+
+//能放下nSize字节的最小大小类
+inline unsigned int __wlog_arena_class(size_t nSize) {
+	if (nSize <= ((size_t)1 << WLOG_ARENA_MIN_BITS)) return 0;
+	return (unsigned int)(64 - __builtin_clzll((unsigned long long)nSize - 1)) - WLOG_ARENA_MIN_BITS;
+}
+
+//取至少nSize字节的缓冲，*pCap为实际大小，失败返回NULL；用完调用__wlog_arena_free还回来
+inline char* __wlog_arena_alloc(size_t nSize, size_t* pCap) {
+	if (nSize > __WLOG_ARENA_MAX_SIZE) {
+		*pCap = nSize;
+		return (char*)malloc(nSize);
+	}
+	unsigned int nClass = __wlog_arena_class(nSize);
+	__wlog_arena_t* pArena = __wlog_arena_tls();
+	*pCap = (size_t)1 << (nClass + WLOG_ARENA_MIN_BITS);
+	if (pArena->nBlocks[nClass] > 0) {
+		return pArena->pBlocks[nClass][--pArena->nBlocks[nClass]];
+	}
+	return (char*)malloc(*pCap);
+}
+
+//nCap是__wlog_arena_alloc给出的实际大小，本线程这个大小类缓存已满或不是缓冲池的大小时直接free
+inline void __wlog_arena_free(char* pData, size_t nCap) {
+	if (NULL == pData) return;
+	if (nCap > __WLOG_ARENA_MAX_SIZE || nCap < ((size_t)1 << WLOG_ARENA_MIN_BITS) || 0 != (nCap & (nCap - 1))) {
+		free(pData);
+		return;
+	}
+	unsigned int nClass = __wlog_arena_class(nCap);
+	__wlog_arena_t* pArena = __wlog_arena_tls();
+	if (pArena->nBlocks[nClass] >= WLOG_ARENA_CACHE) {
+		free(pData);
+		return;
+	}
+	if (!pArena->bRegistered) __wlog_arena_register_imp(pArena);
+	pArena->pBlocks[nClass][pArena->nBlocks[nClass]++] = pData;
+}
+
+//格式化的结果，pData是调用者栈上的缓冲或缓冲池的缓冲，用完调用__wlog_arena_text_free
+typedef struct __wlog_arena_text_t {
+	char* pData;
+	size_t nCap;
+	int bPooled;
+} __wlog_arena_text_t;
+
+inline void __wlog_arena_text_free(__wlog_arena_text_t* pText) {
+	if (pText->bPooled) __wlog_arena_free(pText->pData, pText->nCap);
+	pText->bPooled = 0;
+}
+
+//格式化format，返回长度，小于0表示失败。本线程最近的日志都放得进szStack时格式化到szStack，
+//否则直接格式化到nHint大小的缓冲；放不下时换一块够大的缓冲再格式化一遍，并记下大小
+inline int __wlog_arena_vformat(__wlog_arena_text_t* pText, char* szStack, size_t nStack, const char* format, va_list arglist) {
+	__wlog_arena_t* pArena = __wlog_arena_tls();
+	pText->pData = szStack;
+	pText->nCap = nStack;
+	pText->bPooled = 0;
+	if (pArena->nHint > nStack) {
+		size_t nCap = 0;
+		char* pData = __wlog_arena_alloc(pArena->nHint, &nCap);
+		if (NULL != pData) {
+			pText->pData = pData;
+			pText->nCap = nCap;
+			pText->bPooled = 1;
+		}
+	}
+	va_list argCopy;
+	va_copy(argCopy, arglist);
+	int nLen = vsnprintf(pText->pData, pText->nCap, format, argCopy);
+	va_end(argCopy);
+	if (nLen < 0 || (size_t)nLen < pText->nCap) return nLen;
+	__wlog_arena_text_free(pText);
+	size_t nCap = 0;
+	char* pData = __wlog_arena_alloc((size_t)nLen + 1, &nCap);
+	if (NULL == pData) {
+		pText->pData = szStack;
+		return -1;
+	}
+	pText->pData = pData;
+	pText->nCap = nCap;
+	pText->bPooled = 1;
+	vsnprintf(pData, nCap, format, arglist);
+	if (nCap <= __WLOG_ARENA_MAX_SIZE && nCap > pArena->nHint) pArena->nHint = nCap;
+	return nLen;
+}
+
+#endif //__WLOG_ARENA_H__
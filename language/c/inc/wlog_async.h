@@ -0,0 +1,385 @@
+#ifndef __WLOG_ASYNC_H__
+#define __WLOG_ASYNC_H__
+/**
+ * @file wlog_async.h
+ * @brief WLOG_ASYNC模式下的异步文件输出，由wlog.h在WLOG_TO_FILE时自动包含，不要单独include.
+ * <pre>调用线程只把日志格式化到预分配的无锁多生产者环形队列里，由一个后台写线程
+        批量取出，合并成一次fwrite写入文件，调用线程不再等待磁盘I/O，何时fflush见wlog_file.h。
+        logFatal、logVerify、logAssert会在返回(或abort)之前等待队列写空。
+        可在include <wlog.h>之前修改的“宏”配置：
+		1. WLOG_ASYNC_SLOT_COUNT，队列槽位数，必须是2的幂，默认4096
+		2. WLOG_ASYNC_RECORD_SIZE，每个槽位的大小，更长的日志占用连续多个槽位(最多WLOG_ASYNC_SLOT_COUNT / 2个，超出部分截断)，默认WLOG_MAX_BUFFER_SIZE
+		3. WLOG_ASYNC_OVERFLOW，队列满时的策略，默认WLOG_ASYNC_BLOCK
+			WLOG_ASYNC_BLOCK       等待写线程腾出槽位
+			WLOG_ASYNC_DROP        直接丢弃当前这条日志
+			WLOG_ASYNC_DROP_COUNT  丢弃并计数，写线程会补写一行丢弃条数，也可用wlogAsyncDropped()读取累计值
+		4. WLOG_ASYNC_BATCH_SIZE，写线程单次合并写入的最大字节数，默认64K
+		5. WLOG_ASYNC_DRAIN_TIMEOUT_MS，logFatal等待队列写空的最长时间，默认1000毫秒
+		6. WLOG_ASYNC_IO，写线程写文件的方式，默认WLOG_ASYNC_IO_STDIO
+			WLOG_ASYNC_IO_STDIO    把槽位里的日志复制到一块缓冲，一次fwrite
+			WLOG_ASYNC_IO_WRITEV   不复制，每个槽位一个iovec，一次writev写出整批，写完才释放槽位，详见wlog_writev.h
+			WLOG_ASYNC_IO_URING    同上，但通过io_uring提交，写线程不等写完就去收集下一批，内核不支持时自动改用writev
+	</pre>
+ * @os linux
+ */
+#ifdef _WIN32
+	#error "haven't implement!"
+#endif
+#if (WLOG_TO != WLOG_TO_FILE)
+	#error "WLOG_ASYNC only support WLOG_TO_FILE!"
+#endif
+
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+#include <stdlib.h>
+#include <errno.h>
+
+//队列满时的策略
+#define WLOG_ASYNC_BLOCK		1
+#define WLOG_ASYNC_DROP			2
+#define WLOG_ASYNC_DROP_COUNT	3
+
+//写线程写文件的方式
+#define WLOG_ASYNC_IO_STDIO		1
+#define WLOG_ASYNC_IO_WRITEV	2
+#define WLOG_ASYNC_IO_URING		3
+
+#ifndef WLOG_ASYNC_SLOT_COUNT
+	#define WLOG_ASYNC_SLOT_COUNT 4096
+#endif
+#if (WLOG_ASYNC_SLOT_COUNT & (WLOG_ASYNC_SLOT_COUNT - 1))
+	#error "WLOG_ASYNC_SLOT_COUNT must be power of 2!"
+#endif
+#ifndef WLOG_ASYNC_RECORD_SIZE
+	#define WLOG_ASYNC_RECORD_SIZE WLOG_MAX_BUFFER_SIZE
+#endif
+#ifndef WLOG_ASYNC_OVERFLOW
+	#define WLOG_ASYNC_OVERFLOW WLOG_ASYNC_BLOCK
+#endif
+#ifndef WLOG_ASYNC_BATCH_SIZE
+	#define WLOG_ASYNC_BATCH_SIZE (64 * 1024)
+#endif
+#if (WLOG_ASYNC_BATCH_SIZE < WLOG_ASYNC_RECORD_SIZE)
+	#error "WLOG_ASYNC_BATCH_SIZE must not be less than WLOG_ASYNC_RECORD_SIZE!"
+#endif
+#ifndef WLOG_ASYNC_DRAIN_TIMEOUT_MS
+	#define WLOG_ASYNC_DRAIN_TIMEOUT_MS 1000
+#endif
+#ifndef WLOG_ASYNC_IO
+	#define WLOG_ASYNC_IO WLOG_ASYNC_IO_STDIO
+#endif
+
+typedef struct __wlog_async_slot_t {
+	unsigned long nSeq;		//等于位置号时可写，等于位置号+1时可读
+	unsigned int nType;
+	unsigned int nLen;
+	char szData[WLOG_ASYNC_RECORD_SIZE];
+} __wlog_async_slot_t;
+
+typedef struct __wlog_async_ctx_t {
+	unsigned long nEnqueuePos __attribute__((aligned(64)));
+	unsigned long nDequeuePos __attribute__((aligned(64)));
+	unsigned long nFlushedPos;
+	unsigned long nDropped;
+	unsigned long nDroppedTotal;
+	unsigned long nWrites;
+	int bStarted;
+	int bSleeping;
+	int bStop;
+	pthread_t hThread;
+	pthread_mutex_t hMutex;
+	pthread_cond_t hCond;
+	char szBatch[WLOG_ASYNC_BATCH_SIZE];
+	__wlog_async_slot_t slots[WLOG_ASYNC_SLOT_COUNT] __attribute__((aligned(64)));
+} __wlog_async_ctx_t;
+
+inline __wlog_async_ctx_t* __wlog_async_ctx() {
+	static __wlog_async_ctx_t g_wlogAsyncCtx;
+	return &g_wlogAsyncCtx;
+}
+
+//只在写线程里调用，一次写入一整批日志，是否刷新由wlog_file.h的刷新策略决定
+inline void __wlog_file_write_buffer_imp(unsigned int nType, unsigned long nRecords, const char* pBuffer, size_t nLen) {
+	#if WLOG_STATS
+		unsigned long long nStatsStart = __wlog_stats_now_ns();
+	#endif
+	FILE* hFile = __wlog_file_acquire_imp(1);
+	if (NULL == hFile) {
+		#if WLOG_STATS
+			__wlog_stats_write_imp(nStatsStart, -1);
+		#endif
+		return;
+	}
+	long nWritten = -1;
+	__wlog_file_lock(hFile);
+	__atomic_fetch_add(&__wlog_async_ctx()->nWrites, 1, __ATOMIC_RELAXED);
+	if (fwrite(pBuffer, 1, nLen, hFile) == nLen) {
+		nWritten = (long)nLen;
+		__wlog_flush_policy_imp(hFile, nType, nRecords, nLen);
+		#if WLOG_INDEX
+			__wlog_index_append_imp(pBuffer, nLen);
+		#endif
+	}
+	#if WLOG_INDEX
+		else {
+			__wlog_index_stop_imp();
+		}
+	#endif
+	__wlog_file_unlock(hFile);
+	__wlog_file_release_imp(hFile, nWritten);
+	#if WLOG_STATS
+		__wlog_stats_write_imp(nStatsStart, nWritten);
+	#endif
+}
+
+inline void __wlog_async_wakeup_imp(__wlog_async_ctx_t* pCtx) {
+	pthread_mutex_lock(&pCtx->hMutex);
+	pthread_cond_signal(&pCtx->hCond);
+	pthread_mutex_unlock(&pCtx->hMutex);
+}
+
+#if (WLOG_ASYNC_OVERFLOW == WLOG_ASYNC_DROP_COUNT)
+	//取走丢弃的条数，生成一行说明写进pOut(至少64字节)，返回长度，没有丢弃时返回0
+	inline size_t __wlog_async_dropped_imp(__wlog_async_ctx_t* pCtx, char* pOut) {
+		unsigned long nDropped = __atomic_exchange_n(&pCtx->nDropped, 0, __ATOMIC_RELAXED);
+		if (0 == nDropped) return 0;
+		#if WLOG_BINARY
+			//二进制模式下包成'T'记录
+			uint32_t nRecordSize = WLOG_BIN_HEAD_SIZE + (uint32_t)snprintf(pOut + WLOG_BIN_HEAD_SIZE, 64 - WLOG_BIN_HEAD_SIZE, _T("WLOG ASYNC DROPPED %lu RECORDS\n"), nDropped);
+			__wlog_bin_put_head(pOut, nRecordSize, WLOG_BIN_TEXT);
+			return nRecordSize;
+		#else
+			return (size_t)snprintf(pOut, 64, _T("WLOG ASYNC DROPPED %lu RECORDS\n"), nDropped);
+		#endif
+	}
+#endif
+
+//队列空，先声明要睡眠再复查一次，避免和生产者的唤醒错过；最多睡100毫秒
+inline void __wlog_async_wait_imp(__wlog_async_ctx_t* pCtx, unsigned long nPos) {
+	#if (WLOG_FLUSH_INTERVAL_MS > 0)
+		if (__wlog_flush_now_ms() - __wlog_flush_state()->nLastFlushMs >= WLOG_FLUSH_INTERVAL_MS) {
+			__wlog_file_flush_imp();
+		}
+	#endif
+	pthread_mutex_lock(&pCtx->hMutex);
+	__atomic_store_n(&pCtx->bSleeping, 1, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+	if (__atomic_load_n(&pCtx->slots[nPos & (WLOG_ASYNC_SLOT_COUNT - 1)].nSeq, __ATOMIC_ACQUIRE) != nPos + 1
+		&& !__atomic_load_n(&pCtx->bStop, __ATOMIC_ACQUIRE)) {
+		struct timespec tsWait;
+		clock_gettime(CLOCK_REALTIME, &tsWait);
+		tsWait.tv_nsec += 100 * 1000 * 1000;
+		if (tsWait.tv_nsec >= 1000 * 1000 * 1000) {
+			tsWait.tv_sec += 1;
+			tsWait.tv_nsec -= 1000 * 1000 * 1000;
+		}
+		pthread_cond_timedwait(&pCtx->hCond, &pCtx->hMutex, &tsWait);
+	}
+	__atomic_store_n(&pCtx->bSleeping, 0, __ATOMIC_RELAXED);
+	pthread_mutex_unlock(&pCtx->hMutex);
+}
+
+#if (WLOG_ASYNC_IO == WLOG_ASYNC_IO_STDIO)
+inline void* __wlog_async_writer_imp(void* pArg) {
+	__wlog_async_ctx_t* pCtx = __wlog_async_ctx();
+	(void)pArg;
+	unsigned long nPos = pCtx->nDequeuePos;
+	for (;;) {
+		size_t nBatch = 0;
+		unsigned long nRecords = 0;
+		unsigned int nTypes = 0;
+		for (;;) {
+			__wlog_async_slot_t* pSlot = &pCtx->slots[nPos & (WLOG_ASYNC_SLOT_COUNT - 1)];
+			if (__atomic_load_n(&pSlot->nSeq, __ATOMIC_ACQUIRE) != nPos + 1) break;
+			if (nBatch + pSlot->nLen > WLOG_ASYNC_BATCH_SIZE) break;
+			memcpy(pCtx->szBatch + nBatch, pSlot->szData, pSlot->nLen);
+			nBatch += pSlot->nLen;
+			nTypes |= pSlot->nType;
+			++nRecords;
+			__atomic_store_n(&pSlot->nSeq, nPos + WLOG_ASYNC_SLOT_COUNT, __ATOMIC_RELEASE);
+			++nPos;
+		}
+		__atomic_store_n(&pCtx->nDequeuePos, nPos, __ATOMIC_RELEASE);
+		#if (WLOG_ASYNC_OVERFLOW == WLOG_ASYNC_DROP_COUNT)
+			if (nBatch + 64 <= WLOG_ASYNC_BATCH_SIZE) {
+				nBatch += __wlog_async_dropped_imp(pCtx, pCtx->szBatch + nBatch);
+			}
+		#endif
+		if (nBatch > 0) {
+			__wlog_file_write_buffer_imp(nTypes, nRecords, pCtx->szBatch, nBatch);
+			__atomic_store_n(&pCtx->nFlushedPos, nPos, __ATOMIC_RELEASE);
+			continue;
+		}
+		__atomic_store_n(&pCtx->nFlushedPos, nPos, __ATOMIC_RELEASE);
+		if (__atomic_load_n(&pCtx->bStop, __ATOMIC_ACQUIRE)) break;
+		__wlog_async_wait_imp(pCtx, nPos);
+	}
+	return NULL;
+}
+#else
+	#include "wlog_writev.h"
+#endif
+
+inline void __wlog_async_exit_imp() {
+	__wlog_async_ctx_t* pCtx = __wlog_async_ctx();
+	__atomic_store_n(&pCtx->bStop, 1, __ATOMIC_RELEASE);
+	__wlog_async_wakeup_imp(pCtx);
+	pthread_join(pCtx->hThread, NULL);
+}
+
+inline void __wlog_async_init_imp() {
+	__wlog_async_ctx_t* pCtx = __wlog_async_ctx();
+	unsigned long nIdx = 0;
+	for (; nIdx < WLOG_ASYNC_SLOT_COUNT; ++nIdx) {
+		pCtx->slots[nIdx].nSeq = nIdx;
+	}
+	pthread_mutex_init(&pCtx->hMutex, NULL);
+	pthread_cond_init(&pCtx->hCond, NULL);
+	if (0 != pthread_create(&pCtx->hThread, NULL, __wlog_async_writer_imp, NULL)) {
+		__atomic_store_n(&pCtx->bStop, 1, __ATOMIC_RELEASE);
+		return;
+	}
+	__atomic_store_n(&pCtx->bStarted, 1, __ATOMIC_RELEASE);
+	#if WLOG_INDEX
+		//写线程退出后再写最后一块索引
+		atexit(__wlog_index_flush_imp);
+	#endif
+	atexit(__wlog_async_exit_imp);
+}
+
+inline void __wlog_async_start() {
+	static pthread_once_t g_wlogAsyncOnce = PTHREAD_ONCE_INIT;
+	pthread_once(&g_wlogAsyncOnce, __wlog_async_init_imp);
+}
+
+//连续占用nSlots个槽位，返回第一个槽位；返回NULL表示这条日志按WLOG_ASYNC_OVERFLOW策略被丢弃。
+//写线程按顺序释放槽位，所以只要最后一个槽位空闲，前面的也一定空闲
+inline __wlog_async_slot_t* __wlog_async_reserve_imp(__wlog_async_ctx_t* pCtx, unsigned long nSlots, unsigned long* pPos) {
+	unsigned long nPos = __atomic_load_n(&pCtx->nEnqueuePos, __ATOMIC_RELAXED);
+	for (;;) {
+		unsigned long nLast = nPos + nSlots - 1;
+		__wlog_async_slot_t* pSlot = &pCtx->slots[nLast & (WLOG_ASYNC_SLOT_COUNT - 1)];
+		long nDiff = (long)(__atomic_load_n(&pSlot->nSeq, __ATOMIC_ACQUIRE) - nLast);
+		if (nDiff == 0) {
+			if (__atomic_compare_exchange_n(&pCtx->nEnqueuePos, &nPos, nPos + nSlots, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+				*pPos = nPos;
+				return &pCtx->slots[nPos & (WLOG_ASYNC_SLOT_COUNT - 1)];
+			}
+		} else if (nDiff < 0) {
+			if (__atomic_load_n(&pCtx->bStop, __ATOMIC_ACQUIRE)) return NULL;
+			#if (WLOG_ASYNC_OVERFLOW == WLOG_ASYNC_BLOCK)
+				__wlog_async_wakeup_imp(pCtx);
+				sched_yield();
+			#else
+				#if (WLOG_ASYNC_OVERFLOW == WLOG_ASYNC_DROP_COUNT)
+					__atomic_fetch_add(&pCtx->nDropped, 1, __ATOMIC_RELAXED);
+					__atomic_fetch_add(&pCtx->nDroppedTotal, 1, __ATOMIC_RELAXED);
+				#endif
+				#if WLOG_STATS
+					__wlog_stats_drop_imp();
+				#endif
+				return NULL;
+			#endif
+			nPos = __atomic_load_n(&pCtx->nEnqueuePos, __ATOMIC_RELAXED);
+		} else {
+			nPos = __atomic_load_n(&pCtx->nEnqueuePos, __ATOMIC_RELAXED);
+		}
+	}
+}
+
+inline void __wlog_async_notify_imp(__wlog_async_ctx_t* pCtx) {
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+	if (__atomic_load_n(&pCtx->bSleeping, __ATOMIC_RELAXED)) {
+		__wlog_async_wakeup_imp(pCtx);
+	}
+}
+
+//已经格式化好的整条日志，超过WLOG_ASYNC_RECORD_SIZE时占用连续多个槽位，写线程按顺序拼接，不会被其他日志打断
+inline void __wlog_sink_write_imp(unsigned int nType, const char* pRecord, size_t nLen) {
+	__wlog_async_ctx_t* pCtx = __wlog_async_ctx();
+	unsigned long nSlots = (unsigned long)((nLen + WLOG_ASYNC_RECORD_SIZE - 1) / WLOG_ASYNC_RECORD_SIZE);
+	if (0 == nSlots) return;
+	if (nSlots > WLOG_ASYNC_SLOT_COUNT / 2) {
+		nSlots = WLOG_ASYNC_SLOT_COUNT / 2;
+		nLen = nSlots * WLOG_ASYNC_RECORD_SIZE;
+	}
+	__wlog_async_start();
+	unsigned long nPos = 0;
+	__wlog_async_slot_t* pSlot = __wlog_async_reserve_imp(pCtx, nSlots, &nPos);
+	if (NULL == pSlot) return;
+	unsigned long nIdx = 0;
+	for (; nIdx < nSlots; ++nIdx) {
+		size_t nPart = (nLen > WLOG_ASYNC_RECORD_SIZE) ? WLOG_ASYNC_RECORD_SIZE : nLen;
+		pSlot = &pCtx->slots[(nPos + nIdx) & (WLOG_ASYNC_SLOT_COUNT - 1)];
+		memcpy(pSlot->szData, pRecord, nPart);
+		pSlot->nType = nType;
+		pSlot->nLen = (unsigned int)nPart;
+		__atomic_store_n(&pSlot->nSeq, nPos + nIdx + 1, __ATOMIC_RELEASE);
+		pRecord += nPart;
+		nLen -= nPart;
+	}
+	__wlog_async_notify_imp(pCtx);
+}
+
+//直接格式化到一个槽位；放不下时这个槽位留空，整条日志从缓冲池格式化后按__wlog_sink_write_imp占用连续多个槽位
+inline void __wlog_file_write_valist_imp(unsigned int nType, const char* format, va_list arglist) {
+	__wlog_async_ctx_t* pCtx = __wlog_async_ctx();
+	__wlog_async_start();
+	unsigned long nPos = 0;
+	__wlog_async_slot_t* pSlot = __wlog_async_reserve_imp(pCtx, 1, &nPos);
+	if (NULL == pSlot) return;
+	va_list argCopy;
+	va_copy(argCopy, arglist);
+	int nLen = vsnprintf(pSlot->szData, WLOG_ASYNC_RECORD_SIZE, format, argCopy);
+	va_end(argCopy);
+	int bLarge = (nLen >= WLOG_ASYNC_RECORD_SIZE);
+	pSlot->nType = nType;
+	pSlot->nLen = (nLen > 0 && !bLarge) ? (unsigned int)nLen : 0;
+	__atomic_store_n(&pSlot->nSeq, nPos + 1, __ATOMIC_RELEASE);
+	if (!bLarge) {
+		__wlog_async_notify_imp(pCtx);
+		return;
+	}
+	char szStack[WLOG_MAX_BUFFER_SIZE];
+	__wlog_arena_text_t text;
+	nLen = __wlog_arena_vformat(&text, szStack, sizeof(szStack), format, arglist);
+	if (nLen > 0) __wlog_sink_write_imp(nType, text.pData, (size_t)nLen);
+	__wlog_arena_text_free(&text);
+}
+
+//等待当前已进入队列的日志全部写入文件，最多等待WLOG_ASYNC_DRAIN_TIMEOUT_MS毫秒
+inline void __wlog_async_drain() {
+	__wlog_async_ctx_t* pCtx = __wlog_async_ctx();
+	if (!__atomic_load_n(&pCtx->bStarted, __ATOMIC_ACQUIRE)) return;
+	unsigned long nTarget = __atomic_load_n(&pCtx->nEnqueuePos, __ATOMIC_ACQUIRE);
+	unsigned int nWaitMs = 0;
+	while ((long)(__atomic_load_n(&pCtx->nFlushedPos, __ATOMIC_ACQUIRE) - nTarget) < 0 && nWaitMs < WLOG_ASYNC_DRAIN_TIMEOUT_MS) {
+		if (__atomic_load_n(&pCtx->bStop, __ATOMIC_ACQUIRE)) return;
+		__wlog_async_wakeup_imp(pCtx);
+		usleep(1000);
+		++nWaitMs;
+	}
+}
+
+//先等待队列写空，再刷新文件
+inline void __wlog_async_flush() {
+	__wlog_async_drain();
+	__wlog_file_flush_imp();
+}
+
+//写线程写文件的次数，WLOG_ASYNC_IO_WRITEV、WLOG_ASYNC_IO_URING下即系统调用或提交的次数
+inline unsigned long wlogAsyncWrites() {
+	return __atomic_load_n(&__wlog_async_ctx()->nWrites, __ATOMIC_RELAXED);
+}
+
+//WLOG_ASYNC_DROP_COUNT策略下累计丢弃的日志条数
+inline unsigned long wlogAsyncDropped() {
+	return __atomic_load_n(&__wlog_async_ctx()->nDroppedTotal, __ATOMIC_RELAXED);
+}
+
+#define wlogFlush() __wlog_async_flush()
+#undef WLOG_ASYNC_DRAIN_CHECK
+#define WLOG_ASYNC_DRAIN_CHECK(nType) if ((nType) & (WLOG_TYPE_VERIFY | WLOG_TYPE_ASSERT | WLOG_TYPE_FATAL)) __wlog_async_drain()
+
+#endif //__WLOG_ASYNC_H__
@@ -0,0 +1,256 @@
+#ifndef __WLOG_BIN_ARG_H__
+#define __WLOG_BIN_ARG_H__
+/**
+ * @file wlog_bin_arg.h
+ * @brief logBase参数的原始字节编码与还原，wlog_binary.h与wlog_flight.h共用；tools/wlog_decode单独include它还原参数.
+ * <pre>参数为 u8 类型 + 值：'i' i32，'I' i64，'u' u32，'U' u64，'d' double，'p' u64，'s' u32 长度 + 字节
+        __wlog_bin_put_args按参数的静态类型编码，不解析格式串；__wlog_bin_format按格式串把编码后的参数还原成文本，
+        飞行记录器写出与tools/wlog_decode解码都用它：长度修饰按记录里实际的参数类型重写，h、hh仍截断成short、char。
+        可在include <wlog.h>之前修改的“宏”配置：
+		1. WLOG_BIN_STRING_MAX，字符串参数最多记录的字节数，默认4096
+	</pre>
+ * @os linux
+ */
+#ifndef __cplusplus
+	#error "wlog_bin_arg.h need c++!"
+#endif
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifndef WLOG_BIN_STRING_MAX
+	#define WLOG_BIN_STRING_MAX 4096
+#endif
+
+inline char* __wlog_bin_put(char* pOut, const void* pData, size_t nLen) {
+	memcpy(pOut, pData, nLen);
+	return pOut + nLen;
+}
+
+//参数编码，每种类型对应一个类型字节与存储类型，不支持的类型编译时报错
+template <typename T> struct __wlog_bin_arg_t;
+#define __WLOG_BIN_ARG(T, chTag, Store) template <> struct __wlog_bin_arg_t<T> { enum { nTag = chTag }; typedef Store store_t; }
+__WLOG_BIN_ARG(bool, 'i', int32_t);
+__WLOG_BIN_ARG(char, 'i', int32_t);
+__WLOG_BIN_ARG(signed char, 'i', int32_t);
+__WLOG_BIN_ARG(short, 'i', int32_t);
+__WLOG_BIN_ARG(int, 'i', int32_t);
+__WLOG_BIN_ARG(unsigned char, 'u', uint32_t);
+__WLOG_BIN_ARG(unsigned short, 'u', uint32_t);
+__WLOG_BIN_ARG(unsigned int, 'u', uint32_t);
+__WLOG_BIN_ARG(long, 'I', int64_t);
+__WLOG_BIN_ARG(long long, 'I', int64_t);
+__WLOG_BIN_ARG(unsigned long, 'U', uint64_t);
+__WLOG_BIN_ARG(unsigned long long, 'U', uint64_t);
+__WLOG_BIN_ARG(float, 'd', double);
+__WLOG_BIN_ARG(double, 'd', double);
+template <typename T> struct __wlog_bin_arg_t<T*> { enum { nTag = 'p' }; typedef uint64_t store_t; };
+#undef __WLOG_BIN_ARG
+
+inline size_t __wlog_bin_strlen(const char* szValue) {
+	return (NULL == szValue) ? 6 : strnlen(szValue, WLOG_BIN_STRING_MAX);
+}
+inline size_t __wlog_bin_arg_size(const char* szValue) {
+	return 1 + 4 + __wlog_bin_strlen(szValue);
+}
+inline size_t __wlog_bin_arg_size(char* szValue) {
+	return __wlog_bin_arg_size((const char*)szValue);
+}
+template <typename T> inline size_t __wlog_bin_arg_size(T) {
+	return 1 + sizeof(typename __wlog_bin_arg_t<T>::store_t);
+}
+
+inline char* __wlog_bin_put_arg(char* pOut, const char* szValue) {
+	uint32_t nLen = (uint32_t)__wlog_bin_strlen(szValue);
+	*pOut++ = 's';
+	pOut = __wlog_bin_put(pOut, &nLen, 4);
+	return __wlog_bin_put(pOut, (NULL == szValue) ? "(null)" : szValue, nLen);
+}
+inline char* __wlog_bin_put_arg(char* pOut, char* szValue) {
+	return __wlog_bin_put_arg(pOut, (const char*)szValue);
+}
+template <typename T> inline typename __wlog_bin_arg_t<T>::store_t __wlog_bin_store(T value) {
+	return (typename __wlog_bin_arg_t<T>::store_t)value;
+}
+template <typename T> inline uint64_t __wlog_bin_store(T* value) {
+	return (uint64_t)(uintptr_t)value;
+}
+template <typename T> inline char* __wlog_bin_put_arg(char* pOut, T value) {
+	typename __wlog_bin_arg_t<T>::store_t store = __wlog_bin_store(value);
+	*pOut++ = (char)__wlog_bin_arg_t<T>::nTag;
+	return __wlog_bin_put(pOut, &store, sizeof(store));
+}
+
+inline size_t __wlog_bin_args_size() {
+	return 0;
+}
+template <typename T, typename... Args> inline size_t __wlog_bin_args_size(T value, Args... args) {
+	return __wlog_bin_arg_size(value) + __wlog_bin_args_size(args...);
+}
+inline char* __wlog_bin_put_args(char* pOut) {
+	return pOut;
+}
+template <typename T, typename... Args> inline char* __wlog_bin_put_args(char* pOut, T value, Args... args) {
+	return __wlog_bin_put_args(__wlog_bin_put_arg(pOut, value), args...);
+}
+
+//按格式串还原时逐个取出的参数
+typedef struct __wlog_bin_value_t {
+	char chTag;
+	long long nValue;
+	unsigned long long nUValue;
+	double fValue;
+	const char* pString;
+	uint32_t nString;
+} __wlog_bin_value_t;
+
+//从pArgs取下一个参数，没有或不完整时返回0并给出值为0的整数
+inline int __wlog_bin_next(const char** ppArgs, const char* pEnd, __wlog_bin_value_t* pValue) {
+	memset(pValue, 0, sizeof(*pValue));
+	pValue->chTag = 'i';
+	const char* pIn = *ppArgs;
+	if (pIn >= pEnd) return 0;
+	char chTag = *pIn++;
+	size_t nSize = ('i' == chTag || 'u' == chTag || 's' == chTag) ? 4 : 8;
+	if ((size_t)(pEnd - pIn) < nSize) return 0;
+	int32_t n32 = 0;
+	int64_t n64 = 0;
+	switch (chTag) {
+	case 'i':	memcpy(&n32, pIn, 4); pValue->nValue = n32; pValue->nUValue = (uint32_t)n32; break;
+	case 'u':	memcpy(&n32, pIn, 4); pValue->nUValue = (uint32_t)n32; pValue->nValue = (long long)pValue->nUValue; break;
+	case 'I':	memcpy(&n64, pIn, 8); pValue->nValue = n64; pValue->nUValue = (uint64_t)n64; break;
+	case 'U':
+	case 'p':	memcpy(&n64, pIn, 8); pValue->nUValue = (uint64_t)n64; pValue->nValue = n64; break;
+	case 'd':	memcpy(&pValue->fValue, pIn, 8); break;
+	case 's':
+		memcpy(&pValue->nString, pIn, 4);
+		if ((size_t)(pEnd - pIn - 4) < pValue->nString) return 0;
+		pValue->pString = pIn + 4;
+		nSize += pValue->nString;
+		break;
+	default:
+		return 0;
+	}
+	pValue->chTag = chTag;
+	*ppArgs = pIn + nSize;
+	return 1;
+}
+
+//按格式串把编码后的参数还原成文本写入pOut(总以0结尾)，返回写入的长度
+inline size_t __wlog_bin_format(char* pOut, size_t nCap, const char* szFormat, const char* pArgs, size_t nArgs) {
+	const char* pEnd = pArgs + nArgs;
+	const char* p = szFormat;
+	size_t nLen = 0;
+	if (0 == nCap) return 0;
+	#define __WLOG_BIN_OUT(n) do { int __n = (n); if (__n > 0) nLen += (size_t)__n; if (nLen >= nCap) nLen = nCap - 1; } while (0)
+	while (*p && nLen + 1 < nCap) {
+		if ('%' != *p || '%' == p[1]) {
+			pOut[nLen++] = *p;
+			p += ('%' == *p) ? 2 : 1;
+			continue;
+		}
+		char szSpec[32] = {'%'};
+		size_t nSpec = 1;
+		int nStars[2] = {0, 0};
+		int nStarCount = 0;
+		int nPrecision = -1;	//没有精度时为-1
+		__wlog_bin_value_t value;
+		++p;
+		while (*p && strchr("-+ #0'", *p) && nSpec < 8) szSpec[nSpec++] = *p++;
+		if ('*' == *p) {
+			__wlog_bin_next(&pArgs, pEnd, &value);
+			nStars[nStarCount++] = (int)value.nValue;
+			szSpec[nSpec++] = *p++;
+		}
+		while (*p >= '0' && *p <= '9' && nSpec < 20) szSpec[nSpec++] = *p++;
+		size_t nWidthEnd = nSpec;
+		int nWidthStars = nStarCount;
+		if ('.' == *p) {
+			szSpec[nSpec++] = *p++;
+			nPrecision = 0;
+			if ('*' == *p) {
+				__wlog_bin_next(&pArgs, pEnd, &value);
+				nStars[nStarCount++] = (int)value.nValue;
+				nPrecision = (int)value.nValue;
+				szSpec[nSpec++] = *p++;
+			}
+			while (*p >= '0' && *p <= '9') {
+				nPrecision = nPrecision * 10 + (*p - '0');
+				if (nSpec < 28) szSpec[nSpec++] = *p;
+				++p;
+			}
+		}
+		int nShort = 0;	//'h'的个数：1为short，2为char
+		while (*p && strchr("hlLqjzt", *p)) {
+			if ('h' == *p) ++nShort;
+			++p;
+		}
+		char chConv = *p;
+		if (0 == chConv) break;
+		++p;
+		__wlog_bin_next(&pArgs, pEnd, &value);
+		//整数按记录里的宽度还原：有符号的做符号扩展，无符号的保持原值；h、hh与printf一样截断成short、char
+		long long nSigned = ('d' == value.chTag || 's' == value.chTag) ? 0 : value.nValue;
+		unsigned long long nUnsigned = ('d' == value.chTag || 's' == value.chTag) ? 0 : value.nUValue;
+		if (nShort >= 2) {
+			nSigned = (signed char)nSigned;
+			nUnsigned = (unsigned char)nUnsigned;
+		} else if (1 == nShort) {
+			nSigned = (short)nSigned;
+			nUnsigned = (unsigned short)nUnsigned;
+		}
+		#define __WLOG_BIN_PRINT(...) do {\
+			if (2 == nStarCount) __WLOG_BIN_OUT(snprintf(pOut + nLen, nCap - nLen, szSpec, nStars[0], nStars[1], __VA_ARGS__));\
+			else if (1 == nStarCount) __WLOG_BIN_OUT(snprintf(pOut + nLen, nCap - nLen, szSpec, nStars[0], __VA_ARGS__));\
+			else __WLOG_BIN_OUT(snprintf(pOut + nLen, nCap - nLen, szSpec, __VA_ARGS__));\
+		} while (0)
+		switch (chConv) {
+		case 'd': case 'i':
+			memcpy(szSpec + nSpec, "lld", 4);
+			__WLOG_BIN_PRINT(nSigned);
+			break;
+		case 'u': case 'x': case 'X': case 'o':
+			szSpec[nSpec] = 'l';
+			szSpec[nSpec + 1] = 'l';
+			szSpec[nSpec + 2] = chConv;
+			__WLOG_BIN_PRINT(nUnsigned);
+			break;
+		case 'c':
+			szSpec[nSpec] = 'c';
+			__WLOG_BIN_PRINT((int)nSigned);
+			break;
+		case 's': {
+			//字符串不以0结尾：保留标志与宽度，精度取格式串里的精度与字符串长度中较小的，通过*传入
+			const char* pString = ('s' == value.chTag) ? value.pString : "(null)";
+			int nString = ('s' == value.chTag) ? (int)value.nString : 6;
+			if (nPrecision >= 0 && nPrecision < nString) nString = nPrecision;
+			memcpy(szSpec + nWidthEnd, ".*s", 4);
+			if (nWidthStars > 0) {
+				__WLOG_BIN_OUT(snprintf(pOut + nLen, nCap - nLen, szSpec, nStars[0], nString, pString));
+			} else {
+				__WLOG_BIN_OUT(snprintf(pOut + nLen, nCap - nLen, szSpec, nString, pString));
+			}
+			break;
+		}
+		case 'p':
+			szSpec[nSpec] = 'p';
+			__WLOG_BIN_PRINT((void*)(uintptr_t)value.nUValue);
+			break;
+		case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+			szSpec[nSpec] = chConv;
+			__WLOG_BIN_PRINT('d' == value.chTag ? value.fValue : (double)nSigned);
+			break;
+		default:
+			szSpec[nSpec] = chConv;
+			__WLOG_BIN_OUT(snprintf(pOut + nLen, nCap - nLen, "%s", szSpec));
+			break;
+		}
+		#undef __WLOG_BIN_PRINT
+	}
+	#undef __WLOG_BIN_OUT
+	pOut[nLen] = 0;
+	return nLen;
+}
+
+#endif //__WLOG_BIN_ARG_H__
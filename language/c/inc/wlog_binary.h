@@ -0,0 +1,194 @@
+#ifndef __WLOG_BINARY_H__
+#define __WLOG_BINARY_H__
+/**
+ * @file wlog_binary.h
+ * @brief WLOG_BINARY二进制日志模式，由wlog.h在WLOG_TO_FILE时自动包含，不要单独include.
+ * <pre>logBase系列的每个调用点第一次执行时登记一次静态的格式串、文件名、行号，得到一个编号，
+        之后每次只把编号、时间戳与参数的原始字节写进文件，完全不解析格式串。
+        用tools/wlog_decode还原成与文本模式完全相同的日志。
+        logText、logXXXN仍在调用时格式化，以文本记录的形式写入。只支持C++。
+        参数支持整数、浮点、字符串(char*)与其他指针，其他类型编译报错，字符串最长WLOG_BIN_STRING_MAX字节。
+        文件格式(本机字节序)，每条记录都是 u32 记录总长度 + u8 记录类型 + 内容：
+            'M' 会话开始，每次打开文件时写入：   "WLOGBIN1" u8 时间精度(WLOG_TIME_PRECISION)
+            'S' 调用点登记：   u32 编号 u32 日志类型 u32 行号 u8 类型字符 u32 文件名长度 文件名 u32 格式串长度 格式串
+            'R' 一条logBase：  u32 编号 u64 时间(纳秒，1970年起) 参数...
+            'T' 已格式化的文本：  原样文本
+        参数为 u8 类型 + 值：'i' i32，'I' i64，'u' u32，'U' u64，'d' double，'p' u64，'s' u32 长度 + 字节
+	</pre>
+ * @os linux
+ */
+#ifndef __cplusplus
+	#error "WLOG_BINARY need c++!"
+#endif
+#if (WLOG_TO != WLOG_TO_FILE)
+	#error "WLOG_BINARY only support WLOG_TO_FILE!"
+#endif
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+#include "wlog_bin_arg.h"
+
+#define WLOG_BIN_MAGIC		"WLOGBIN1"
+#define WLOG_BIN_SESSION	'M'
+#define WLOG_BIN_SITE		'S'
+#define WLOG_BIN_RECORD		'R'
+#define WLOG_BIN_TEXT		'T'
+#define WLOG_BIN_HEAD_SIZE	5
+
+//每个logBase调用点一个静态实例，pSite为wlog_site.h里的调用点信息
+typedef struct __wlog_bin_site_t {
+	unsigned int nId;
+	int bReady;
+	const __wlog_site_t* pSite;
+} __wlog_bin_site_t;
+
+typedef struct __wlog_bin_registry_t {
+	pthread_mutex_t hMutex;
+	unsigned int nCount;
+	unsigned int nCapacity;
+	__wlog_bin_site_t** ppSites;
+} __wlog_bin_registry_t;
+
+inline __wlog_bin_registry_t* __wlog_bin_registry() {
+	static __wlog_bin_registry_t g_wlogBinRegistry = {PTHREAD_MUTEX_INITIALIZER, 0, 0, NULL};
+	return &g_wlogBinRegistry;
+}
+
+inline char* __wlog_bin_put_head(char* pOut, uint32_t nSize, char chKind) {
+	pOut = __wlog_bin_put(pOut, &nSize, 4);
+	*pOut++ = chKind;
+	return pOut;
+}
+
+//生成调用点登记记录，返回长度，pOut为NULL时只计算长度
+inline size_t __wlog_bin_site_record(const __wlog_bin_site_t* pSite, char* pOut) {
+	uint32_t nFileLen = (uint32_t)strlen(pSite->pSite->szFile);
+	uint32_t nFormatLen = (uint32_t)strlen(pSite->pSite->szFormat);
+	size_t nSize = WLOG_BIN_HEAD_SIZE + 4 + 4 + 4 + 1 + 4 + nFileLen + 4 + nFormatLen;
+	if (NULL == pOut) return nSize;
+	uint32_t nId = pSite->nId, nType = pSite->pSite->nType, nLine = (uint32_t)pSite->pSite->nLine;
+	pOut = __wlog_bin_put_head(pOut, (uint32_t)nSize, WLOG_BIN_SITE);
+	pOut = __wlog_bin_put(pOut, &nId, 4);
+	pOut = __wlog_bin_put(pOut, &nType, 4);
+	pOut = __wlog_bin_put(pOut, &nLine, 4);
+	*pOut++ = pSite->pSite->chType;
+	pOut = __wlog_bin_put(pOut, &nFileLen, 4);
+	pOut = __wlog_bin_put(pOut, pSite->pSite->szFile, nFileLen);
+	pOut = __wlog_bin_put(pOut, &nFormatLen, 4);
+	__wlog_bin_put(pOut, pSite->pSite->szFormat, nFormatLen);
+	return nSize;
+}
+
+//打开文件时由wlog_file.h调用：写入会话开始记录，并重写所有已登记的调用点，保证解码时编号可查。
+//返回时仍持有登记表的锁，切换日志文件时要在__wlog_bin_session_end_imp之前换上新文件，
+//这样新登记的调用点一定写进新文件
+inline void __wlog_bin_session_begin_imp(FILE* hFile) {
+	char szHead[WLOG_BIN_HEAD_SIZE + 9];
+	char* pOut = __wlog_bin_put_head(szHead, sizeof(szHead), WLOG_BIN_SESSION);
+	pOut = __wlog_bin_put(pOut, WLOG_BIN_MAGIC, 8);
+	*pOut = (char)WLOG_TIME_PRECISION;
+	fwrite(szHead, 1, sizeof(szHead), hFile);
+	__wlog_bin_registry_t* pRegistry = __wlog_bin_registry();
+	pthread_mutex_lock(&pRegistry->hMutex);
+	unsigned int nIdx = 0;
+	for (; nIdx < pRegistry->nCount; ++nIdx) {
+		size_t nSize = __wlog_bin_site_record(pRegistry->ppSites[nIdx], NULL);
+		char* pRecord = (char*)malloc(nSize);
+		if (NULL == pRecord) continue;
+		__wlog_bin_site_record(pRegistry->ppSites[nIdx], pRecord);
+		fwrite(pRecord, 1, nSize, hFile);
+		free(pRecord);
+	}
+}
+inline void __wlog_bin_session_end_imp() {
+	pthread_mutex_unlock(&__wlog_bin_registry()->hMutex);
+}
+inline void __wlog_bin_session_imp(FILE* hFile) {
+	__wlog_bin_session_begin_imp(hFile);
+	__wlog_bin_session_end_imp();
+}
+
+//调用点第一次执行时登记，只有分配到编号的线程写登记记录，其他线程等它写完
+inline void __wlog_bin_register_imp(__wlog_bin_site_t* pSite) {
+	__wlog_bin_registry_t* pRegistry = __wlog_bin_registry();
+	int bOwner = 0;
+	pthread_mutex_lock(&pRegistry->hMutex);
+	if (0 == pSite->nId) {
+		if (pRegistry->nCount == pRegistry->nCapacity) {
+			unsigned int nCapacity = pRegistry->nCapacity ? pRegistry->nCapacity * 2 : 256;
+			__wlog_bin_site_t** ppSites = (__wlog_bin_site_t**)realloc(pRegistry->ppSites, nCapacity * sizeof(__wlog_bin_site_t*));
+			if (NULL == ppSites) {
+				pthread_mutex_unlock(&pRegistry->hMutex);
+				return;
+			}
+			pRegistry->ppSites = ppSites;
+			pRegistry->nCapacity = nCapacity;
+		}
+		pRegistry->ppSites[pRegistry->nCount++] = pSite;
+		pSite->nId = pRegistry->nCount;
+		bOwner = 1;
+	}
+	pthread_mutex_unlock(&pRegistry->hMutex);
+	if (!bOwner) {
+		while (!__atomic_load_n(&pSite->bReady, __ATOMIC_ACQUIRE)) sched_yield();
+		return;
+	}
+	size_t nSize = __wlog_bin_site_record(pSite, NULL);
+	char* pRecord = (char*)malloc(nSize);
+	if (NULL != pRecord) {
+		__wlog_bin_site_record(pSite, pRecord);
+		__wlog_sink_write_imp(pSite->pSite->nType | __WLOG_FLUSH_NOW, pRecord, nSize);
+		free(pRecord);
+	}
+	__atomic_store_n(&pSite->bReady, 1, __ATOMIC_RELEASE);
+}
+
+//logBase的热路径：编号 + 时间 + 参数原始字节，不做任何格式化
+template <typename... Args> inline void __wlog_bin_log(__wlog_bin_site_t* pSite, Args... args) {
+	if (!__atomic_load_n(&pSite->bReady, __ATOMIC_ACQUIRE)) {
+		__wlog_bin_register_imp(pSite);
+	}
+	size_t nSize = WLOG_BIN_HEAD_SIZE + 4 + 8 + __wlog_bin_args_size(args...);
+	char szStack[WLOG_MAX_BUFFER_SIZE];
+	size_t nCap = sizeof(szStack);
+	char* pRecord = (nSize <= sizeof(szStack)) ? szStack : __wlog_arena_alloc(nSize, &nCap);
+	if (NULL == pRecord) return;
+	struct timespec tsNow;
+	clock_gettime(CLOCK_REALTIME, &tsNow);
+	uint64_t nTimeNs = (uint64_t)tsNow.tv_sec * 1000000000ULL + (uint64_t)tsNow.tv_nsec;
+	uint32_t nId = pSite->nId;
+	char* pOut = __wlog_bin_put_head(pRecord, (uint32_t)nSize, WLOG_BIN_RECORD);
+	pOut = __wlog_bin_put(pOut, &nId, 4);
+	pOut = __wlog_bin_put(pOut, &nTimeNs, 8);
+	__wlog_bin_put_args(pOut, args...);
+	__wlog_sink_write_imp(pSite->pSite->nType, pRecord, nSize);
+	if (pRecord != szStack) __wlog_arena_free(pRecord, nCap);
+}
+
+//已格式化的文本(logText、logXXXN)包成'T'记录
+inline void __wlog_write_record_imp(unsigned int nType, const char* pText, size_t nLen) {
+	char szStack[WLOG_MAX_BUFFER_SIZE];
+	size_t nSize = WLOG_BIN_HEAD_SIZE + nLen;
+	size_t nCap = sizeof(szStack);
+	char* pRecord = (nSize <= sizeof(szStack)) ? szStack : __wlog_arena_alloc(nSize, &nCap);
+	if (NULL == pRecord) return;
+	memcpy(__wlog_bin_put_head(pRecord, (uint32_t)nSize, WLOG_BIN_TEXT), pText, nLen);
+	__wlog_sink_write_imp(nType, pRecord, nSize);
+	if (pRecord != szStack) __wlog_arena_free(pRecord, nCap);
+}
+
+inline void __wlog_bin_text_imp(unsigned int nType, const char* format, ...) {
+	char szStack[WLOG_MAX_BUFFER_SIZE];
+	__wlog_arena_text_t text;
+	va_list arglist;
+	va_start(arglist, format);
+	int nLen = __wlog_arena_vformat(&text, szStack, sizeof(szStack), format, arglist);
+	va_end(arglist);
+	if (nLen >= 0) __wlog_write_record_imp(nType, text.pData, (size_t)nLen);
+	__wlog_arena_text_free(&text);
+}
+
+#endif //__WLOG_BINARY_H__
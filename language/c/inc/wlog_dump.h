@@ -0,0 +1,187 @@
+#ifndef __WLOG_DUMP_H__
+#define __WLOG_DUMP_H__
+/**
+ * @file wlog_dump.h
+ * @brief logXXXN系列的整块输出，由wlog.h在linux用户态自动包含，不要单独include.
+ * <pre>以前logXXXN每个字节调用一次logText，写文件时就是一次vfprintf加一次fflush，
+        而且[START]、数据、[E.N.D]分三次输出，多线程下会与其他日志交错。
+        现在把整段数据先编码到一块缓冲里，连同[START]与[E.N.D]两行作为一条日志一次写出。
+        szFormat为"%02X"、"%02x"、"%c"(后面可以跟不含'%'的分隔符，如"%02X ")时走查表编码，
+        编译时打开SSSE3(如-mssse3或-march=native)的话十六进制每次处理16字节；
+        其他szFormat逐个元素snprintf，但结果同样合并成一条日志。
+        WLOG_DUMP_STACK_SIZE，栈上缓冲大小，超出时从本线程的缓冲池(wlog_arena.h)取，默认4096
+	</pre>
+ * @os linux
+ */
+#include <string.h>
+#include <stdlib.h>
+#if defined(__SSSE3__)
+	#include <tmmintrin.h>
+#endif
+
+#ifndef WLOG_DUMP_STACK_SIZE
+	#define WLOG_DUMP_STACK_SIZE 4096
+#endif
+
+//szFormat的种类
+#define WLOG_DUMP_GENERIC	0
+#define WLOG_DUMP_HEX_UPPER	1
+#define WLOG_DUMP_HEX_LOWER	2
+#define WLOG_DUMP_CHAR		3
+
+typedef struct __wlog_dump_buf_t {
+	char* pData;
+	size_t nLen;
+	size_t nCap;
+	int bHeap;
+} __wlog_dump_buf_t;
+
+inline void __wlog_dump_init(__wlog_dump_buf_t* pBuf, char* pStack, size_t nStackSize) {
+	pBuf->pData = pStack;
+	pBuf->nLen = 0;
+	pBuf->nCap = nStackSize;
+	pBuf->bHeap = 0;
+}
+
+inline void __wlog_dump_free(__wlog_dump_buf_t* pBuf) {
+	if (pBuf->bHeap) __wlog_arena_free(pBuf->pData, pBuf->nCap);
+}
+
+//保证还能再写nMore字节，失败返回0
+inline int __wlog_dump_reserve(__wlog_dump_buf_t* pBuf, size_t nMore) {
+	if (pBuf->nLen + nMore <= pBuf->nCap) return 1;
+	size_t nCap = pBuf->nCap * 2;
+	while (nCap < pBuf->nLen + nMore) nCap *= 2;
+	char* pData = __wlog_arena_alloc(nCap, &nCap);
+	if (NULL == pData) return 0;
+	memcpy(pData, pBuf->pData, pBuf->nLen);
+	__wlog_dump_free(pBuf);
+	pBuf->pData = pData;
+	pBuf->nCap = nCap;
+	pBuf->bHeap = 1;
+	return 1;
+}
+
+inline void __wlog_dump_append_valist(__wlog_dump_buf_t* pBuf, const char* format, va_list arglist) {
+	va_list argcopy;
+	va_copy(argcopy, arglist);
+	int nNeed = vsnprintf(pBuf->pData + pBuf->nLen, pBuf->nCap - pBuf->nLen, format, argcopy);
+	va_end(argcopy);
+	if (nNeed < 0) return;
+	if ((size_t)nNeed >= pBuf->nCap - pBuf->nLen) {
+		if (!__wlog_dump_reserve(pBuf, (size_t)nNeed + 1)) return;
+		vsnprintf(pBuf->pData + pBuf->nLen, pBuf->nCap - pBuf->nLen, format, arglist);
+	}
+	pBuf->nLen += (size_t)nNeed;
+}
+
+inline void __wlog_dump_append(__wlog_dump_buf_t* pBuf, const char* format, ...) {
+	va_list arglist;
+	va_start(arglist, format);
+	__wlog_dump_append_valist(pBuf, format, arglist);
+	va_end(arglist);
+}
+
+//识别常用的szFormat，*ppSep指向其后的分隔符
+inline int __wlog_dump_kind(const char* szFormat, const char** ppSep) {
+	int nKind = WLOG_DUMP_GENERIC;
+	if (0 == strncmp(szFormat, "%02X", 4)) {
+		nKind = WLOG_DUMP_HEX_UPPER;
+		*ppSep = szFormat + 4;
+	} else if (0 == strncmp(szFormat, "%02x", 4)) {
+		nKind = WLOG_DUMP_HEX_LOWER;
+		*ppSep = szFormat + 4;
+	} else if (0 == strncmp(szFormat, "%c", 2)) {
+		nKind = WLOG_DUMP_CHAR;
+		*ppSep = szFormat + 2;
+	} else {
+		return WLOG_DUMP_GENERIC;
+	}
+	if (NULL != strchr(*ppSep, '%')) return WLOG_DUMP_GENERIC;
+	return nKind;
+}
+
+//十六进制编码，pOut至少要有2*nLen字节
+inline char* __wlog_hex_encode(char* pOut, const unsigned char* pIn, size_t nLen, const char* szDigits) {
+	size_t nIdx = 0;
+	#if defined(__SSSE3__)
+		const __m128i vDigits = _mm_loadu_si128((const __m128i*)szDigits);
+		const __m128i vMask = _mm_set1_epi8(0x0F);
+		for (; nIdx + 16 <= nLen; nIdx += 16) {
+			__m128i vIn = _mm_loadu_si128((const __m128i*)(pIn + nIdx));
+			__m128i vHi = _mm_shuffle_epi8(vDigits, _mm_and_si128(_mm_srli_epi16(vIn, 4), vMask));
+			__m128i vLo = _mm_shuffle_epi8(vDigits, _mm_and_si128(vIn, vMask));
+			_mm_storeu_si128((__m128i*)pOut, _mm_unpacklo_epi8(vHi, vLo));
+			_mm_storeu_si128((__m128i*)(pOut + 16), _mm_unpackhi_epi8(vHi, vLo));
+			pOut += 32;
+		}
+	#endif
+	for (; nIdx < nLen; ++nIdx) {
+		*pOut++ = szDigits[pIn[nIdx] >> 4];
+		*pOut++ = szDigits[pIn[nIdx] & 0x0F];
+	}
+	return pOut;
+}
+
+//把szBuf按szFormat编码追加到pBuf，末尾加'\n'，与以前逐字节logText的输出完全相同
+inline void __wlog_dump_payload(__wlog_dump_buf_t* pBuf, const char* szFormat, const char* szBuf, int nPrintCount) {
+	if(0 == szFormat || 0 == szBuf || nPrintCount == 0) {
+		__wlog_dump_append(pBuf, _T("CAN'T LOG TEXT N {format(%p), szBuf(%p), printcount(%d)}\n"), (void*)szFormat, szBuf, nPrintCount);
+		return;
+	}
+	const unsigned char* pPrintStart = (const unsigned char*)szBuf;
+	if(nPrintCount < 0) {
+		pPrintStart = pPrintStart + nPrintCount;
+		nPrintCount = -nPrintCount;
+	}
+	size_t nCount = (size_t)nPrintCount;
+	const char* szSep = "";
+	int nKind = __wlog_dump_kind(szFormat, &szSep);
+	size_t nSepLen = strlen(szSep);
+	size_t nIdx = 0;
+	switch (nKind) {
+	case WLOG_DUMP_HEX_UPPER:
+	case WLOG_DUMP_HEX_LOWER: {
+		const char* szDigits = (nKind == WLOG_DUMP_HEX_UPPER) ? "0123456789ABCDEF" : "0123456789abcdef";
+		if (!__wlog_dump_reserve(pBuf, nCount * (2 + nSepLen) + 1)) return;
+		char* pOut = pBuf->pData + pBuf->nLen;
+		if (0 == nSepLen) {
+			pOut = __wlog_hex_encode(pOut, pPrintStart, nCount, szDigits);
+		} else {
+			for (; nIdx < nCount; ++nIdx) {
+				pOut = __wlog_hex_encode(pOut, pPrintStart + nIdx, 1, szDigits);
+				memcpy(pOut, szSep, nSepLen);
+				pOut += nSepLen;
+			}
+		}
+		pBuf->nLen = (size_t)(pOut - pBuf->pData);
+		break;
+	}
+	case WLOG_DUMP_CHAR: {
+		if (!__wlog_dump_reserve(pBuf, nCount * (1 + nSepLen) + 1)) return;
+		char* pOut = pBuf->pData + pBuf->nLen;
+		if (0 == nSepLen) {
+			memcpy(pOut, pPrintStart, nCount);
+			pOut += nCount;
+		} else {
+			for (; nIdx < nCount; ++nIdx) {
+				*pOut++ = (char)pPrintStart[nIdx];
+				memcpy(pOut, szSep, nSepLen);
+				pOut += nSepLen;
+			}
+		}
+		pBuf->nLen = (size_t)(pOut - pBuf->pData);
+		break;
+	}
+	default:
+		for (; nIdx < nCount; ++nIdx) {
+			__wlog_dump_append(pBuf, szFormat, (unsigned char)pPrintStart[nIdx]);
+		}
+		break;
+	}
+	if (__wlog_dump_reserve(pBuf, 1)) {
+		pBuf->pData[pBuf->nLen++] = '\n';
+	}
+}
+
+#endif //__WLOG_DUMP_H__
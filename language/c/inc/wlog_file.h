@@ -0,0 +1,256 @@
+#ifndef __WLOG_FILE_H__
+#define __WLOG_FILE_H__
+/**
+ * @file wlog_file.h
+ * @brief WLOG_TO_FILE的公共部分：日志文件句柄、刷新策略与wlogFlush()，由wlog.h自动包含，不要单独include.
+ * <pre>默认每条日志都fflush一次，与以前的行为一致。可以改成分组刷新，以下条件任意一个满足就刷新：
+        可在include <wlog.h>之前修改的“宏”配置：
+		1. WLOG_FLUSH_RECORDS，累计多少条日志刷新一次，0表示不按条数，默认1
+		2. WLOG_FLUSH_BYTES，累计多少字节刷新一次，0表示不按字节数，默认0
+		3. WLOG_FLUSH_INTERVAL_MS，距上次刷新超过多少毫秒就刷新，0表示不按时间，默认0。
+			同步模式下会启动一个后台线程按此间隔刷新，保证日志不会在缓冲里停留太久
+		4. WLOG_FLUSH_TYPES，这些类型的日志写完后立即刷新，默认WLOG_TYPE_ERROR及以上
+		5. WLOG_FLUSH_SYNC_TYPES，这些类型的日志刷新后还要fdatasync落盘，默认0
+		如只想让ERROR及以上立即落盘，DEBUG/TRACE等合并刷新，可以
+			#define WLOG_FLUSH_RECORDS 0
+			#define WLOG_FLUSH_BYTES (64 * 1024)
+			#define WLOG_FLUSH_INTERVAL_MS 200
+			#define WLOG_FLUSH_SYNC_TYPES (WLOG_TYPE_ERROR | WLOG_TYPE_VERIFY | WLOG_TYPE_ASSERT | WLOG_TYPE_FATAL)
+		退出前或需要确保日志写出的地方调用wlogFlush()。
+	</pre>
+ * @os windows, linux
+ */
+#ifndef WLOG_FLUSH_RECORDS
+	#define WLOG_FLUSH_RECORDS 1
+#endif
+#ifndef WLOG_FLUSH_BYTES
+	#define WLOG_FLUSH_BYTES 0
+#endif
+#ifndef WLOG_FLUSH_INTERVAL_MS
+	#define WLOG_FLUSH_INTERVAL_MS 0
+#endif
+#ifndef WLOG_FLUSH_TYPES
+	#define WLOG_FLUSH_TYPES (WLOG_TYPE_ERROR | WLOG_TYPE_VERIFY | WLOG_TYPE_ASSERT | WLOG_TYPE_FATAL)
+#endif
+#ifndef WLOG_FLUSH_SYNC_TYPES
+	#define WLOG_FLUSH_SYNC_TYPES 0
+#endif
+
+//内部使用的类型位：这条日志写完后立即刷新，不参与分组，如二进制模式的调用点登记记录
+#define __WLOG_FLUSH_NOW 0x80000000u
+
+#ifdef _WIN32
+	#include <io.h>
+	#define __wlog_file_lock(hFile)		_lock_file(hFile)
+	#define __wlog_file_unlock(hFile)	_unlock_file(hFile)
+	#define __wlog_file_sync(hFile)		_commit(_fileno(hFile))
+#else
+	#include <pthread.h>
+	#include <fcntl.h>
+	#include <limits.h>
+	#include <unistd.h>
+	#include <sys/stat.h>
+	#define __wlog_file_lock(hFile)		flockfile(hFile)
+	#define __wlog_file_unlock(hFile)	funlockfile(hFile)
+	#define __wlog_file_sync(hFile)		fdatasync(fileno(hFile))
+#endif
+
+inline FILE** __wlog_file_handle() {
+	static FILE *g_wlogOutFileHandle = NULL;
+	return &g_wlogOutFileHandle;
+}
+
+//自上次刷新以来累计的条数、字节数，由文件锁保护
+typedef struct __wlog_flush_state_t {
+	unsigned long nRecords;
+	unsigned long nBytes;
+	unsigned long nLastFlushMs;
+} __wlog_flush_state_t;
+
+inline __wlog_flush_state_t* __wlog_flush_state() {
+	static __wlog_flush_state_t g_wlogFlushState;
+	return &g_wlogFlushState;
+}
+
+inline unsigned long __wlog_flush_now_ms() {
+	#ifdef _WIN32
+		return (unsigned long)GetTickCount();
+	#else
+		struct timespec tsNow;
+		clock_gettime(CLOCK_MONOTONIC_COARSE, &tsNow);
+		return (unsigned long)tsNow.tv_sec * 1000 + tsNow.tv_nsec / 1000000;
+	#endif
+}
+
+inline void __wlog_flush_reset_imp(__wlog_flush_state_t* pState) {
+	pState->nRecords = 0;
+	pState->nBytes = 0;
+	#if (WLOG_FLUSH_INTERVAL_MS > 0)
+		pState->nLastFlushMs = __wlog_flush_now_ms();
+	#endif
+}
+
+//写完nRecords条共nBytes字节后调用，调用者必须持有hFile的锁；nType是这批日志类型的并集
+inline void __wlog_flush_policy_imp(FILE* hFile, unsigned int nType, unsigned long nRecords, unsigned long nBytes) {
+	__wlog_flush_state_t* pState = __wlog_flush_state();
+	int bFlush = (0 != (nType & (WLOG_FLUSH_TYPES | __WLOG_FLUSH_NOW)));
+	pState->nRecords += nRecords;
+	pState->nBytes += nBytes;
+	#if (WLOG_FLUSH_RECORDS > 0)
+		bFlush = bFlush || (pState->nRecords >= WLOG_FLUSH_RECORDS);
+	#endif
+	#if (WLOG_FLUSH_BYTES > 0)
+		bFlush = bFlush || (pState->nBytes >= WLOG_FLUSH_BYTES);
+	#endif
+	#if (WLOG_FLUSH_INTERVAL_MS > 0)
+		bFlush = bFlush || (__wlog_flush_now_ms() - pState->nLastFlushMs >= WLOG_FLUSH_INTERVAL_MS);
+	#endif
+	if (!bFlush) return;
+	fflush(hFile);
+	if (nType & WLOG_FLUSH_SYNC_TYPES) {
+		__wlog_file_sync(hFile);
+	}
+	__wlog_flush_reset_imp(pState);
+}
+
+#if (WLOG_ROTATE_SIZE > 0) || (WLOG_ROTATE_INTERVAL_SEC > 0)
+	#define WLOG_ROTATE 1
+#else
+	#define WLOG_ROTATE 0
+#endif
+
+//稀疏索引，供tools/wlog_query按时间、级别跳过不需要的部分
+#if WLOG_INDEX
+	#include "wlog_index.h"
+#endif
+
+#if (WLOG_FLUSH_INTERVAL_MS > 0) && !defined(_WIN32) && !WLOG_ASYNC
+	inline void __wlog_stage_flush_all_imp();
+	//同步模式下没有写线程，由这个线程保证缓冲里的日志最多停留WLOG_FLUSH_INTERVAL_MS
+	inline void* __wlog_flush_timer_imp(void* pArg) {
+		(void)pArg;
+		for (;;) {
+			usleep(WLOG_FLUSH_INTERVAL_MS * 1000);
+			__wlog_stage_flush_all_imp();
+		}
+		return NULL;
+	}
+	inline void __wlog_flush_timer_start_imp() {
+		pthread_t hThread;
+		if (0 == pthread_create(&hThread, NULL, __wlog_flush_timer_imp, NULL)) {
+			pthread_detach(hThread);
+		}
+	}
+	#define WLOG_FLUSH_TIMER_START() do {\
+		static pthread_once_t __wlog_flush_timer_once = PTHREAD_ONCE_INIT;\
+		pthread_once(&__wlog_flush_timer_once, __wlog_flush_timer_start_imp);\
+	} while (0)
+#else
+	#define WLOG_FLUSH_TIMER_START()
+#endif
+
+#if !defined(_WIN32)
+	#if WLOG_BINARY
+		inline void __wlog_bin_session_imp(FILE* hFile);
+		inline void __wlog_bin_session_begin_imp(FILE* hFile);
+		inline void __wlog_bin_session_end_imp();
+	#endif
+	//每个新打开的日志文件开头的标记，二进制模式下是会话记录，JSON模式下不写，保证每行都是JSON
+	inline void __wlog_file_begin_imp(FILE* hFile) {
+		#if WLOG_BINARY
+			__wlog_bin_session_imp(hFile);
+		#elif WLOG_JSON
+			(void)hFile;
+		#else
+			fprintf(hFile,_T("\n++++++++++WLOG+++++++++++\n"));
+		#endif
+	}
+	//一次write不会与其他进程交错的最大字节数，0表示不限；打开文件时按文件类型设置，见wlog_stage.h
+	inline size_t* __wlog_file_atomic_size() {
+		static size_t g_wlogAtomicSize = 0;
+		return &g_wlogAtomicSize;
+	}
+
+	//以O_APPEND | O_CLOEXEC打开WLOG_FILE_NAME：子进程exec后不会继承，普通文件的每次write整体追加在末尾
+	inline FILE* __wlog_file_fopen_imp() {
+		int hFd = open(WLOG_FILE_NAME, O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0666);
+		if (hFd < 0) return NULL;
+		struct stat stFile;
+		if (0 == fstat(hFd, &stFile)) {
+			#ifdef WLOG_FILE_ATOMIC_SIZE
+				*__wlog_file_atomic_size() = WLOG_FILE_ATOMIC_SIZE;
+			#else
+				//管道、FIFO只保证PIPE_BUF以内的write不交错，普通文件的一次write总是整体追加
+				*__wlog_file_atomic_size() = S_ISREG(stFile.st_mode) ? 0 : PIPE_BUF;
+			#endif
+		}
+		FILE* hFile = fdopen(hFd, "a");
+		if (NULL == hFile) close(hFd);
+		return hFile;
+	}
+
+	//打开日志文件，成功时*ppHandle非NULL
+	inline void __wlog_file_open_imp(FILE** ppHandle) {
+		WLOG_CHECK_FILE_EXIST;
+		*ppHandle = __wlog_file_fopen_imp();
+		if(*ppHandle) {
+			__wlog_file_begin_imp(*ppHandle);
+			fflush(*ppHandle);
+			#if WLOG_INDEX
+				__wlog_index_open_imp(fileno(*ppHandle));
+			#endif
+			__wlog_flush_reset_imp(__wlog_flush_state());
+			WLOG_FLUSH_TIMER_START();
+		}
+	}
+#endif
+
+//__wlog_file_acquire_imp取得当前日志文件，bOpen为1时还没打开就打开，返回NULL表示不能写；
+//用完后调用__wlog_file_release_imp，nWritten是写入的字节数，小于0表示写失败。
+//两者都不加锁，用stdio写的调用者自己__wlog_file_lock
+#if WLOG_ROTATE
+	#include "wlog_rotate.h"
+#elif defined(_WIN32)
+	inline FILE* __wlog_file_acquire_imp(int bOpen) {
+		(void)bOpen;
+		return *__wlog_file_handle();
+	}
+	inline void __wlog_file_release_imp(FILE* hFile, long nWritten) {
+		(void)hFile;
+		(void)nWritten;
+	}
+#else
+	//多个线程同时第一次写日志时只有一个打开文件，其他线程等它打开后直接使用
+	inline FILE* __wlog_file_acquire_imp(int bOpen) {
+		static pthread_mutex_t g_wlogOpenMutex = PTHREAD_MUTEX_INITIALIZER;
+		FILE** ppHandle = __wlog_file_handle();
+		FILE* hFile = __atomic_load_n(ppHandle, __ATOMIC_ACQUIRE);
+		if (hFile == NULL && bOpen) {
+			pthread_mutex_lock(&g_wlogOpenMutex);
+			if (NULL == (hFile = *ppHandle)) {
+				__wlog_file_open_imp(&hFile);
+				__atomic_store_n(ppHandle, hFile, __ATOMIC_RELEASE);
+			}
+			pthread_mutex_unlock(&g_wlogOpenMutex);
+		}
+		return hFile;
+	}
+	inline void __wlog_file_release_imp(FILE* hFile, long nWritten) {
+		(void)hFile;
+		(void)nWritten;
+	}
+#endif
+
+inline void __wlog_file_flush_imp() {
+	FILE* hFile = __wlog_file_acquire_imp(0);
+	if (NULL == hFile) return;
+	__wlog_file_lock(hFile);
+	if (__wlog_flush_state()->nRecords > 0) {
+		fflush(hFile);
+		__wlog_flush_reset_imp(__wlog_flush_state());
+	}
+	__wlog_file_unlock(hFile);
+	__wlog_file_release_imp(hFile, 0);
+}
+
+#endif //__WLOG_FILE_H__
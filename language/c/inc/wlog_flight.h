@@ -0,0 +1,322 @@
+#ifndef __WLOG_FLIGHT_H__
+#define __WLOG_FLIGHT_H__
+/**
+ * @file wlog_flight.h
+ * @brief WLOG_FLIGHT飞行记录器，由wlog.h在linux用户态自动包含，不要单独include.
+ * <pre>静态开关关掉的级别(如TRACE、DEBUG)不写文件，但出错时又需要出错之前的上下文。
+        WLOG_FLIGHT定义成1后，WLOG_FLIGHT_TYPES里被WLOG_STATIC_TYPE_SWITCH关掉的级别不再展开为空，
+        而是与WLOG_BINARY一样只把调用点、时间与参数的原始字节记进每个线程自己的环形缓冲，不格式化、不加锁、不写文件，
+        缓冲满时覆盖最旧的记录。以下情况才把缓冲里的记录格式化并写出，写出后清空：
+            1. 本线程输出WLOG_FLIGHT_TRIGGER_TYPES的日志(默认ERROR、FATAL、VERIFY、ASSERT)，先写出本线程的记录，再写这条日志，
+               logVerify失败时在abort之前写出
+            2. 收到SIGSEGV、SIGBUS、SIGFPE、SIGILL、SIGABRT，在信号处理函数里写出所有线程的记录并刷新，再交给原来的处理函数。
+               信号处理函数里格式化不是异步信号安全的，只是尽力而为
+        写出的记录与普通日志格式相同，前后有"++++++++++FLIGHT tid+++++++++++"、"++++++++++FLIGHT END+++++++++++"两行。
+        logXXXN只记录消息，不记录数据，logXXXF、logXXXKV仍展开为空。需要C++11，不支持WLOG_BINARY与WLOG_JSON。
+        可在include <wlog.h>之前修改的“宏”配置：
+		1. WLOG_FLIGHT，是否启用飞行记录器，默认0
+		2. WLOG_FLIGHT_TYPES，记进内存的日志类型，默认WLOG_TYPE_TRACE | WLOG_TYPE_DEBUG，只对静态关掉的类型有效
+		3. WLOG_FLIGHT_TRIGGER_TYPES，触发写出的日志类型，默认WLOG_TYPE_ERROR | WLOG_TYPE_FATAL | WLOG_TYPE_VERIFY | WLOG_TYPE_ASSERT
+		4. WLOG_FLIGHT_SIZE，每个线程的环形缓冲大小，默认64K
+		5. WLOG_FLIGHT_SIGNALS，是否安装致命信号的处理函数，默认1
+        运行时可以调用wlogFlightDump()写出所有线程的记录。
+	</pre>
+ * @os linux
+ */
+#if !defined(__cplusplus) || (__cplusplus < 201103L)
+	#error "WLOG_FLIGHT need c++11!"
+#endif
+#if WLOG_BINARY || WLOG_JSON
+	#error "WLOG_FLIGHT can't be used with WLOG_BINARY or WLOG_JSON!"
+#endif
+
+#include <pthread.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include "wlog_bin_arg.h"
+
+#ifndef WLOG_FLIGHT_TYPES
+	#define WLOG_FLIGHT_TYPES (WLOG_TYPE_TRACE | WLOG_TYPE_DEBUG)
+#endif
+#ifndef WLOG_FLIGHT_TRIGGER_TYPES
+	#define WLOG_FLIGHT_TRIGGER_TYPES (WLOG_TYPE_ERROR | WLOG_TYPE_FATAL | WLOG_TYPE_VERIFY | WLOG_TYPE_ASSERT)
+#endif
+#ifndef WLOG_FLIGHT_SIZE
+	#define WLOG_FLIGHT_SIZE (64 * 1024)
+#endif
+#ifndef WLOG_FLIGHT_SIGNALS
+	#define WLOG_FLIGHT_SIGNALS 1
+#endif
+
+#if (WLOG_FLIGHT_SIZE % 8) || (WLOG_FLIGHT_SIZE < 1024)
+	#error "WLOG_FLIGHT_SIZE must be a multiple of 8 and at least 1024!"
+#endif
+
+//记录按8字节对齐，头部：u32 记录长度 u32 参数长度 u64 调用点指针 u64 时间(纳秒)，之后为参数；
+//长度为0表示缓冲末尾剩下的空间没有用，下一条记录从头开始
+#define __WLOG_FLIGHT_HEAD 24
+
+//每个线程一个，线程退出后留给之后新建的线程复用，信号处理函数里可以遍历
+typedef struct __wlog_flight_ring_t {
+	unsigned long nHead;
+	unsigned long nTail;
+	long nTid;
+	int bInUse;
+	struct __wlog_flight_ring_t* pNext;
+	char szData[WLOG_FLIGHT_SIZE];
+} __wlog_flight_ring_t;
+
+typedef struct __wlog_flight_ctx_t {
+	pthread_mutex_t hMutex;
+	pthread_once_t hOnce;
+	pthread_key_t hKey;
+	__wlog_flight_ring_t* pRings;
+	int bDumping;
+} __wlog_flight_ctx_t;
+
+inline __wlog_flight_ctx_t* __wlog_flight_ctx() {
+	static __wlog_flight_ctx_t g_wlogFlightCtx = {PTHREAD_MUTEX_INITIALIZER, PTHREAD_ONCE_INIT, 0, NULL, 0};
+	return &g_wlogFlightCtx;
+}
+
+inline __wlog_flight_ring_t*& __wlog_flight_tls() {
+	static __thread __wlog_flight_ring_t* g_wlogFlightRing = NULL;
+	return g_wlogFlightRing;
+}
+
+inline void wlogFlightDump();
+
+#if WLOG_FLIGHT_SIGNALS
+	#define __WLOG_FLIGHT_SIGNAL_COUNT 5
+	inline const int* __wlog_flight_signals() {
+		static const int g_wlogFlightSignals[__WLOG_FLIGHT_SIGNAL_COUNT] = {SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT};
+		return g_wlogFlightSignals;
+	}
+	inline struct sigaction* __wlog_flight_old_actions() {
+		static struct sigaction g_wlogFlightOld[__WLOG_FLIGHT_SIGNAL_COUNT];
+		return g_wlogFlightOld;
+	}
+	//写出所有线程的记录，恢复原来的处理函数后重新发出信号
+	inline void __wlog_flight_signal_imp(int nSignal) {
+		wlogFlightDump();
+		int nIdx = 0;
+		for (; nIdx < __WLOG_FLIGHT_SIGNAL_COUNT; ++nIdx) {
+			if (__wlog_flight_signals()[nIdx] == nSignal) {
+				sigaction(nSignal, &__wlog_flight_old_actions()[nIdx], NULL);
+			}
+		}
+		raise(nSignal);
+	}
+#endif
+
+//线程退出时把环形缓冲还回去
+inline void __wlog_flight_release_imp(void* pData) {
+	__wlog_flight_ring_t* pRing = (__wlog_flight_ring_t*)pData;
+	__atomic_store_n(&pRing->nTail, __atomic_load_n(&pRing->nHead, __ATOMIC_RELAXED), __ATOMIC_RELEASE);
+	__atomic_store_n(&pRing->bInUse, 0, __ATOMIC_RELEASE);
+}
+
+inline void __wlog_flight_init_imp() {
+	__wlog_flight_ctx_t* pCtx = __wlog_flight_ctx();
+	pthread_key_create(&pCtx->hKey, __wlog_flight_release_imp);
+	#if WLOG_FLIGHT_SIGNALS
+		struct sigaction sigAction;
+		memset(&sigAction, 0, sizeof(sigAction));
+		sigAction.sa_handler = __wlog_flight_signal_imp;
+		sigemptyset(&sigAction.sa_mask);
+		int nIdx = 0;
+		for (; nIdx < __WLOG_FLIGHT_SIGNAL_COUNT; ++nIdx) {
+			sigaction(__wlog_flight_signals()[nIdx], &sigAction, &__wlog_flight_old_actions()[nIdx]);
+		}
+	#endif
+}
+
+//本线程第一次记录时取一个空闲的环形缓冲，没有就新分配一个
+inline __wlog_flight_ring_t* __wlog_flight_attach_imp() {
+	__wlog_flight_ctx_t* pCtx = __wlog_flight_ctx();
+	pthread_once(&pCtx->hOnce, __wlog_flight_init_imp);
+	__wlog_flight_ring_t* pRing = NULL;
+	pthread_mutex_lock(&pCtx->hMutex);
+	for (pRing = pCtx->pRings; NULL != pRing; pRing = pRing->pNext) {
+		if (!__atomic_load_n(&pRing->bInUse, __ATOMIC_ACQUIRE)) break;
+	}
+	if (NULL == pRing) {
+		pRing = (__wlog_flight_ring_t*)malloc(sizeof(__wlog_flight_ring_t));
+		if (NULL != pRing) {
+			pRing->nHead = 0;
+			pRing->nTail = 0;
+			pRing->pNext = pCtx->pRings;
+			__atomic_store_n(&pCtx->pRings, pRing, __ATOMIC_RELEASE);
+		}
+	}
+	if (NULL != pRing) {
+		pRing->nTid = (long)syscall(SYS_gettid);
+		__atomic_store_n(&pRing->bInUse, 1, __ATOMIC_RELEASE);
+		pthread_setspecific(pCtx->hKey, pRing);
+	}
+	pthread_mutex_unlock(&pCtx->hMutex);
+	__wlog_flight_tls() = pRing;
+	return pRing;
+}
+
+//被静态开关关掉的logBase：只记录调用点、时间与参数的原始字节
+template <typename... Args> inline void __wlog_flight_log(const __wlog_site_t* pSite, Args... args) {
+	__wlog_flight_ring_t* pRing = __wlog_flight_tls();
+	if (NULL == pRing && NULL == (pRing = __wlog_flight_attach_imp())) return;
+	size_t nArgs = __wlog_bin_args_size(args...);
+	size_t nSize = (__WLOG_FLIGHT_HEAD + nArgs + 7) & ~(size_t)7;
+	if (nSize > WLOG_FLIGHT_SIZE) return;
+	unsigned long nHead = pRing->nHead;
+	size_t nOffset = nHead % WLOG_FLIGHT_SIZE;
+	size_t nSkip = (nOffset + nSize > WLOG_FLIGHT_SIZE) ? WLOG_FLIGHT_SIZE - nOffset : 0;
+	//空间不够时丢弃最旧的记录
+	unsigned long nTail = pRing->nTail;
+	while (nHead + nSkip + nSize - nTail > WLOG_FLIGHT_SIZE) {
+		uint32_t nOld = 0;
+		memcpy(&nOld, pRing->szData + nTail % WLOG_FLIGHT_SIZE, 4);
+		nTail += (0 == nOld) ? WLOG_FLIGHT_SIZE - nTail % WLOG_FLIGHT_SIZE : nOld;
+	}
+	__atomic_store_n(&pRing->nTail, nTail, __ATOMIC_RELEASE);
+	if (nSkip > 0) {
+		memset(pRing->szData + nOffset, 0, 4);
+		nHead += nSkip;
+		nOffset = 0;
+	}
+	struct timespec tsNow;
+	clock_gettime(WLOG_TIME_CLOCK, &tsNow);
+	uint64_t nTimeNs = (uint64_t)tsNow.tv_sec * 1000000000ULL + (uint64_t)tsNow.tv_nsec;
+	uint64_t nSite = (uint64_t)(uintptr_t)pSite;
+	uint32_t nHeads[2] = {(uint32_t)nSize, (uint32_t)nArgs};
+	char* pOut = __wlog_bin_put(pRing->szData + nOffset, nHeads, 8);
+	pOut = __wlog_bin_put(pOut, &nSite, 8);
+	pOut = __wlog_bin_put(pOut, &nTimeNs, 8);
+	__wlog_bin_put_args(pOut, args...);
+	__atomic_store_n(&pRing->nHead, nHead + nSize, __ATOMIC_RELEASE);
+}
+
+//一条记录还原成与logBase相同的文本行
+inline size_t __wlog_flight_line_imp(char* pOut, size_t nCap, const __wlog_site_t* pSite, uint64_t nTimeNs, const char* pArgs, size_t nArgs) {
+	time_t nSecond = (time_t)(nTimeNs / 1000000000ULL);
+	struct tm tmNow;
+	char szTime[32] = {0};
+	if (NULL != localtime_r(&nSecond, &tmNow)) {
+		#if (WLOG_TIME_PRECISION > 0)
+			snprintf(szTime, sizeof(szTime), "%02d-%02d %02d:%02d:%02d.%0*lu", tmNow.tm_mon + 1, tmNow.tm_mday, tmNow.tm_hour, tmNow.tm_min,
+				tmNow.tm_sec, WLOG_TIME_PRECISION, (unsigned long)(nTimeNs % 1000000000ULL / WLOG_TIME_FRACTION_DIV));
+		#else
+			snprintf(szTime, sizeof(szTime), "%02d-%02d %02d:%02d:%02d", tmNow.tm_mon + 1, tmNow.tm_mday, tmNow.tm_hour, tmNow.tm_min, tmNow.tm_sec);
+		#endif
+	}
+	int nHead = snprintf(pOut, nCap, "%s %c %s:%-4d| ", szTime, pSite->chType, pSite->szFile, pSite->nLine);
+	if (nHead < 0) return 0;
+	size_t nLen = ((size_t)nHead >= nCap) ? nCap - 1 : (size_t)nHead;
+	nLen += __wlog_bin_format(pOut + nLen, nCap - nLen - 1, pSite->szFormat, pArgs, nArgs);
+	pOut[nLen++] = '\n';
+	return nLen;
+}
+
+//写出一个环形缓冲里的记录并清空，nType为开始、结束两行的日志类型
+inline void __wlog_flight_dump_ring_imp(__wlog_flight_ring_t* pRing, unsigned int nType) {
+	unsigned long nHead = __atomic_load_n(&pRing->nHead, __ATOMIC_ACQUIRE);
+	unsigned long nTail = __atomic_load_n(&pRing->nTail, __ATOMIC_ACQUIRE);
+	if (nHead == nTail) return;
+	char szLine[WLOG_DUMP_STACK_SIZE];
+	int nLen = snprintf(szLine, sizeof(szLine), "++++++++++FLIGHT %ld+++++++++++\n", pRing->nTid);
+	__wlog_write_record_imp(nType, szLine, (size_t)nLen);
+	while (nTail != nHead) {
+		const char* pRecord = pRing->szData + nTail % WLOG_FLIGHT_SIZE;
+		uint32_t nHeads[2] = {0, 0};
+		memcpy(nHeads, pRecord, 8);
+		if (0 == nHeads[0]) {
+			nTail += WLOG_FLIGHT_SIZE - nTail % WLOG_FLIGHT_SIZE;
+			continue;
+		}
+		uint64_t nSite = 0, nTimeNs = 0;
+		memcpy(&nSite, pRecord + 8, 8);
+		memcpy(&nTimeNs, pRecord + 16, 8);
+		const __wlog_site_t* pSite = (const __wlog_site_t*)(uintptr_t)nSite;
+		size_t nLine = __wlog_flight_line_imp(szLine, sizeof(szLine), pSite, nTimeNs, pRecord + __WLOG_FLIGHT_HEAD, nHeads[1]);
+		__wlog_write_record_imp(pSite->nType, szLine, nLine);
+		nTail += nHeads[0];
+	}
+	__atomic_store_n(&pRing->nTail, nHead, __ATOMIC_RELEASE);
+	__wlog_write_record_imp(nType, "++++++++++FLIGHT END+++++++++++\n", 32);
+}
+
+//触发类型的日志写出之前调用：写出本线程的记录
+inline void __wlog_flight_trigger_imp(unsigned int nType) {
+	__wlog_flight_ring_t* pRing = __wlog_flight_tls();
+	if (NULL != pRing) __wlog_flight_dump_ring_imp(pRing, nType);
+}
+
+//写出所有线程的记录，先写本线程的。其他线程可能正在记录，尽力而为
+inline void wlogFlightDump() {
+	__wlog_flight_ctx_t* pCtx = __wlog_flight_ctx();
+	if (__atomic_exchange_n(&pCtx->bDumping, 1, __ATOMIC_ACQ_REL)) return;
+	__wlog_flight_ring_t* pSelf = __wlog_flight_tls();
+	if (NULL != pSelf) __wlog_flight_dump_ring_imp(pSelf, WLOG_TYPE_FATAL);
+	__wlog_flight_ring_t* pRing = __atomic_load_n(&pCtx->pRings, __ATOMIC_ACQUIRE);
+	for (; NULL != pRing; pRing = pRing->pNext) {
+		if (pRing != pSelf && __atomic_load_n(&pRing->bInUse, __ATOMIC_ACQUIRE)) {
+			__wlog_flight_dump_ring_imp(pRing, WLOG_TYPE_FATAL);
+		}
+	}
+	wlogFlush();
+	__atomic_store_n(&pCtx->bDumping, 0, __ATOMIC_RELEASE);
+}
+
+#undef WLOG_FLIGHT_CHECK
+#define WLOG_FLIGHT_CHECK(nType) if ((nType) & (WLOG_FLIGHT_TRIGGER_TYPES)) __wlog_flight_trigger_imp(nType)
+
+#define logFlightBase(nType, chType, format, args...) do {\
+	WLOG_SITE_DEFINE(nType, chType, format);\
+	__wlog_flight_log(&__wlog_site, ##args);\
+} while (0)
+
+//静态关掉但要记进内存的级别，C、N、R、S系列都只记录消息
+#if !(WLOG_STATIC_TYPE_SWITCH&WLOG_TYPE_TRACE) && (WLOG_FLIGHT_TYPES&WLOG_TYPE_TRACE) && (WLOG_STATIC_TYPE_SWITCH&WLOG_TYPE_BASE)
+	#define logTrace(format, args...) logFlightBase(WLOG_TYPE_TRACE, _T('T'), format, ##args)
+	#define logTraceC(condition, format, args...) if(condition) logTrace(format, ##args)
+	#define logTraceN(szFormat, szBuf, nPrintCount, format, args...) logTrace(format, ##args)
+	#define logTraceCN(condition, szFormat, szBuf, nPrintCount, format, args...) if(condition) logTrace(format, ##args)
+	#define logTraceR(nPerSecond, format, args...) logTrace(format, ##args)
+	#define logTraceS(nSample, format, args...) logTrace(format, ##args)
+#endif
+#if !(WLOG_STATIC_TYPE_SWITCH&WLOG_TYPE_DEBUG) && (WLOG_FLIGHT_TYPES&WLOG_TYPE_DEBUG) && (WLOG_STATIC_TYPE_SWITCH&WLOG_TYPE_BASE)
+	#define logDebug(format, args...) logFlightBase(WLOG_TYPE_DEBUG, _T('D'), format, ##args)
+	#define logDebugC(condition, format, args...) if(condition) logDebug(format, ##args)
+	#define logDebugN(szFormat, szBuf, nPrintCount, format, args...) logDebug(format, ##args)
+	#define logDebugCN(condition, szFormat, szBuf, nPrintCount, format, args...) if(condition) logDebug(format, ##args)
+	#define logDebugR(nPerSecond, format, args...) logDebug(format, ##args)
+	#define logDebugS(nSample, format, args...) logDebug(format, ##args)
+#endif
+#if !(WLOG_STATIC_TYPE_SWITCH&WLOG_TYPE_INFO) && (WLOG_FLIGHT_TYPES&WLOG_TYPE_INFO) && (WLOG_STATIC_TYPE_SWITCH&WLOG_TYPE_BASE)
+	#define logInfo(format, args...) logFlightBase(WLOG_TYPE_INFO, _T('I'), format, ##args)
+	#define logInfoC(condition, format, args...) if(condition) logInfo(format, ##args)
+	#define logInfoN(szFormat, szBuf, nPrintCount, format, args...) logInfo(format, ##args)
+	#define logInfoCN(condition, szFormat, szBuf, nPrintCount, format, args...) if(condition) logInfo(format, ##args)
+	#define logInfoR(nPerSecond, format, args...) logInfo(format, ##args)
+	#define logInfoS(nSample, format, args...) logInfo(format, ##args)
+#endif
+#if !(WLOG_STATIC_TYPE_SWITCH&WLOG_TYPE_NOTICE) && (WLOG_FLIGHT_TYPES&WLOG_TYPE_NOTICE) && (WLOG_STATIC_TYPE_SWITCH&WLOG_TYPE_BASE)
+	#define logNotice(format, args...) logFlightBase(WLOG_TYPE_NOTICE, _T('N'), format, ##args)
+	#define logNoticeC(condition, format, args...) if(condition) logNotice(format, ##args)
+	#define logNoticeN(szFormat, szBuf, nPrintCount, format, args...) logNotice(format, ##args)
+	#define logNoticeCN(condition, szFormat, szBuf, nPrintCount, format, args...) if(condition) logNotice(format, ##args)
+	#define logNoticeR(nPerSecond, format, args...) logNotice(format, ##args)
+	#define logNoticeS(nSample, format, args...) logNotice(format, ##args)
+#endif
+#if !(WLOG_STATIC_TYPE_SWITCH&WLOG_TYPE_WARNING) && (WLOG_FLIGHT_TYPES&WLOG_TYPE_WARNING) && (WLOG_STATIC_TYPE_SWITCH&WLOG_TYPE_BASE)
+	#define logWarning(format, args...) logFlightBase(WLOG_TYPE_WARNING, _T('W'), format, ##args)
+	#define logWarningC(condition, format, args...) if(condition) logWarning(format, ##args)
+	#define logWarningN(szFormat, szBuf, nPrintCount, format, args...) logWarning(format, ##args)
+	#define logWarningCN(condition, szFormat, szBuf, nPrintCount, format, args...) if(condition) logWarning(format, ##args)
+	#define logWarningR(nPerSecond, format, args...) logWarning(format, ##args)
+	#define logWarningS(nSample, format, args...) logWarning(format, ##args)
+#endif
+
+#endif //__WLOG_FLIGHT_H__
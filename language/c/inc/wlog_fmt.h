@@ -0,0 +1,398 @@
+#ifndef __WLOG_FMT_H__
+#define __WLOG_FMT_H__
+/**
+ * @file wlog_fmt.h
+ * @brief C++17下类型安全的logXXXF系列，由wlog.h自动包含，不要单独include.
+ * <pre>logXXXF(format, ...)用"{}"占位，格式串在编译时按参数类型检查，占位数与参数个数不符、
+        说明符与类型不符、参数类型不支持都是编译错误，不会再有printf那样%s对上整数在运行时崩溃的问题：
+            logInfoF("user {} login from {}, cost {:.3f} ms", nUserId, szAddr, fCostMs);
+            logErrorF("recv failed, ret {} errno {:x}", nRet, errno);
+        整数与浮点用std::to_chars转换，不经过printf，格式化到每个线程一块可重用的缓冲，再一次写出。
+        WLOG_JSON下格式化的结果是JSON日志的"msg"字段。
+        与logXXX相同受静态开关与动态开关控制，静态关闭的级别展开为空，参数不会求值。
+        占位符：{}、{:[0][宽度][.精度][类型]}，"{{"、"}}"输出花括号本身
+            类型  d        十进制，整数、字符、bool
+                  x X o    十六进制、八进制，整数、字符
+                  f e g    定点、科学计数、通用，浮点，不写类型时为最短的能精确还原的表示
+                  s        字符串(const char*、std::string、std::string_view)、bool
+                  c        字符，整数按字符输出
+                  p        指针
+            精度只能用于浮点与字符串(字符串为最多输出的字节数)，数字右对齐，其他左对齐，0只用于数字
+        可在include <wlog.h>之前修改的“宏”配置：
+		1. WLOG_FMT_BUFFER_SIZE，每个线程格式化缓冲的初始大小，不够时自动扩大并一直保留，默认1K
+	</pre>
+ * @os linux
+ */
+#if !defined(__cplusplus) || (__cplusplus < 201703L)
+	#error "logXXXF need c++17!"
+#endif
+
+#include <charconv>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef WLOG_FMT_BUFFER_SIZE
+	#define WLOG_FMT_BUFFER_SIZE 1024
+#endif
+
+//参数种类：'b' bool，'c' 字符，'i' 有符号整数，'u' 无符号整数，'f' 浮点，'s' 字符串，'p' 指针，0 不支持
+template <typename T> constexpr char __wlog_fmt_kind() {
+	typedef std::remove_cv_t<std::remove_reference_t<T>> type_t;
+	if constexpr (std::is_same_v<type_t, bool>) return 'b';
+	else if constexpr (std::is_same_v<type_t, char>) return 'c';
+	else if constexpr (std::is_enum_v<type_t>) return std::is_signed_v<std::underlying_type_t<type_t>> ? 'i' : 'u';
+	else if constexpr (std::is_integral_v<type_t>) return std::is_signed_v<type_t> ? 'i' : 'u';
+	else if constexpr (std::is_floating_point_v<type_t>) return 'f';
+	else if constexpr (std::is_null_pointer_v<type_t>) return 'p';
+	else if constexpr (std::is_convertible_v<const type_t&, std::string_view>) return 's';
+	else if constexpr (std::is_pointer_v<type_t>) return 'p';
+	else return 0;
+}
+
+#define __WLOG_FMT_OK			0
+#define __WLOG_FMT_TOO_FEW		1
+#define __WLOG_FMT_TOO_MANY		2
+#define __WLOG_FMT_BAD_SPEC		3
+#define __WLOG_FMT_BAD_BRACE	4
+
+//一个占位符的说明符
+typedef struct __wlog_fmt_spec_t {
+	int nWidth;
+	int nPrecision;			//-1为没有指定
+	char chType;			//0为没有指定
+	bool bZero;
+} __wlog_fmt_spec_t;
+
+//解析"{"之后到"}"为止的说明符，返回"}"之后的位置，格式错误返回NULL
+constexpr const char* __wlog_fmt_parse_spec(const char* pFmt, __wlog_fmt_spec_t& spec) {
+	spec = __wlog_fmt_spec_t{0, -1, 0, false};
+	if (':' == *pFmt) {
+		++pFmt;
+		if ('0' == *pFmt) {
+			spec.bZero = true;
+			++pFmt;
+		}
+		for (; *pFmt >= '0' && *pFmt <= '9'; ++pFmt) spec.nWidth = spec.nWidth * 10 + (*pFmt - '0');
+		if ('.' == *pFmt) {
+			++pFmt;
+			if (*pFmt < '0' || *pFmt > '9') return NULL;
+			spec.nPrecision = 0;
+			for (; *pFmt >= '0' && *pFmt <= '9'; ++pFmt) spec.nPrecision = spec.nPrecision * 10 + (*pFmt - '0');
+		}
+		if (0 != *pFmt && '}' != *pFmt) spec.chType = *pFmt++;
+	}
+	return ('}' == *pFmt) ? pFmt + 1 : NULL;
+}
+
+//说明符能否用于这种参数
+constexpr bool __wlog_fmt_spec_match(const __wlog_fmt_spec_t& spec, char chKind) {
+	bool bNumber = ('i' == chKind || 'u' == chKind || 'f' == chKind || ('c' == chKind && 0 != spec.chType && 'c' != spec.chType));
+	if (spec.bZero && !bNumber) return false;
+	if (spec.nPrecision >= 0 && 'f' != chKind && 's' != chKind) return false;
+	switch (spec.chType) {
+	case 0:		return true;
+	case 'd':	return 'i' == chKind || 'u' == chKind || 'c' == chKind || 'b' == chKind;
+	case 'x':
+	case 'X':
+	case 'o':	return 'i' == chKind || 'u' == chKind || 'c' == chKind;
+	case 'f':
+	case 'e':
+	case 'g':	return 'f' == chKind;
+	case 's':	return 's' == chKind || 'b' == chKind;
+	case 'c':	return 'c' == chKind || 'i' == chKind || 'u' == chKind;
+	case 'p':	return 'p' == chKind;
+	default:	return false;
+	}
+}
+
+//编译时检查格式串，szKinds为各参数的种类
+constexpr int __wlog_fmt_check(const char* pFmt, const char* szKinds, size_t nArgs) {
+	size_t nArg = 0;
+	while (0 != *pFmt) {
+		if ('}' == *pFmt) {
+			if ('}' != pFmt[1]) return __WLOG_FMT_BAD_BRACE;
+			pFmt += 2;
+		} else if ('{' == *pFmt) {
+			if ('{' == pFmt[1]) {
+				pFmt += 2;
+				continue;
+			}
+			__wlog_fmt_spec_t spec{0, -1, 0, false};
+			pFmt = __wlog_fmt_parse_spec(pFmt + 1, spec);
+			if (NULL == pFmt) return __WLOG_FMT_BAD_SPEC;
+			if (nArg >= nArgs) return __WLOG_FMT_TOO_FEW;
+			if (!__wlog_fmt_spec_match(spec, szKinds[nArg])) return __WLOG_FMT_BAD_SPEC;
+			++nArg;
+		} else {
+			++pFmt;
+		}
+	}
+	return (nArg == nArgs) ? __WLOG_FMT_OK : __WLOG_FMT_TOO_MANY;
+}
+
+//每个线程一块可重用的缓冲，线程退出时释放
+typedef struct __wlog_fmt_buf_t {
+	char* pData;
+	size_t nLen;
+	size_t nCap;
+	~__wlog_fmt_buf_t() {
+		free(pData);
+	}
+} __wlog_fmt_buf_t;
+
+inline __wlog_fmt_buf_t* __wlog_fmt_tls() {
+	static thread_local __wlog_fmt_buf_t g_wlogFmtBuf = {NULL, 0, 0};
+	return &g_wlogFmtBuf;
+}
+
+//保证还能追加nMore字节，失败返回NULL，成功返回追加的位置
+inline char* __wlog_fmt_reserve(__wlog_fmt_buf_t* pBuf, size_t nMore) {
+	if (pBuf->nLen + nMore > pBuf->nCap) {
+		size_t nCap = pBuf->nCap ? pBuf->nCap : WLOG_FMT_BUFFER_SIZE;
+		while (nCap < pBuf->nLen + nMore) nCap *= 2;
+		char* pData = __wlog_arena_alloc(nCap, &nCap);
+		if (NULL == pData) return NULL;
+		if (pBuf->nLen > 0) memcpy(pData, pBuf->pData, pBuf->nLen);
+		__wlog_arena_free(pBuf->pData, pBuf->nCap);
+		pBuf->pData = pData;
+		pBuf->nCap = nCap;
+	}
+	return pBuf->pData + pBuf->nLen;
+}
+
+inline void __wlog_fmt_append(__wlog_fmt_buf_t* pBuf, const char* pData, size_t nLen) {
+	char* pOut = __wlog_fmt_reserve(pBuf, nLen);
+	if (NULL == pOut) return;
+	memcpy(pOut, pData, nLen);
+	pBuf->nLen += nLen;
+}
+
+//把刚追加的nStart之后的内容补齐到宽度，数字右对齐(0填充时补在符号之后)，其他左对齐
+inline void __wlog_fmt_pad(__wlog_fmt_buf_t* pBuf, size_t nStart, const __wlog_fmt_spec_t& spec, bool bNumber) {
+	size_t nLen = pBuf->nLen - nStart;
+	if (spec.nWidth <= 0 || nLen >= (size_t)spec.nWidth) return;
+	size_t nPad = (size_t)spec.nWidth - nLen;
+	if (NULL == __wlog_fmt_reserve(pBuf, nPad)) return;
+	char* pStart = pBuf->pData + nStart;
+	if (!bNumber) {
+		memset(pStart + nLen, ' ', nPad);
+	} else {
+		size_t nSign = (spec.bZero && ('-' == *pStart)) ? 1 : 0;
+		memmove(pStart + nSign + nPad, pStart + nSign, nLen - nSign);
+		memset(pStart + nSign, spec.bZero ? '0' : ' ', nPad);
+	}
+	pBuf->nLen += nPad;
+}
+
+template <typename T> inline void __wlog_fmt_integer(__wlog_fmt_buf_t* pBuf, T value, const __wlog_fmt_spec_t& spec) {
+	char* pOut = __wlog_fmt_reserve(pBuf, 72);
+	if (NULL == pOut) return;
+	int nBase = ('x' == spec.chType || 'X' == spec.chType) ? 16 : ('o' == spec.chType) ? 8 : 10;
+	std::to_chars_result result = std::to_chars(pOut, pOut + 72, value, nBase);
+	if ('X' == spec.chType) {
+		for (char* pChar = pOut; pChar < result.ptr; ++pChar) {
+			if (*pChar >= 'a' && *pChar <= 'f') *pChar = (char)(*pChar - 'a' + 'A');
+		}
+	}
+	pBuf->nLen += (size_t)(result.ptr - pOut);
+}
+
+inline void __wlog_fmt_float(__wlog_fmt_buf_t* pBuf, double value, const __wlog_fmt_spec_t& spec) {
+	size_t nMax = 32 + 330 + (spec.nPrecision > 0 ? (size_t)spec.nPrecision : 0);
+	char* pOut = __wlog_fmt_reserve(pBuf, nMax);
+	if (NULL == pOut) return;
+	#if defined(__cpp_lib_to_chars) && (__cpp_lib_to_chars >= 201611L)
+		std::to_chars_result result;
+		std::chars_format format = ('e' == spec.chType) ? std::chars_format::scientific
+			: ('g' == spec.chType) ? std::chars_format::general : std::chars_format::fixed;
+		if (spec.nPrecision >= 0) {
+			result = std::to_chars(pOut, pOut + nMax, value, format, spec.nPrecision);
+		} else if (0 == spec.chType) {
+			result = std::to_chars(pOut, pOut + nMax, value);
+		} else {
+			result = std::to_chars(pOut, pOut + nMax, value, format);
+		}
+		pBuf->nLen += (size_t)(result.ptr - pOut);
+	#else
+		//标准库还没有浮点的to_chars时退回snprintf
+		char szFormat[8] = {'%', '.', '*', (0 == spec.chType) ? 'g' : spec.chType, 0};
+		int nLen = snprintf(pOut, nMax, szFormat, (spec.nPrecision >= 0) ? spec.nPrecision : (0 == spec.chType ? 17 : 6), value);
+		if (nLen > 0) pBuf->nLen += ((size_t)nLen < nMax) ? (size_t)nLen : nMax - 1;
+	#endif
+}
+
+//输出一个参数
+template <typename T> inline void __wlog_fmt_arg(__wlog_fmt_buf_t* pBuf, const T& value, const __wlog_fmt_spec_t& spec) {
+	typedef std::remove_cv_t<std::remove_reference_t<T>> type_t;
+	constexpr char chKind = __wlog_fmt_kind<T>();
+	size_t nStart = pBuf->nLen;
+	bool bNumber = true;
+	if constexpr ('b' == chKind) {
+		if ('d' == spec.chType) {
+			__wlog_fmt_integer(pBuf, (int)value, spec);
+		} else {
+			__wlog_fmt_append(pBuf, value ? "true" : "false", value ? 4 : 5);
+			bNumber = false;
+		}
+	} else if constexpr ('c' == chKind) {
+		if (0 == spec.chType || 'c' == spec.chType) {
+			__wlog_fmt_append(pBuf, &value, 1);
+			bNumber = false;
+		} else {
+			__wlog_fmt_integer(pBuf, (int)(unsigned char)value, spec);
+		}
+	} else if constexpr ('i' == chKind || 'u' == chKind) {
+		if ('c' == spec.chType) {
+			char chValue = (char)value;
+			__wlog_fmt_append(pBuf, &chValue, 1);
+			bNumber = false;
+		} else if constexpr (std::is_enum_v<type_t>) {
+			__wlog_fmt_integer(pBuf, (std::underlying_type_t<type_t>)value, spec);
+		} else {
+			__wlog_fmt_integer(pBuf, value, spec);
+		}
+	} else if constexpr ('f' == chKind) {
+		__wlog_fmt_float(pBuf, (double)value, spec);
+	} else if constexpr ('s' == chKind) {
+		std::string_view strValue;
+		if constexpr (std::is_pointer_v<type_t>) {
+			strValue = (NULL == value) ? std::string_view("(null)") : std::string_view(value);
+		} else {
+			strValue = value;
+		}
+		if (spec.nPrecision >= 0 && strValue.size() > (size_t)spec.nPrecision) strValue = strValue.substr(0, (size_t)spec.nPrecision);
+		__wlog_fmt_append(pBuf, strValue.data(), strValue.size());
+		bNumber = false;
+	} else if constexpr ('p' == chKind) {
+		__wlog_fmt_append(pBuf, "0x", 2);
+		__wlog_fmt_spec_t specHex = {0, -1, 'x', false};
+		__wlog_fmt_integer(pBuf, (unsigned long)(uintptr_t)value, specHex);
+	}
+	__wlog_fmt_pad(pBuf, nStart, spec, bNumber);
+}
+
+//输出到下一个占位符为止的字面内容，返回占位符"{"之后的位置，已经到结尾返回NULL
+inline const char* __wlog_fmt_literal(__wlog_fmt_buf_t* pBuf, const char* pFmt) {
+	for (;;) {
+		const char* pBrace = pFmt + strcspn(pFmt, "{}");
+		__wlog_fmt_append(pBuf, pFmt, (size_t)(pBrace - pFmt));
+		if (0 == *pBrace) return NULL;
+		if (pBrace[1] == *pBrace) {
+			__wlog_fmt_append(pBuf, pBrace, 1);
+			pFmt = pBrace + 2;
+			continue;
+		}
+		return pBrace + 1;
+	}
+}
+
+inline void __wlog_fmt_render(__wlog_fmt_buf_t* pBuf, const char* pFmt) {
+	__wlog_fmt_literal(pBuf, pFmt);
+}
+template <typename T, typename... Args> inline void __wlog_fmt_render(__wlog_fmt_buf_t* pBuf, const char* pFmt, const T& value, const Args&... args) {
+	pFmt = __wlog_fmt_literal(pBuf, pFmt);
+	if (NULL == pFmt) return;
+	__wlog_fmt_spec_t spec{0, -1, 0, false};
+	pFmt = __wlog_fmt_parse_spec(pFmt, spec);
+	__wlog_fmt_arg(pBuf, value, spec);
+	__wlog_fmt_render(pBuf, pFmt, args...);
+}
+
+#if (WLOG_STATIC_TYPE_SWITCH&WLOG_TYPE_BASE) && (WLOG_STATIC_TYPE_SWITCH&WLOG_TYPE_TEXT)
+//Fmt为logBaseF里定义的局部类型，Fmt::str()是编译期的格式串
+template <typename Fmt, typename... Args> inline void __wlog_fmt_log(unsigned int nType, char chType, const char* szFile, int nLine, const Args&... args) {
+	constexpr char szKinds[] = {__wlog_fmt_kind<Args>()..., 1};
+	static_assert(((0 != __wlog_fmt_kind<Args>()) && ...), "logXXXF: unsupported argument type");
+	constexpr int nCheck = __wlog_fmt_check(Fmt::str(), szKinds, sizeof...(Args));
+	static_assert(__WLOG_FMT_TOO_FEW != nCheck, "logXXXF: more {} than arguments");
+	static_assert(__WLOG_FMT_TOO_MANY != nCheck, "logXXXF: more arguments than {}");
+	static_assert(__WLOG_FMT_BAD_SPEC != nCheck, "logXXXF: bad {:spec} or spec does not match the argument type");
+	static_assert(__WLOG_FMT_BAD_BRACE != nCheck, "logXXXF: unmatched '}', use '}}'");
+	__wlog_fmt_buf_t* pBuf = __wlog_fmt_tls();
+	pBuf->nLen = 0;
+#if WLOG_JSON
+	//JSON模式只格式化消息本身，其余字段由wlog_json.h编码
+	(void)chType;
+	__wlog_fmt_render(pBuf, Fmt::str(), args...);
+	__wlog_json_write_imp(nType, szFile, nLine, NULL, 0, pBuf->pData, pBuf->nLen, NULL, 0);
+#else
+	char* pOut = __wlog_fmt_reserve(pBuf, WLOG_TIME_BUFFER_SIZE + 8);
+	if (NULL == pOut) return;
+	__wlog_format_time_imp(pOut, WLOG_TIME_BUFFER_SIZE);
+	pBuf->nLen = strlen(pOut);
+	char szType[4] = {' ', chType, ' ', 0};
+	__wlog_fmt_append(pBuf, szType, 3);
+	__wlog_fmt_append(pBuf, szFile, strlen(szFile));
+	__wlog_fmt_append(pBuf, ":", 1);
+	__wlog_fmt_spec_t specLine = {4, -1, 0, false};
+	size_t nStart = pBuf->nLen;
+	__wlog_fmt_integer(pBuf, nLine, specLine);
+	__wlog_fmt_pad(pBuf, nStart, specLine, false);
+	__wlog_fmt_append(pBuf, "| ", 2);
+	__wlog_fmt_render(pBuf, Fmt::str(), args...);
+	__wlog_fmt_append(pBuf, "\n", 1);
+	__wlog_write_record_imp(nType, pBuf->pData, pBuf->nLen);
+#endif
+	if (pBuf->nCap > WLOG_FMT_BUFFER_SIZE * 64) {
+		//偶尔一条特别长的日志不要一直占着内存，还给缓冲池，下一条长日志还能用
+		__wlog_arena_free(pBuf->pData, pBuf->nCap);
+		pBuf->pData = NULL;
+		pBuf->nCap = 0;
+	}
+}
+
+	#define logBaseF(nType, chType, format, args...) do {\
+		WLOG_DYNAMIC_CHECK(nType);\
+		WLOG_SITE_DEFINE(nType, chType, format);\
+		struct __wlog_fmt_str_t { static constexpr const char* str() { return format; } };\
+		WLOG_FLIGHT_CHECK(nType);\
+		WLOG_STATS_BEGIN();\
+		WLOG_DYNAMIC_CHECK_TEXT __wlog_fmt_log<__wlog_fmt_str_t>(nType, chType, WLOG_SITE_FILE, __LINE__, ##args);\
+		WLOG_STATS_END(nType);\
+		WLOG_ASYNC_DRAIN_CHECK(nType);\
+	} while (0)
+#else
+	#define logBaseF(nType, chType, format, args...)
+#endif
+
+#if (WLOG_STATIC_TYPE_SWITCH&WLOG_TYPE_TRACE)
+	#define logTraceF(format, args...) logBaseF(WLOG_TYPE_TRACE, 'T', format, ##args)
+#else
+	#define logTraceF(format, args...)
+#endif
+#if (WLOG_STATIC_TYPE_SWITCH&WLOG_TYPE_DEBUG)
+	#define logDebugF(format, args...) logBaseF(WLOG_TYPE_DEBUG, 'D', format, ##args)
+#else
+	#define logDebugF(format, args...)
+#endif
+#if (WLOG_STATIC_TYPE_SWITCH&WLOG_TYPE_INFO)
+	#define logInfoF(format, args...) logBaseF(WLOG_TYPE_INFO, 'I', format, ##args)
+#else
+	#define logInfoF(format, args...)
+#endif
+#if (WLOG_STATIC_TYPE_SWITCH&WLOG_TYPE_NOTICE)
+	#define logNoticeF(format, args...) logBaseF(WLOG_TYPE_NOTICE, 'N', format, ##args)
+#else
+	#define logNoticeF(format, args...)
+#endif
+#if (WLOG_STATIC_TYPE_SWITCH&WLOG_TYPE_WARNING)
+	#define logWarningF(format, args...) logBaseF(WLOG_TYPE_WARNING, 'W', format, ##args)
+#else
+	#define logWarningF(format, args...)
+#endif
+#if (WLOG_STATIC_TYPE_SWITCH&WLOG_TYPE_ERROR)
+	#define logErrorF(format, args...) logBaseF(WLOG_TYPE_ERROR, 'E', format, ##args)
+#else
+	#define logErrorF(format, args...)
+#endif
+#if (WLOG_STATIC_TYPE_SWITCH&WLOG_TYPE_FATAL)
+	#define logFatalF(format, args...) logBaseF(WLOG_TYPE_FATAL, 'F', format, ##args)
+#else
+	#define logFatalF(format, args...)
+#endif
+
+#endif //__WLOG_FMT_H__
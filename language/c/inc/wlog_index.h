@@ -0,0 +1,339 @@
+#ifndef __WLOG_INDEX_H__
+#define __WLOG_INDEX_H__
+/**
+ * @file wlog_index.h
+ * @brief WLOG_INDEX日志文件的稀疏索引，由wlog_file.h在WLOG_INDEX为1时自动包含；tools/wlog_query单独include它取得格式定义.
+ * <pre>写文件时每写出一段日志就顺便扫一遍各行开头的日志头，记下条数、时间范围与出现过的级别字符，
+        每满WLOG_INDEX_RECORDS条或WLOG_INDEX_BYTES字节写一条索引到WLOG_FILE_NAME.idx，
+        异步写线程一次写出的一批也在日志头处按这两个上限切成几块，
+        查询时用tools/wlog_query按时间二分定位、跳过没有所要级别的块，只扫剩下的部分：
+            ./wlog_query -f "10-17 18:00" -t "10-17 18:05:30" -l EW -s "timeout" w.log
+        日志头是文本模式的"MM-DD HH:MM:SS.mmm X "或WLOG_JSON的{"ts":"...","level":"..."，其他行算作前一条日志的一部分。
+        文本日志的时间不带年份，索引里的时间也只到月日：((((月 * 32 + 日) * 24 + 时) * 60 + 分) * 60 + 秒) * 1000000 + 微秒，
+        跨年的文件按月日比较。文件格式(本机字节序)：
+            文件头 32字节： "WLOGIDX1" u32 索引项大小(40) u32 保留 u64 日志文件的st_dev u64 日志文件的st_ino
+            索引项 40字节： u64 块在日志文件里的偏移 u64 块长度 u64 最早时间 u64 最晚时间 u32 日志条数 u32 级别位图
+        级别位图的第0~25位是'A'~'Z'，第26位是其他字符；块里没有日志头时最早时间为全1、最晚时间为0。
+        同步模式下写文件与取得偏移在一个锁里，多个进程写同一个文件时各自的块也不会错位；异步模式只有写线程写文件。
+        索引没有覆盖的部分(文件开头的标记行、进程崩溃时还没写索引的最后一块、其他程序写进去的内容)查询时总是扫描。
+        打开日志文件时索引文件不是这个文件的(st_dev、st_ino不同)或比日志文件长，就清空重建。
+        只支持linux下WLOG_TO_FILE的文本与JSON输出，不能与WLOG_BINARY、WLOG_ROTATE_XXX同时使用，文件不是普通文件(管道等)时不写索引。
+        可在include <wlog.h>之前修改的“宏”配置：
+		1. WLOG_INDEX，是否写索引，默认0
+		2. WLOG_INDEX_RECORDS，每块最多的日志条数，默认1024
+		3. WLOG_INDEX_BYTES，每块最多的字节数，默认256K
+	</pre>
+ * @os linux
+ */
+#include <stdint.h>
+#include <string.h>
+
+#define WLOG_INDEX_MAGIC	"WLOGIDX1"
+#define WLOG_INDEX_SUFFIX	".idx"
+#define WLOG_INDEX_OTHER	26	//不是'A'~'Z'的级别字符
+
+typedef struct __wlog_index_head_t {
+	char szMagic[8];
+	uint32_t nEntrySize;
+	uint32_t nReserved;
+	uint64_t nDev;
+	uint64_t nIno;
+} __wlog_index_head_t;
+
+typedef struct __wlog_index_entry_t {
+	uint64_t nOffset;
+	uint64_t nLength;
+	uint64_t nTimeMin;
+	uint64_t nTimeMax;
+	uint32_t nRecords;
+	uint32_t nLevels;
+} __wlog_index_entry_t;
+
+inline uint32_t __wlog_index_level_bit(char chLevel) {
+	return (chLevel >= 'A' && chLevel <= 'Z') ? (1u << (chLevel - 'A')) : (1u << WLOG_INDEX_OTHER);
+}
+
+inline void __wlog_index_entry_init(__wlog_index_entry_t* pEntry, uint64_t nOffset) {
+	pEntry->nOffset = nOffset;
+	pEntry->nLength = 0;
+	pEntry->nTimeMin = (uint64_t)-1;
+	pEntry->nTimeMax = 0;
+	pEntry->nRecords = 0;
+	pEntry->nLevels = 0;
+}
+
+//读nCount位十进制数，不是数字返回-1
+inline int __wlog_index_digits(const char* p, int nCount) {
+	int nValue = 0;
+	int nIdx = 0;
+	for (; nIdx < nCount; ++nIdx) {
+		if (p[nIdx] < '0' || p[nIdx] > '9') return -1;
+		nValue = nValue * 10 + (p[nIdx] - '0');
+	}
+	return nValue;
+}
+
+//解析p开头的"MM-DD HH:MM:SS[.f...]"，nSep为日期与时间之间的字符，返回用掉的长度，不是时间返回0
+inline size_t __wlog_index_parse_time(const char* p, size_t nLen, char chSep, uint64_t* pKey) {
+	if (nLen < 14 || '-' != p[2] || chSep != p[5] || ':' != p[8] || ':' != p[11]) return 0;
+	int nMonth = __wlog_index_digits(p, 2), nDay = __wlog_index_digits(p + 3, 2);
+	int nHour = __wlog_index_digits(p + 6, 2), nMinute = __wlog_index_digits(p + 9, 2), nSecond = __wlog_index_digits(p + 12, 2);
+	if (nMonth < 1 || nMonth > 12 || nDay < 1 || nDay > 31 || nHour < 0 || nHour > 23 || nMinute < 0 || nMinute > 59 || nSecond < 0 || nSecond > 60) return 0;
+	size_t nPos = 14;
+	uint32_t nMicro = 0;
+	if (nPos < nLen && '.' == p[nPos]) {
+		uint32_t nScale = 100000;
+		for (++nPos; nPos < nLen && p[nPos] >= '0' && p[nPos] <= '9'; ++nPos) {
+			nMicro += (uint32_t)(p[nPos] - '0') * nScale;
+			nScale /= 10;
+		}
+	}
+	*pKey = (((((uint64_t)nMonth * 32 + nDay) * 24 + nHour) * 60 + nMinute) * 60 + nSecond) * 1000000 + nMicro;
+	return nPos;
+}
+
+//解析一行开头的日志头，返回级别字符，*pKey为时间；不是日志头返回0
+inline char __wlog_index_parse_head(const char* p, size_t nLen, uint64_t* pKey) {
+	if ('{' == p[0]) {
+		//{"ts":"2026-10-17T18:10:01.165+08:00","level":"INFO"
+		if (nLen < 12 || 0 != memcmp(p, "{\"ts\":\"", 7) || '-' != p[11]) return 0;
+		size_t nPos = 12;
+		size_t nTime = __wlog_index_parse_time(p + nPos, nLen - nPos, 'T', pKey);
+		if (0 == nTime) return 0;
+		nPos += nTime;
+		while (nPos < nLen && '"' != p[nPos] && nPos < 48) ++nPos;
+		if (nPos + 12 > nLen || 0 != memcmp(p + nPos, "\",\"level\":\"", 11)) return 0;
+		return p[nPos + 11];
+	}
+	//MM-DD HH:MM:SS.mmm X file:line|
+	size_t nPos = __wlog_index_parse_time(p, nLen, ' ', pKey);
+	if (0 == nPos || nPos + 3 > nLen || ' ' != p[nPos] || ' ' == p[nPos + 1] || ' ' != p[nPos + 2]) return 0;
+	return p[nPos + 1];
+}
+
+//扫描p开头的一行，是日志头时把条数、时间、级别累加到pEntry，返回这一行的长度(含'\n')
+inline size_t __wlog_index_scan_line(__wlog_index_entry_t* pEntry, const char* p, size_t nLen) {
+	uint64_t nKey = 0;
+	char chLevel = __wlog_index_parse_head(p, nLen, &nKey);
+	if (0 != chLevel) {
+		++pEntry->nRecords;
+		pEntry->nLevels |= __wlog_index_level_bit(chLevel);
+		if (nKey < pEntry->nTimeMin) pEntry->nTimeMin = nKey;
+		if (nKey > pEntry->nTimeMax) pEntry->nTimeMax = nKey;
+	}
+	const char* pLf = (const char*)memchr(p, '\n', nLen);
+	return (NULL == pLf) ? nLen : (size_t)(pLf + 1 - p);
+}
+
+//扫描一段完整的日志，把条数、时间范围、级别累加到pEntry
+inline void __wlog_index_scan(__wlog_index_entry_t* pEntry, const char* pData, size_t nLen) {
+	const char* p = pData;
+	const char* pEnd = pData + nLen;
+	while (p < pEnd) {
+		p += __wlog_index_scan_line(pEntry, p, (size_t)(pEnd - p));
+	}
+}
+
+//以下是写日志一侧，只在wlog.h里用到
+#ifdef __WLOG_H__
+#if WLOG_BINARY
+	#error "WLOG_INDEX can't be used with WLOG_BINARY!"
+#endif
+#if (WLOG_ROTATE_SIZE > 0) || (WLOG_ROTATE_INTERVAL_SEC > 0)
+	#error "WLOG_INDEX can't be used with WLOG_ROTATE_XXX!"
+#endif
+
+#include <pthread.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#ifndef WLOG_INDEX_RECORDS
+	#define WLOG_INDEX_RECORDS 1024
+#endif
+#ifndef WLOG_INDEX_BYTES
+	#define WLOG_INDEX_BYTES (256 * 1024)
+#endif
+
+//nEnd是已记进索引的最后一段日志在文件里的结束位置，块只由首尾相接的日志组成
+typedef struct __wlog_index_ctx_t {
+	pthread_mutex_t hMutex;
+	int hFd;
+	uint64_t nEnd;
+	__wlog_index_entry_t block;
+} __wlog_index_ctx_t;
+
+inline __wlog_index_ctx_t* __wlog_index_ctx() {
+	static __wlog_index_ctx_t g_wlogIndexCtx = {PTHREAD_MUTEX_INITIALIZER, -1, 0, {0, 0, 0, 0, 0, 0}};
+	return &g_wlogIndexCtx;
+}
+
+//索引文件打开后才为真，打开日志文件之前不会写日志，所以不需要加锁
+inline int __wlog_index_active() {
+	return __atomic_load_n(&__wlog_index_ctx()->hFd, __ATOMIC_ACQUIRE) >= 0;
+}
+
+//调用者持有hMutex：写出当前块，再从nOffset开始新的一块
+inline void __wlog_index_emit_locked_imp(__wlog_index_ctx_t* pCtx, uint64_t nOffset) {
+	if (pCtx->block.nLength > 0) {
+		if (write(pCtx->hFd, &pCtx->block, sizeof(pCtx->block)) != (ssize_t)sizeof(pCtx->block)) {
+			//写不进索引，这一块查询时当作没有索引的部分扫描
+		}
+	}
+	__wlog_index_entry_init(&pCtx->block, nOffset);
+}
+
+//调用者持有hMutex：长nLen、已扫描成pSum的一段日志写到了文件里nEnd之前，nEnd为-1表示紧接在上一段后面；
+//只累加，块满时由__wlog_index_feed_locked_imp在下一个日志头处写出
+inline void __wlog_index_add_locked_imp(const __wlog_index_entry_t* pSum, size_t nLen, uint64_t nEnd) {
+	__wlog_index_ctx_t* pCtx = __wlog_index_ctx();
+	if (pCtx->hFd < 0) return;
+	if ((uint64_t)-1 == nEnd) nEnd = pCtx->nEnd + nLen;
+	uint64_t nStart = nEnd - nLen;
+	if (nStart != pCtx->block.nOffset + pCtx->block.nLength) {
+		__wlog_index_emit_locked_imp(pCtx, nStart);
+	}
+	__wlog_index_entry_t* pBlock = &pCtx->block;
+	pBlock->nLength += nLen;
+	pBlock->nRecords += pSum->nRecords;
+	pBlock->nLevels |= pSum->nLevels;
+	if (pSum->nTimeMin < pBlock->nTimeMin) pBlock->nTimeMin = pSum->nTimeMin;
+	if (pSum->nTimeMax > pBlock->nTimeMax) pBlock->nTimeMax = pSum->nTimeMax;
+	pCtx->nEnd = nEnd;
+}
+
+//pSum加进当前块后还不到WLOG_INDEX_RECORDS条、WLOG_INDEX_BYTES字节，整段一起累加即可，不用逐行扫描
+inline int __wlog_index_fits_locked_imp(const __wlog_index_entry_t* pSum, size_t nLen) {
+	const __wlog_index_entry_t* pBlock = &__wlog_index_ctx()->block;
+	return pBlock->nRecords + pSum->nRecords < WLOG_INDEX_RECORDS && pBlock->nLength + nLen < WLOG_INDEX_BYTES;
+}
+
+inline void __wlog_index_feed_end_locked_imp(const __wlog_index_entry_t* pPart) {
+	if (pPart->nLength > 0) __wlog_index_add_locked_imp(pPart, (size_t)pPart->nLength, (uint64_t)-1);
+}
+
+//调用者持有hMutex：逐行扫描紧接在上一段后面的pData，累加到还没记进块的pPart(nLength为它的长度)；
+//当前块加上pPart满了WLOG_INDEX_RECORDS条或WLOG_INDEX_BYTES字节时，在下一个日志头之前把pPart记进块并写出这一块，
+//一批多条日志就按条数、字节数切成几块。块只在日志头处结束：pData可以只是一条日志的一部分(占多个槽位的长日志)，
+//满了的块留到下一个日志头或退出时再写出，续行不会和它的日志头分到两块；最后用__wlog_index_feed_end_locked_imp收尾
+inline void __wlog_index_feed_locked_imp(__wlog_index_entry_t* pPart, const char* pData, size_t nLen) {
+	__wlog_index_ctx_t* pCtx = __wlog_index_ctx();
+	const char* p = pData;
+	const char* pEnd = pData + nLen;
+	while (p < pEnd) {
+		uint64_t nKey = 0;
+		if ((pCtx->block.nRecords + pPart->nRecords >= WLOG_INDEX_RECORDS || pCtx->block.nLength + pPart->nLength >= WLOG_INDEX_BYTES)
+			&& 0 != __wlog_index_parse_head(p, (size_t)(pEnd - p), &nKey)) {
+			__wlog_index_feed_end_locked_imp(pPart);
+			__wlog_index_entry_init(pPart, 0);
+			__wlog_index_emit_locked_imp(pCtx, pCtx->nEnd);
+		}
+		size_t nLine = __wlog_index_scan_line(pPart, p, (size_t)(pEnd - p));
+		pPart->nLength += nLine;
+		p += nLine;
+	}
+}
+
+//调用者持有hMutex：长nLen、已扫描成pSum的pData写到了文件里nEnd之前(-1表示紧接在上一段后面)，
+//放得进当前块时整段累加，否则重新逐行扫描切开
+inline void __wlog_index_add_data_locked_imp(const __wlog_index_entry_t* pSum, const char* pData, size_t nLen, uint64_t nEnd) {
+	__wlog_index_ctx_t* pCtx = __wlog_index_ctx();
+	if (pCtx->hFd < 0) return;
+	if ((uint64_t)-1 == nEnd) nEnd = pCtx->nEnd + nLen;
+	if (nEnd - nLen != pCtx->block.nOffset + pCtx->block.nLength) {
+		__wlog_index_emit_locked_imp(pCtx, nEnd - nLen);
+	}
+	if (__wlog_index_fits_locked_imp(pSum, nLen)) {
+		__wlog_index_add_locked_imp(pSum, nLen, nEnd);
+		return;
+	}
+	__wlog_index_entry_t part;
+	__wlog_index_entry_init(&part, 0);
+	pCtx->nEnd = nEnd - nLen;
+	__wlog_index_feed_locked_imp(&part, pData, nLen);
+	__wlog_index_feed_end_locked_imp(&part);
+}
+
+inline void __wlog_index_lock_imp() {
+	pthread_mutex_lock(&__wlog_index_ctx()->hMutex);
+}
+inline void __wlog_index_unlock_imp() {
+	pthread_mutex_unlock(&__wlog_index_ctx()->hMutex);
+}
+
+//异步模式的写线程：扫描刚写出的一段，它紧接在上一段后面
+inline void __wlog_index_append_imp(const char* pData, size_t nLen) {
+	if (!__wlog_index_active()) return;
+	__wlog_index_entry_t sum;
+	__wlog_index_entry_init(&sum, 0);
+	__wlog_index_scan(&sum, pData, nLen);
+	__wlog_index_lock_imp();
+	__wlog_index_add_data_locked_imp(&sum, pData, nLen, (uint64_t)-1);
+	__wlog_index_unlock_imp();
+}
+
+//异步模式写文件失败时不知道写进去了多少，写出当前块后不再写索引，之后的部分查询时整段扫描
+inline void __wlog_index_stop_imp() {
+	__wlog_index_ctx_t* pCtx = __wlog_index_ctx();
+	if (!__wlog_index_active()) return;
+	__wlog_index_lock_imp();
+	__wlog_index_emit_locked_imp(pCtx, 0);
+	close(pCtx->hFd);
+	__atomic_store_n(&pCtx->hFd, -1, __ATOMIC_RELEASE);
+	__wlog_index_unlock_imp();
+}
+
+//退出时写出最后一块，由写文件的模块在写出所有缓冲之后调用
+inline void __wlog_index_flush_imp() {
+	__wlog_index_ctx_t* pCtx = __wlog_index_ctx();
+	if (!__wlog_index_active()) return;
+	__wlog_index_lock_imp();
+	__wlog_index_emit_locked_imp(pCtx, pCtx->block.nOffset + pCtx->block.nLength);
+	__wlog_index_unlock_imp();
+}
+
+//打开日志文件后调用：打开WLOG_FILE_NAME.idx，不属于这个日志文件时清空重建
+inline void __wlog_index_open_imp(int hLogFd) {
+	__wlog_index_ctx_t* pCtx = __wlog_index_ctx();
+	struct stat stLog;
+	if (0 != fstat(hLogFd, &stLog) || !S_ISREG(stLog.st_mode)) return;
+	char szName[PATH_MAX];
+	if (snprintf(szName, sizeof(szName), "%s" WLOG_INDEX_SUFFIX, WLOG_FILE_NAME) >= (int)sizeof(szName)) return;
+	int hFd = open(szName, O_RDWR | O_APPEND | O_CREAT | O_CLOEXEC, 0666);
+	if (hFd < 0) return;
+	__wlog_index_head_t head;
+	struct stat stIndex;
+	int bReset = (0 != fstat(hFd, &stIndex)) || (pread(hFd, &head, sizeof(head), 0) != (ssize_t)sizeof(head))
+		|| 0 != memcmp(head.szMagic, WLOG_INDEX_MAGIC, 8) || head.nEntrySize != sizeof(__wlog_index_entry_t)
+		|| head.nDev != (uint64_t)stLog.st_dev || head.nIno != (uint64_t)stLog.st_ino;
+	if (!bReset) {
+		//去掉崩溃时写了一半的索引项；最后一项超出日志文件说明日志被截断过
+		off_t nEntries = (stIndex.st_size - (off_t)sizeof(head)) / (off_t)sizeof(__wlog_index_entry_t);
+		off_t nWhole = (off_t)sizeof(head) + nEntries * (off_t)sizeof(__wlog_index_entry_t);
+		if (nWhole != stIndex.st_size && 0 != ftruncate(hFd, nWhole)) bReset = 1;
+		__wlog_index_entry_t last;
+		if (nEntries > 0 && (pread(hFd, &last, sizeof(last), nWhole - (off_t)sizeof(last)) != (ssize_t)sizeof(last)
+			|| last.nOffset + last.nLength > (uint64_t)stLog.st_size)) {
+			bReset = 1;
+		}
+	}
+	if (bReset) {
+		memset(&head, 0, sizeof(head));
+		memcpy(head.szMagic, WLOG_INDEX_MAGIC, 8);
+		head.nEntrySize = sizeof(__wlog_index_entry_t);
+		head.nDev = (uint64_t)stLog.st_dev;
+		head.nIno = (uint64_t)stLog.st_ino;
+		if (0 != ftruncate(hFd, 0) || write(hFd, &head, sizeof(head)) != (ssize_t)sizeof(head)) {
+			close(hFd);
+			return;
+		}
+	}
+	pCtx->nEnd = (uint64_t)stLog.st_size;
+	__wlog_index_entry_init(&pCtx->block, pCtx->nEnd);
+	__atomic_store_n(&pCtx->hFd, hFd, __ATOMIC_RELEASE);
+}
+#endif //__WLOG_H__
+
+#endif //__WLOG_INDEX_H__
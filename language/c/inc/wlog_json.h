@@ -0,0 +1,488 @@
+#ifndef __WLOG_JSON_H__
+#define __WLOG_JSON_H__
+/**
+ * @file wlog_json.h
+ * @brief WLOG_JSON结构化输出与logXXXKV键值对，由wlog.h在linux用户态自动包含，不要单独include.
+ * <pre>WLOG_JSON定义成1后logBase系列每条日志输出成一行JSON，字段类型固定，日志收集端不用再正则解析：
+            {"ts":"2026-10-17T18:10:01.165+08:00","level":"INFO","file":"main.cpp","line":12,"tid":1234,"msg":"login ok","user":42}
+        ts的秒以下位数与WLOG_TIME_PRECISION相同；logXXXN的数据放在"data"字段里，不再有[START]、[E.N.D]两行；
+        logText、logTextN仍原样输出，JSON模式下不要用它们。不能与WLOG_BINARY同时使用。
+        字符串按JSON转义(SSE2每次扫描16字节)，整条日志在栈上的WLOG_JSON_RECORD_SIZE缓冲里编码，
+        不分配内存，超长时截断msg或data并加上"truncated":true，截断不会切开UTF-8字符。字符串原样按UTF-8输出。
+        C++11以上还可以用logXXXKV在调用点附带键值对，第一个参数是用括号括起来的"键, 值"列表：
+            logInfoKV(("user", nUserId, "ip", szIp, "cost", fCostMs), "login %s", szName);
+        值可以是整数、浮点、bool、char*、std::string，最多WLOG_KV_MAX对。
+        JSON模式下键值对是顶层字段，文本模式下以" user=42 ip=..."接在日志后面。
+        可在include <wlog.h>之前修改的“宏”配置：
+		1. WLOG_JSON，是否输出JSON，默认0
+		2. WLOG_JSON_RECORD_SIZE，单条JSON日志最大长度，默认4096
+		3. WLOG_KV_MAX，logXXXKV最多的键值对个数，默认16
+	</pre>
+ * @os linux
+ */
+#if WLOG_JSON && WLOG_BINARY
+	#error "WLOG_JSON can't be used with WLOG_BINARY!"
+#endif
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#if defined(__SSE2__)
+	#include <emmintrin.h>
+#endif
+
+#ifndef WLOG_JSON_RECORD_SIZE
+	#define WLOG_JSON_RECORD_SIZE 4096
+#endif
+#ifndef WLOG_KV_MAX
+	#define WLOG_KV_MAX 16
+#endif
+
+//留给",\"truncated\":true}\n"
+#define __WLOG_JSON_TAIL 24
+
+//一个键值对，chKind：'i' 有符号整数，'u' 无符号整数，'f' 浮点，'b' bool，'s' 字符串
+typedef struct __wlog_kv_t {
+	const char* szKey;
+	char chKind;
+	size_t nLen;
+	union {
+		long long i;
+		unsigned long long u;
+		double f;
+		const char* s;
+	} value;
+} __wlog_kv_t;
+
+typedef struct __wlog_json_out_t {
+	char* pCur;
+	char* pEnd;
+	int bTruncated;
+} __wlog_json_out_t;
+
+//需要转义的字节：控制字符、'"'、'\\'
+inline int __wlog_json_special(unsigned char chByte) {
+	return chByte < 0x20 || chByte == '"' || chByte == '\\';
+}
+
+//返回第一个需要转义的字节的下标，没有返回nLen
+inline size_t __wlog_json_scan(const unsigned char* pIn, size_t nLen) {
+	size_t nIdx = 0;
+	#if defined(__SSE2__)
+		const __m128i vQuote = _mm_set1_epi8('"');
+		const __m128i vSlash = _mm_set1_epi8('\\');
+		const __m128i vControl = _mm_set1_epi8(0x1F);
+		for (; nIdx + 16 <= nLen; nIdx += 16) {
+			__m128i vIn = _mm_loadu_si128((const __m128i*)(pIn + nIdx));
+			__m128i vHit = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(vIn, vQuote), _mm_cmpeq_epi8(vIn, vSlash)),
+				_mm_cmpeq_epi8(_mm_max_epu8(vIn, vControl), vControl));
+			int nMask = _mm_movemask_epi8(vHit);
+			if (0 != nMask) return nIdx + (size_t)__builtin_ctz((unsigned int)nMask);
+		}
+	#endif
+	for (; nIdx < nLen; ++nIdx) {
+		if (__wlog_json_special(pIn[nIdx])) return nIdx;
+	}
+	return nLen;
+}
+
+inline int __wlog_json_raw(__wlog_json_out_t* pOut, const char* pData, size_t nLen) {
+	if ((size_t)(pOut->pEnd - pOut->pCur) < nLen) {
+		pOut->bTruncated = 1;
+		return 0;
+	}
+	memcpy(pOut->pCur, pData, nLen);
+	pOut->pCur += nLen;
+	return 1;
+}
+
+//写带引号的转义字符串，最多用到pEnd - nReserve，放不下时在UTF-8字符边界截断，返回0
+inline int __wlog_json_string(__wlog_json_out_t* pOut, const char* pData, size_t nLen, size_t nReserve) {
+	const unsigned char* pIn = (const unsigned char*)pData;
+	if ((size_t)(pOut->pEnd - pOut->pCur) < nReserve + 2) {
+		pOut->bTruncated = 1;
+		return 0;
+	}
+	char* pLimit = pOut->pEnd - nReserve - 1;
+	char* pCur = pOut->pCur;
+	*pCur++ = '"';
+	size_t nIdx = 0;
+	int bDone = 1;
+	while (nIdx < nLen) {
+		size_t nRun = __wlog_json_scan(pIn + nIdx, nLen - nIdx);
+		if (nRun > (size_t)(pLimit - pCur)) {
+			nRun = (size_t)(pLimit - pCur);
+			while (nRun > 0 && 0x80 == (pIn[nIdx + nRun] & 0xC0)) --nRun;
+			memcpy(pCur, pIn + nIdx, nRun);
+			pCur += nRun;
+			bDone = 0;
+			break;
+		}
+		memcpy(pCur, pIn + nIdx, nRun);
+		pCur += nRun;
+		nIdx += nRun;
+		if (nIdx == nLen) break;
+		unsigned char chByte = pIn[nIdx];
+		char szEscape[6] = {'\\', 0, 0, 0, 0, 0};
+		size_t nEscape = 2;
+		switch (chByte) {
+		case '"':	szEscape[1] = '"'; break;
+		case '\\':	szEscape[1] = '\\'; break;
+		case '\n':	szEscape[1] = 'n'; break;
+		case '\r':	szEscape[1] = 'r'; break;
+		case '\t':	szEscape[1] = 't'; break;
+		case '\b':	szEscape[1] = 'b'; break;
+		case '\f':	szEscape[1] = 'f'; break;
+		default:
+			szEscape[1] = 'u';
+			szEscape[2] = '0';
+			szEscape[3] = '0';
+			szEscape[4] = "0123456789abcdef"[chByte >> 4];
+			szEscape[5] = "0123456789abcdef"[chByte & 0x0F];
+			nEscape = 6;
+			break;
+		}
+		if (nEscape > (size_t)(pLimit - pCur)) {
+			bDone = 0;
+			break;
+		}
+		memcpy(pCur, szEscape, nEscape);
+		pCur += nEscape;
+		++nIdx;
+	}
+	*pCur++ = '"';
+	pOut->pCur = pCur;
+	if (!bDone) pOut->bTruncated = 1;
+	return bDone;
+}
+
+//写",\"key\":"，key一般是字面量
+inline int __wlog_json_key(__wlog_json_out_t* pOut, const char* szKey) {
+	return __wlog_json_raw(pOut, ",", 1) && __wlog_json_string(pOut, szKey, strlen(szKey), __WLOG_JSON_TAIL) && __wlog_json_raw(pOut, ":", 1);
+}
+
+inline size_t __wlog_json_u64(char* pOut, unsigned long long nValue) {
+	char szDigits[20];
+	size_t nLen = 0;
+	do {
+		szDigits[nLen++] = (char)('0' + nValue % 10);
+		nValue /= 10;
+	} while (0 != nValue);
+	size_t nIdx = 0;
+	for (; nIdx < nLen; ++nIdx) pOut[nIdx] = szDigits[nLen - 1 - nIdx];
+	return nLen;
+}
+
+inline size_t __wlog_json_i64(char* pOut, long long nValue) {
+	if (nValue >= 0) return __wlog_json_u64(pOut, (unsigned long long)nValue);
+	*pOut = '-';
+	return 1 + __wlog_json_u64(pOut + 1, 0ULL - (unsigned long long)nValue);
+}
+
+//一个键值对整体写入，放不下就整个不写
+inline void __wlog_json_kv(__wlog_json_out_t* pOut, const __wlog_kv_t* pKv) {
+	char* pMark = pOut->pCur;
+	char szNumber[32];
+	size_t nNumber = 0;
+	int bOk = __wlog_json_key(pOut, pKv->szKey);
+	switch (pKv->chKind) {
+	case 'i':	nNumber = __wlog_json_i64(szNumber, pKv->value.i); break;
+	case 'u':	nNumber = __wlog_json_u64(szNumber, pKv->value.u); break;
+	case 'b':	nNumber = pKv->value.i ? 4 : 5; memcpy(szNumber, pKv->value.i ? "true" : "false", nNumber); break;
+	case 'f':
+		if (isfinite(pKv->value.f)) {
+			nNumber = (size_t)snprintf(szNumber, sizeof(szNumber), "%.17g", pKv->value.f);
+		} else {
+			nNumber = 4;
+			memcpy(szNumber, "null", 4);
+		}
+		break;
+	default:
+		break;
+	}
+	if (bOk && 's' == pKv->chKind) {
+		bOk = (NULL == pKv->value.s) ? __wlog_json_raw(pOut, "null", 4) : __wlog_json_string(pOut, pKv->value.s, pKv->nLen, __WLOG_JSON_TAIL);
+	} else if (bOk) {
+		bOk = ((size_t)(pOut->pEnd - pOut->pCur) >= nNumber + __WLOG_JSON_TAIL) && __wlog_json_raw(pOut, szNumber, nNumber);
+	}
+	if (!bOk) {
+		pOut->pCur = pMark;
+		pOut->bTruncated = 1;
+	}
+}
+
+inline const char* __wlog_json_level(unsigned int nType) {
+	switch (nType) {
+	case WLOG_TYPE_TEXT:	return "TEXT";
+	case WLOG_TYPE_TRACE:	return "TRACE";
+	case WLOG_TYPE_DEBUG:	return "DEBUG";
+	case WLOG_TYPE_INFO:	return "INFO";
+	case WLOG_TYPE_NOTICE:	return "NOTICE";
+	case WLOG_TYPE_WARNING:	return "WARNING";
+	case WLOG_TYPE_ERROR:	return "ERROR";
+	case WLOG_TYPE_VERIFY:	return "VERIFY";
+	case WLOG_TYPE_ASSERT:	return "ASSERT";
+	case WLOG_TYPE_FATAL:	return "FATAL";
+	default:				return "BASE";
+	}
+}
+
+//"2026-10-17T18:10:01.165+08:00"，与__wlog_format_time_imp一样每个线程缓存到秒，返回长度
+inline size_t __wlog_json_time_imp(char* pOut) {
+	static __thread time_t g_wlogJsonSecond = -1;
+	static __thread char g_wlogJsonTime[20];
+	static __thread char g_wlogJsonZone[7];
+	struct timespec tsNow;
+	clock_gettime(WLOG_TIME_CLOCK, &tsNow);
+	if (tsNow.tv_sec != g_wlogJsonSecond) {
+		struct tm tmNow;
+		if (NULL == localtime_r(&tsNow.tv_sec, &tmNow)) return 0;
+		strftime(g_wlogJsonTime, sizeof(g_wlogJsonTime), "%Y-%m-%dT%H:%M:%S", &tmNow);
+		long nOffset = tmNow.tm_gmtoff / 60;
+		char chSign = (nOffset < 0) ? '-' : '+';
+		if (nOffset < 0) nOffset = -nOffset;
+		snprintf(g_wlogJsonZone, sizeof(g_wlogJsonZone), "%c%02ld:%02ld", chSign, nOffset / 60 % 100, nOffset % 60);
+		g_wlogJsonSecond = tsNow.tv_sec;
+	}
+	memcpy(pOut, g_wlogJsonTime, 19);
+	size_t nLen = 19;
+	#if (WLOG_TIME_PRECISION > 0)
+		unsigned int nFraction = (unsigned int)(tsNow.tv_nsec / WLOG_TIME_FRACTION_DIV);
+		int nIdx = WLOG_TIME_PRECISION;
+		pOut[nLen] = '.';
+		for (; nIdx > 0; --nIdx) {
+			pOut[nLen + nIdx] = (char)('0' + nFraction % 10);
+			nFraction /= 10;
+		}
+		nLen += 1 + WLOG_TIME_PRECISION;
+	#endif
+	memcpy(pOut + nLen, g_wlogJsonZone, 6);
+	return nLen + 6;
+}
+
+inline long __wlog_json_tid() {
+	static __thread long g_wlogJsonTid = 0;
+	if (0 == g_wlogJsonTid) g_wlogJsonTid = (long)syscall(SYS_gettid);
+	return g_wlogJsonTid;
+}
+
+//编码一条JSON日志并写出，pMsg是已经格式化好的消息，pData为logXXXN的数据(可以为NULL)
+inline void __wlog_json_write_imp(unsigned int nType, const char* szFile, int nLine, const __wlog_kv_t* pKvs, size_t nKvs,
+	const char* pMsg, size_t nMsg, const char* pData, size_t nData) {
+	char szRecord[WLOG_JSON_RECORD_SIZE];
+	char szNumber[48];
+	__wlog_json_out_t out = {szRecord, szRecord + sizeof(szRecord), 0};
+	__wlog_json_raw(&out, "{\"ts\":\"", 7);
+	__wlog_json_raw(&out, szNumber, __wlog_json_time_imp(szNumber));
+	__wlog_json_raw(&out, "\",\"level\":\"", 11);
+	const char* szLevel = __wlog_json_level(nType);
+	__wlog_json_raw(&out, szLevel, strlen(szLevel));
+	__wlog_json_raw(&out, "\",\"file\":", 9);
+	__wlog_json_string(&out, szFile, strlen(szFile), __WLOG_JSON_TAIL);
+	__wlog_json_raw(&out, ",\"line\":", 8);
+	__wlog_json_raw(&out, szNumber, __wlog_json_i64(szNumber, nLine));
+	__wlog_json_raw(&out, ",\"tid\":", 7);
+	__wlog_json_raw(&out, szNumber, __wlog_json_i64(szNumber, __wlog_json_tid()));
+	size_t nIdx = 0;
+	for (; nIdx < nKvs; ++nIdx) {
+		__wlog_json_kv(&out, &pKvs[nIdx]);
+	}
+	//留出data的位置，data最多用掉一半
+	__wlog_json_raw(&out, ",\"msg\":", 7);
+	size_t nDataReserve = (NULL == pData) ? 0 : (size_t)(out.pEnd - out.pCur) / 2;
+	__wlog_json_string(&out, pMsg, nMsg, __WLOG_JSON_TAIL + nDataReserve);
+	if (NULL != pData) {
+		__wlog_json_raw(&out, ",\"data\":", 8);
+		__wlog_json_string(&out, pData, nData, __WLOG_JSON_TAIL);
+	}
+	if (out.bTruncated) {
+		out.bTruncated = 0;
+		__wlog_json_raw(&out, ",\"truncated\":true", 17);
+	}
+	__wlog_json_raw(&out, "}\n", 2);
+	__wlog_write_record_imp(nType, szRecord, (size_t)(out.pCur - szRecord));
+}
+
+inline void __wlog_json_valist_imp(unsigned int nType, const char* szFile, int nLine, const __wlog_kv_t* pKvs, size_t nKvs,
+	const char* pData, size_t nData, const char* format, va_list arglist) {
+	char szMsg[WLOG_JSON_RECORD_SIZE];
+	int nMsg = vsnprintf(szMsg, sizeof(szMsg), format, arglist);
+	if (nMsg < 0) return;
+	if ((size_t)nMsg >= sizeof(szMsg)) nMsg = (int)sizeof(szMsg) - 1;
+	__wlog_json_write_imp(nType, szFile, nLine, pKvs, nKvs, szMsg, (size_t)nMsg, pData, nData);
+}
+
+//logBase在JSON模式下的实现
+inline void __wlog_json_log_imp(unsigned int nType, const char* szFile, int nLine, const char* format, ...) {
+	va_list arglist;
+	va_start(arglist, format);
+	__wlog_json_valist_imp(nType, szFile, nLine, NULL, 0, NULL, 0, format, arglist);
+	va_end(arglist);
+}
+
+//logBaseN在JSON模式下的实现，数据编码后去掉结尾的'\n'放进"data"
+inline void __wlog_json_log_n_imp(unsigned int nType, const char* szFile, int nLine,
+	const char* szFormat, const char* szBuf, int nPrintCount, const char* format, ...) {
+	char szStack[WLOG_DUMP_STACK_SIZE];
+	__wlog_dump_buf_t dumpBuf;
+	__wlog_dump_init(&dumpBuf, szStack, sizeof(szStack));
+	__wlog_dump_payload(&dumpBuf, szFormat, szBuf, nPrintCount);
+	size_t nData = dumpBuf.nLen;
+	if (nData > 0 && '\n' == dumpBuf.pData[nData - 1]) --nData;
+	va_list arglist;
+	va_start(arglist, format);
+	__wlog_json_valist_imp(nType, szFile, nLine, NULL, 0, dumpBuf.pData, nData, format, arglist);
+	va_end(arglist);
+	__wlog_dump_free(&dumpBuf);
+}
+
+#ifdef __cplusplus
+	#include <string>
+
+	//logXXXKV的键值对列表，由__wlog_kv_make("键", 值, ...)生成，只在一条语句内有效
+	typedef struct __wlog_kv_list_t {
+		__wlog_kv_t items[WLOG_KV_MAX];
+		size_t nCount;
+	} __wlog_kv_list_t;
+
+	inline void __wlog_kv_value(__wlog_kv_t* pKv, bool bValue) { pKv->chKind = 'b'; pKv->value.i = bValue ? 1 : 0; }
+	inline void __wlog_kv_value(__wlog_kv_t* pKv, char chValue) { pKv->chKind = 'i'; pKv->value.i = chValue; }
+	inline void __wlog_kv_value(__wlog_kv_t* pKv, signed char chValue) { pKv->chKind = 'i'; pKv->value.i = chValue; }
+	inline void __wlog_kv_value(__wlog_kv_t* pKv, short nValue) { pKv->chKind = 'i'; pKv->value.i = nValue; }
+	inline void __wlog_kv_value(__wlog_kv_t* pKv, int nValue) { pKv->chKind = 'i'; pKv->value.i = nValue; }
+	inline void __wlog_kv_value(__wlog_kv_t* pKv, long nValue) { pKv->chKind = 'i'; pKv->value.i = nValue; }
+	inline void __wlog_kv_value(__wlog_kv_t* pKv, long long nValue) { pKv->chKind = 'i'; pKv->value.i = nValue; }
+	inline void __wlog_kv_value(__wlog_kv_t* pKv, unsigned char nValue) { pKv->chKind = 'u'; pKv->value.u = nValue; }
+	inline void __wlog_kv_value(__wlog_kv_t* pKv, unsigned short nValue) { pKv->chKind = 'u'; pKv->value.u = nValue; }
+	inline void __wlog_kv_value(__wlog_kv_t* pKv, unsigned int nValue) { pKv->chKind = 'u'; pKv->value.u = nValue; }
+	inline void __wlog_kv_value(__wlog_kv_t* pKv, unsigned long nValue) { pKv->chKind = 'u'; pKv->value.u = nValue; }
+	inline void __wlog_kv_value(__wlog_kv_t* pKv, unsigned long long nValue) { pKv->chKind = 'u'; pKv->value.u = nValue; }
+	inline void __wlog_kv_value(__wlog_kv_t* pKv, float fValue) { pKv->chKind = 'f'; pKv->value.f = fValue; }
+	inline void __wlog_kv_value(__wlog_kv_t* pKv, double fValue) { pKv->chKind = 'f'; pKv->value.f = fValue; }
+	inline void __wlog_kv_value(__wlog_kv_t* pKv, const char* szValue) {
+		pKv->chKind = 's';
+		pKv->value.s = szValue;
+		pKv->nLen = (NULL == szValue) ? 0 : strlen(szValue);
+	}
+	inline void __wlog_kv_value(__wlog_kv_t* pKv, const std::string& strValue) {
+		pKv->chKind = 's';
+		pKv->value.s = strValue.c_str();
+		pKv->nLen = strValue.size();
+	}
+
+	inline void __wlog_kv_fill(__wlog_kv_t* pKv) {
+		(void)pKv;
+	}
+	template <typename V, typename... Args> inline void __wlog_kv_fill(__wlog_kv_t* pKv, const char* szKey, const V& value, const Args&... args) {
+		pKv->szKey = szKey;
+		__wlog_kv_value(pKv, value);
+		__wlog_kv_fill(pKv + 1, args...);
+	}
+
+	template <typename... Args> inline __wlog_kv_list_t __wlog_kv_make(const Args&... args) {
+		static_assert(sizeof...(Args) % 2 == 0, "logXXXKV: key/value list must be (\"key\", value, ...)");
+		static_assert(sizeof...(Args) / 2 <= WLOG_KV_MAX, "logXXXKV: too many key/value pairs, see WLOG_KV_MAX");
+		__wlog_kv_list_t kvList;
+		kvList.nCount = sizeof...(Args) / 2;
+		__wlog_kv_fill(kvList.items, args...);
+		return kvList;
+	}
+
+	//文本模式：在日志后面接" key=value"
+	inline void __wlog_kv_text_imp(unsigned int nType, char chType, const char* szFile, int nLine,
+		const __wlog_kv_list_t& kvList, const char* format, ...) {
+		char szTime[WLOG_TIME_BUFFER_SIZE];
+		char szStack[WLOG_DUMP_STACK_SIZE];
+		__wlog_dump_buf_t dumpBuf;
+		__wlog_dump_init(&dumpBuf, szStack, sizeof(szStack));
+		__wlog_format_time_imp(szTime, WLOG_TIME_BUFFER_SIZE);
+		__wlog_dump_append(&dumpBuf, _T("%s %c %s:%-4d| "), szTime, chType, szFile, nLine);
+		va_list arglist;
+		va_start(arglist, format);
+		__wlog_dump_append_valist(&dumpBuf, format, arglist);
+		va_end(arglist);
+		size_t nIdx = 0;
+		for (; nIdx < kvList.nCount; ++nIdx) {
+			const __wlog_kv_t* pKv = &kvList.items[nIdx];
+			switch (pKv->chKind) {
+			case 'i':	__wlog_dump_append(&dumpBuf, " %s=%lld", pKv->szKey, pKv->value.i); break;
+			case 'u':	__wlog_dump_append(&dumpBuf, " %s=%llu", pKv->szKey, pKv->value.u); break;
+			case 'f':	__wlog_dump_append(&dumpBuf, " %s=%g", pKv->szKey, pKv->value.f); break;
+			case 'b':	__wlog_dump_append(&dumpBuf, " %s=%s", pKv->szKey, pKv->value.i ? "true" : "false"); break;
+			default:	__wlog_dump_append(&dumpBuf, " %s=%.*s", pKv->szKey, (int)pKv->nLen, (NULL == pKv->value.s) ? "" : pKv->value.s); break;
+			}
+		}
+		__wlog_dump_append(&dumpBuf, _T("\n"));
+		__wlog_write_record_imp(nType, dumpBuf.pData, dumpBuf.nLen);
+		__wlog_dump_free(&dumpBuf);
+	}
+
+	inline void __wlog_kv_json_imp(unsigned int nType, char chType, const char* szFile, int nLine,
+		const __wlog_kv_list_t& kvList, const char* format, ...) {
+		(void)chType;
+		va_list arglist;
+		va_start(arglist, format);
+		__wlog_json_valist_imp(nType, szFile, nLine, kvList.items, kvList.nCount, NULL, 0, format, arglist);
+		va_end(arglist);
+	}
+
+	#if WLOG_JSON
+		#define __wlog_kv_log_imp __wlog_kv_json_imp
+	#else
+		#define __wlog_kv_log_imp __wlog_kv_text_imp
+	#endif
+
+	#if (WLOG_STATIC_TYPE_SWITCH&WLOG_TYPE_BASE) && (WLOG_STATIC_TYPE_SWITCH&WLOG_TYPE_TEXT)
+		#define logBaseKV(nType, chType, kv, format, args...) do {\
+			WLOG_DYNAMIC_CHECK(nType);\
+			WLOG_SITE_DEFINE(nType, chType, format);\
+			WLOG_FLIGHT_CHECK(nType);\
+			WLOG_STATS_BEGIN();\
+			WLOG_DYNAMIC_CHECK_TEXT __wlog_kv_log_imp(nType, chType, WLOG_SITE_FILE, __LINE__, __wlog_kv_make kv, format, ##args);\
+			WLOG_STATS_END(nType);\
+			WLOG_ASYNC_DRAIN_CHECK(nType);\
+		} while (0)
+	#else
+		#define logBaseKV(nType, chType, kv, format, args...)
+	#endif
+
+	#if (WLOG_STATIC_TYPE_SWITCH&WLOG_TYPE_TRACE)
+		#define logTraceKV(kv, format, args...) logBaseKV(WLOG_TYPE_TRACE, 'T', kv, format, ##args)
+	#else
+		#define logTraceKV(kv, format, args...)
+	#endif
+	#if (WLOG_STATIC_TYPE_SWITCH&WLOG_TYPE_DEBUG)
+		#define logDebugKV(kv, format, args...) logBaseKV(WLOG_TYPE_DEBUG, 'D', kv, format, ##args)
+	#else
+		#define logDebugKV(kv, format, args...)
+	#endif
+	#if (WLOG_STATIC_TYPE_SWITCH&WLOG_TYPE_INFO)
+		#define logInfoKV(kv, format, args...) logBaseKV(WLOG_TYPE_INFO, 'I', kv, format, ##args)
+	#else
+		#define logInfoKV(kv, format, args...)
+	#endif
+	#if (WLOG_STATIC_TYPE_SWITCH&WLOG_TYPE_NOTICE)
+		#define logNoticeKV(kv, format, args...) logBaseKV(WLOG_TYPE_NOTICE, 'N', kv, format, ##args)
+	#else
+		#define logNoticeKV(kv, format, args...)
+	#endif
+	#if (WLOG_STATIC_TYPE_SWITCH&WLOG_TYPE_WARNING)
+		#define logWarningKV(kv, format, args...) logBaseKV(WLOG_TYPE_WARNING, 'W', kv, format, ##args)
+	#else
+		#define logWarningKV(kv, format, args...)
+	#endif
+	#if (WLOG_STATIC_TYPE_SWITCH&WLOG_TYPE_ERROR)
+		#define logErrorKV(kv, format, args...) logBaseKV(WLOG_TYPE_ERROR, 'E', kv, format, ##args)
+	#else
+		#define logErrorKV(kv, format, args...)
+	#endif
+	#if (WLOG_STATIC_TYPE_SWITCH&WLOG_TYPE_FATAL)
+		#define logFatalKV(kv, format, args...) logBaseKV(WLOG_TYPE_FATAL, 'F', kv, format, ##args)
+	#else
+		#define logFatalKV(kv, format, args...)
+	#endif
+#endif
+
+#endif //__WLOG_JSON_H__
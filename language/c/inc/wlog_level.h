@@ -0,0 +1,347 @@
+#ifndef __WLOG_LEVEL_H__
+#define __WLOG_LEVEL_H__
+/**
+ * @file wlog_level.h
+ * @brief WLOG_DYNAMIC_TYPE_SWITCH的分类开关与配置文件热加载，linux用户态，由wlog.h自动包含，不要单独include.
+ * <pre>动态开关g_wlogDynamicTypeSwitch改为原子读(relaxed)，判断仍然只是一次读加一次与。
+        分类：在include <wlog.h>之前定义本编译单元所属的分类，本文件里的日志就改用这个分类的开关，
+            #define WLOG_CATEGORY_NAME "net.http"
+        分类按'.'分层，"net.http"没有单独设置时用"net"的设置，"net"也没有时用全局的g_wlogDynamicTypeSwitch。
+        多个编译单元可以属于同一个分类。没有定义WLOG_CATEGORY_NAME的编译单元直接用g_wlogDynamicTypeSwitch。
+        运行时修改：
+            wlogSetTypeSwitch("net", WLOG_TYPE_ALL);       //"net"及其下所有没有单独设置的分类
+            wlogSetTypeSwitch(NULL, WLOG_TYPE_ERROR);      //全局，分类也会跟着更新
+            wlogGetTypeSwitch("net.http");                 //分类当前生效的开关
+        直接给g_wlogDynamicTypeSwitch赋值只影响没有分类的编译单元，分类要用wlogSetTypeSwitch。
+        配置文件，每行一个"分类 = 类型|类型"，'*'表示全局，'#'开头为注释，类型可以是TEXT、BASE、TRACE、DEBUG、
+        INFO、NOTICE、WARNING、ERROR、VERIFY、ASSERT、FATAL、ALL、NONE或者数字(如0x1F0)：
+            * = TEXT|BASE|WARNING|ERROR|VERIFY|ASSERT|FATAL
+            net.http = ALL
+        wlogReloadConfig()重新读取配置文件，文件里的设置替换以前所有的设置，没有'*'时全局恢复为程序启动时的值。
+        可在include <wlog.h>之前修改的“宏”配置：
+		1. WLOG_CONFIG_FILE，配置文件路径，定义后启动时加载一次，并由后台线程用inotify监视，文件保存后自动重新加载，默认不定义
+		2. WLOG_CONFIG_SIGHUP，定义成1时收到SIGHUP也重新加载配置文件，会替换程序原有的SIGHUP处理，默认0
+	</pre>
+ * @os linux
+ */
+#include <pthread.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <limits.h>
+#include <string.h>
+#include <strings.h>
+#include <stdlib.h>
+#include <ctype.h>
+#if defined(WLOG_CONFIG_FILE)
+	#include <errno.h>
+	#include <poll.h>
+	#include <signal.h>
+	#include <unistd.h>
+	#include <sys/eventfd.h>
+	#include <sys/inotify.h>
+#endif
+
+#ifndef WLOG_CONFIG_SIGHUP
+	#define WLOG_CONFIG_SIGHUP 0
+#endif
+
+#define WLOG_CATEGORY_NAME_SIZE 64
+
+//一个编译单元的分类开关，nMask是算好的生效值，写日志时只读它
+typedef struct __wlog_category_t {
+	const char* szName;
+	unsigned int nMask;
+	struct __wlog_category_t* pNext;
+} __wlog_category_t;
+
+typedef struct __wlog_level_rule_t {
+	char szName[WLOG_CATEGORY_NAME_SIZE];
+	unsigned int nMask;
+} __wlog_level_rule_t;
+
+typedef struct __wlog_level_ctx_t {
+	pthread_mutex_t hMutex;
+	__wlog_category_t* pHead;
+	__wlog_level_rule_t* pRules;
+	unsigned int nRules;
+	unsigned int nCapacity;
+	unsigned int nDefault;		//程序启动时的g_wlogDynamicTypeSwitch
+	int bDefaultSaved;
+	int hEvent;					//SIGHUP通知后台线程
+} __wlog_level_ctx_t;
+
+inline __wlog_level_ctx_t* __wlog_level_ctx() {
+	static __wlog_level_ctx_t g_wlogLevelCtx = {PTHREAD_MUTEX_INITIALIZER, NULL, NULL, 0, 0, 0, 0, -1};
+	return &g_wlogLevelCtx;
+}
+
+//调用者持有hMutex；最长的匹配规则生效，"net"匹配"net"与"net.xxx"
+inline unsigned int __wlog_level_resolve_imp(__wlog_level_ctx_t* pCtx, const char* szName) {
+	unsigned int nMask = __atomic_load_n(&g_wlogDynamicTypeSwitch, __ATOMIC_RELAXED);
+	size_t nBest = 0;
+	unsigned int nIdx = 0;
+	for (; nIdx < pCtx->nRules; ++nIdx) {
+		size_t nLen = strlen(pCtx->pRules[nIdx].szName);
+		if (nLen <= nBest || 0 != strncmp(szName, pCtx->pRules[nIdx].szName, nLen)) continue;
+		if (0 != szName[nLen] && '.' != szName[nLen]) continue;
+		nBest = nLen;
+		nMask = pCtx->pRules[nIdx].nMask;
+	}
+	return nMask;
+}
+
+//调用者持有hMutex
+inline void __wlog_level_apply_imp(__wlog_level_ctx_t* pCtx) {
+	__wlog_category_t* pCategory = pCtx->pHead;
+	for (; NULL != pCategory; pCategory = pCategory->pNext) {
+		__atomic_store_n(&pCategory->nMask, __wlog_level_resolve_imp(pCtx, pCategory->szName), __ATOMIC_RELAXED);
+	}
+}
+
+//调用者持有hMutex；已有同名规则时覆盖
+inline int __wlog_level_set_rule_imp(__wlog_level_ctx_t* pCtx, const char* szName, unsigned int nMask) {
+	unsigned int nIdx = 0;
+	for (; nIdx < pCtx->nRules; ++nIdx) {
+		if (0 == strcmp(pCtx->pRules[nIdx].szName, szName)) {
+			pCtx->pRules[nIdx].nMask = nMask;
+			return 1;
+		}
+	}
+	if (strlen(szName) >= WLOG_CATEGORY_NAME_SIZE) return 0;
+	if (pCtx->nRules == pCtx->nCapacity) {
+		unsigned int nCapacity = pCtx->nCapacity ? pCtx->nCapacity * 2 : 16;
+		__wlog_level_rule_t* pRules = (__wlog_level_rule_t*)realloc(pCtx->pRules, nCapacity * sizeof(__wlog_level_rule_t));
+		if (NULL == pRules) return 0;
+		pCtx->pRules = pRules;
+		pCtx->nCapacity = nCapacity;
+	}
+	strcpy(pCtx->pRules[pCtx->nRules].szName, szName);
+	pCtx->pRules[pCtx->nRules].nMask = nMask;
+	++pCtx->nRules;
+	return 1;
+}
+
+inline void __wlog_level_save_default_imp(__wlog_level_ctx_t* pCtx) {
+	if (pCtx->bDefaultSaved) return;
+	pCtx->nDefault = __atomic_load_n(&g_wlogDynamicTypeSwitch, __ATOMIC_RELAXED);
+	pCtx->bDefaultSaved = 1;
+}
+
+//由包含wlog.h且定义了WLOG_CATEGORY_NAME的编译单元在main之前调用
+inline void __wlog_category_register_imp(__wlog_category_t* pCategory) {
+	__wlog_level_ctx_t* pCtx = __wlog_level_ctx();
+	pthread_mutex_lock(&pCtx->hMutex);
+	__wlog_level_save_default_imp(pCtx);
+	pCategory->pNext = pCtx->pHead;
+	pCtx->pHead = pCategory;
+	__atomic_store_n(&pCategory->nMask, __wlog_level_resolve_imp(pCtx, pCategory->szName), __ATOMIC_RELAXED);
+	pthread_mutex_unlock(&pCtx->hMutex);
+}
+
+//szCategory为NULL或"*"时修改全局开关
+inline void wlogSetTypeSwitch(const char* szCategory, unsigned int nMask) {
+	__wlog_level_ctx_t* pCtx = __wlog_level_ctx();
+	pthread_mutex_lock(&pCtx->hMutex);
+	__wlog_level_save_default_imp(pCtx);
+	if (NULL == szCategory || 0 == strcmp(szCategory, "*")) {
+		__atomic_store_n(&g_wlogDynamicTypeSwitch, nMask, __ATOMIC_RELAXED);
+	} else {
+		__wlog_level_set_rule_imp(pCtx, szCategory, nMask);
+	}
+	__wlog_level_apply_imp(pCtx);
+	pthread_mutex_unlock(&pCtx->hMutex);
+}
+
+inline unsigned int wlogGetTypeSwitch(const char* szCategory) {
+	__wlog_level_ctx_t* pCtx = __wlog_level_ctx();
+	if (NULL == szCategory || 0 == strcmp(szCategory, "*")) {
+		return __atomic_load_n(&g_wlogDynamicTypeSwitch, __ATOMIC_RELAXED);
+	}
+	pthread_mutex_lock(&pCtx->hMutex);
+	unsigned int nMask = __wlog_level_resolve_imp(pCtx, szCategory);
+	pthread_mutex_unlock(&pCtx->hMutex);
+	return nMask;
+}
+
+//"DEBUG|INFO"、"ALL"、"0x1F0"，不认识的类型返回0
+inline int __wlog_level_parse_mask(const char* szValue, unsigned int* pMask) {
+	static const char* s_szNames[] = {"TEXT", "BASE", "TRACE", "DEBUG", "INFO", "NOTICE", "WARNING", "ERROR", "VERIFY", "ASSERT", "FATAL"};
+	unsigned int nMask = 0;
+	while (*szValue) {
+		while (*szValue && (isspace((unsigned char)*szValue) || '|' == *szValue || ',' == *szValue)) ++szValue;
+		if (0 == *szValue) break;
+		const char* szEnd = szValue;
+		while (*szEnd && !isspace((unsigned char)*szEnd) && '|' != *szEnd && ',' != *szEnd) ++szEnd;
+		size_t nLen = (size_t)(szEnd - szValue);
+		if (isdigit((unsigned char)*szValue)) {
+			char* szNumEnd = NULL;
+			nMask |= (unsigned int)strtoul(szValue, &szNumEnd, 0);
+			if (szNumEnd != szEnd) return 0;
+		} else if (3 == nLen && 0 == strncasecmp(szValue, "ALL", 3)) {
+			nMask |= WLOG_TYPE_ALL;
+		} else if (4 != nLen || 0 != strncasecmp(szValue, "NONE", 4)) {
+			unsigned int nIdx = 0;
+			for (; nIdx < sizeof(s_szNames) / sizeof(s_szNames[0]); ++nIdx) {
+				if (strlen(s_szNames[nIdx]) == nLen && 0 == strncasecmp(szValue, s_szNames[nIdx], nLen)) break;
+			}
+			if (nIdx == sizeof(s_szNames) / sizeof(s_szNames[0])) return 0;
+			nMask |= (0x01u << (nIdx + 1));
+		}
+		szValue = szEnd;
+	}
+	*pMask = nMask;
+	return 1;
+}
+
+#if defined(WLOG_CONFIG_FILE)
+	//整个文件解析成功后才替换以前的设置，返回0表示文件打不开或有错误的行
+	inline int wlogReloadConfig() {
+		FILE* hFile = fopen(WLOG_CONFIG_FILE, "r");
+		if (NULL == hFile) return 0;
+		__wlog_level_ctx_t ctxNew;
+		memset(&ctxNew, 0, sizeof(ctxNew));
+		int bGlobal = 0, bOk = 1;
+		unsigned int nGlobal = 0;
+		char szLine[512];
+		while (bOk && NULL != fgets(szLine, sizeof(szLine), hFile)) {
+			char* szName = szLine;
+			while (isspace((unsigned char)*szName)) ++szName;
+			if (0 == *szName || '#' == *szName) continue;
+			char* szValue = strchr(szName, '=');
+			if (NULL == szValue) {
+				bOk = 0;
+				break;
+			}
+			char* szNameEnd = szValue;
+			while (szNameEnd > szName && isspace((unsigned char)szNameEnd[-1])) --szNameEnd;
+			*szNameEnd = 0;
+			unsigned int nMask = 0;
+			bOk = (szNameEnd > szName) && __wlog_level_parse_mask(szValue + 1, &nMask);
+			if (!bOk) break;
+			if (0 == strcmp(szName, "*")) {
+				bGlobal = 1;
+				nGlobal = nMask;
+			} else {
+				bOk = __wlog_level_set_rule_imp(&ctxNew, szName, nMask);
+			}
+		}
+		fclose(hFile);
+		if (!bOk) {
+			free(ctxNew.pRules);
+			return 0;
+		}
+		__wlog_level_ctx_t* pCtx = __wlog_level_ctx();
+		pthread_mutex_lock(&pCtx->hMutex);
+		__wlog_level_save_default_imp(pCtx);
+		__atomic_store_n(&g_wlogDynamicTypeSwitch, bGlobal ? nGlobal : pCtx->nDefault, __ATOMIC_RELAXED);
+		free(pCtx->pRules);
+		pCtx->pRules = ctxNew.pRules;
+		pCtx->nRules = ctxNew.nRules;
+		pCtx->nCapacity = ctxNew.nCapacity;
+		__wlog_level_apply_imp(pCtx);
+		pthread_mutex_unlock(&pCtx->hMutex);
+		return 1;
+	}
+
+	#if WLOG_CONFIG_SIGHUP
+		inline void __wlog_config_sighup_imp(int nSignal) {
+			(void)nSignal;
+			int nErrno = errno;
+			uint64_t nOne = 1;
+			ssize_t nRet = write(__wlog_level_ctx()->hEvent, &nOne, sizeof(nOne));
+			(void)nRet;
+			errno = nErrno;
+		}
+	#endif
+
+	//监视配置文件所在的目录，编辑器保存时常常是写临时文件再改名，直接监视文件会丢失
+	inline void* __wlog_config_thread_imp(void* pArg) {
+		(void)pArg;
+		__wlog_level_ctx_t* pCtx = __wlog_level_ctx();
+		const char* szPath = WLOG_CONFIG_FILE;
+		const char* szSlash = strrchr(szPath, '/');
+		const char* szBase = szSlash ? szSlash + 1 : szPath;
+		char szDir[PATH_MAX];
+		if (NULL == szSlash) strcpy(szDir, ".");
+		else if (szSlash == szPath) strcpy(szDir, "/");
+		else snprintf(szDir, sizeof(szDir), "%.*s", (int)(szSlash - szPath), szPath);
+		int hNotify = inotify_init1(IN_CLOEXEC);
+		if (hNotify >= 0 && inotify_add_watch(hNotify, szDir, IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+			close(hNotify);
+			hNotify = -1;
+		}
+		struct pollfd pollFds[2] = {{hNotify, POLLIN, 0}, {pCtx->hEvent, POLLIN, 0}};
+		char szEvents[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+		for (;;) {
+			if (poll(pollFds, 2, -1) < 0) {
+				if (EINTR == errno) continue;
+				break;
+			}
+			int bReload = 0;
+			if (pollFds[0].revents & POLLIN) {
+				ssize_t nLen = read(hNotify, szEvents, sizeof(szEvents));
+				ssize_t nPos = 0;
+				while (nPos < nLen) {
+					const struct inotify_event* pEvent = (const struct inotify_event*)(szEvents + nPos);
+					if (pEvent->len > 0 && 0 == strcmp(pEvent->name, szBase)) bReload = 1;
+					nPos += (ssize_t)(sizeof(struct inotify_event) + pEvent->len);
+				}
+			}
+			if (pollFds[1].revents & POLLIN) {
+				uint64_t nCount;
+				ssize_t nRet = read(pCtx->hEvent, &nCount, sizeof(nCount));
+				(void)nRet;
+				bReload = 1;
+			}
+			if (bReload) wlogReloadConfig();
+		}
+		return NULL;
+	}
+
+	inline void __wlog_config_start_imp() {
+		__wlog_level_ctx_t* pCtx = __wlog_level_ctx();
+		wlogReloadConfig();
+		pCtx->hEvent = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+		#if WLOG_CONFIG_SIGHUP
+			if (pCtx->hEvent >= 0) {
+				struct sigaction sigAction;
+				memset(&sigAction, 0, sizeof(sigAction));
+				sigAction.sa_handler = __wlog_config_sighup_imp;
+				sigAction.sa_flags = SA_RESTART;
+				sigemptyset(&sigAction.sa_mask);
+				sigaction(SIGHUP, &sigAction, NULL);
+			}
+		#endif
+		pthread_t hThread;
+		if (0 == pthread_create(&hThread, NULL, __wlog_config_thread_imp, NULL)) {
+			pthread_detach(hThread);
+		}
+	}
+	inline void __wlog_config_start() {
+		static pthread_once_t g_wlogConfigOnce = PTHREAD_ONCE_INIT;
+		pthread_once(&g_wlogConfigOnce, __wlog_config_start_imp);
+	}
+#else
+	#define __wlog_config_start()
+#endif
+
+//每个编译单元一个：登记本单元的分类，并在main之前加载配置文件
+#if defined(WLOG_CATEGORY_NAME)
+	static __wlog_category_t g_wlogCategory = {WLOG_CATEGORY_NAME, WLOG_STATIC_TYPE_SWITCH, NULL};
+	#define WLOG_DYNAMIC_MASK_VAR g_wlogCategory.nMask
+#else
+	#define WLOG_DYNAMIC_MASK_VAR g_wlogDynamicTypeSwitch
+#endif
+#if defined(WLOG_CATEGORY_NAME) || defined(WLOG_CONFIG_FILE)
+	static void __wlog_level_init_ctor() __attribute__((constructor(101)));
+	static void __wlog_level_init_ctor() {
+		#if defined(WLOG_CATEGORY_NAME)
+			__wlog_category_register_imp(&g_wlogCategory);
+		#endif
+		__wlog_config_start();
+	}
+#endif
+
+#define WLOG_DYNAMIC_MASK() __atomic_load_n(&WLOG_DYNAMIC_MASK_VAR, __ATOMIC_RELAXED)
+
+#endif //__WLOG_LEVEL_H__
@@ -0,0 +1,88 @@
+#ifndef __WLOG_LIMIT_H__
+#define __WLOG_LIMIT_H__
+/**
+ * @file wlog_limit.h
+ * @brief logXXXR限速与logXXXS采样的调用点计数，由wlog.h自动包含，不要单独include.
+ * <pre>logXXXR(nPerSecond, format, ...)，每个调用点每秒最多输出nPerSecond条，允许一次突发nPerSecond条，
+        logXXXS(nSample, format, ...)，每个调用点每nSample次只输出第1次，nSample为0或1时不采样。
+        每个调用点一个静态的__wlog_limit_t，无锁：被丢弃时只有一次原子读和一次原子加(限速还要读一次时钟)。
+        丢弃之后第一条输出的日志前面加上"(suppressed K) "，K是这期间丢弃的条数。
+        如在循环里：
+            logErrorR(10, "recv failed, errno %d", errno);     //每秒最多10条
+            logDebugS(1000, "packet %u", nSeq);                //每1000个包记一条
+	</pre>
+ * @os windows, linux
+ */
+
+typedef struct __wlog_limit_t {
+	volatile long long nNext;			//限速：下一条允许输出的理论时间(纳秒)；采样：调用次数
+	volatile long nSuppressed;
+} __wlog_limit_t;
+
+#ifdef _WIN32
+	#define __wlog_limit_load(p)			InterlockedCompareExchange64((p), 0, 0)
+	#define __wlog_limit_cas(p, o, n)		(InterlockedCompareExchange64((p), (n), (o)) == (o))
+	#define __wlog_limit_inc(p)				(InterlockedIncrement64(p) - 1)
+	#define __wlog_limit_suppress(p)		InterlockedIncrement(p)
+	#define __wlog_limit_take(p)			InterlockedExchange((p), 0)
+	inline long long __wlog_limit_now_ns() {
+		return (long long)GetTickCount64() * 1000000;
+	}
+#else
+	#define __wlog_limit_load(p)			__atomic_load_n((p), __ATOMIC_RELAXED)
+	#define __wlog_limit_cas(p, o, n)		__atomic_compare_exchange_n((p), &(o), (n), 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED)
+	#define __wlog_limit_inc(p)				__atomic_fetch_add((p), 1, __ATOMIC_RELAXED)
+	#define __wlog_limit_suppress(p)		__atomic_fetch_add((p), 1, __ATOMIC_RELAXED)
+	#define __wlog_limit_take(p)			__atomic_exchange_n((p), 0, __ATOMIC_RELAXED)
+	inline long long __wlog_limit_now_ns() {
+		#if (WLOG_TO == WLOG_TO_KERNEL)
+			return (long long)jiffies_to_msecs(jiffies) * 1000000;
+		#else
+			struct timespec tsNow;
+			clock_gettime(CLOCK_MONOTONIC, &tsNow);
+			return (long long)tsNow.tv_sec * 1000000000LL + tsNow.tv_nsec;
+		#endif
+	}
+#endif
+
+//限速(GCRA，与令牌桶等价)：返回1表示这次可以输出，*pSuppressed为之前丢弃的条数
+inline int __wlog_limit_rate_imp(__wlog_limit_t* pLimit, unsigned int nPerSecond, long* pSuppressed) {
+	if (0 == nPerSecond) {
+		__wlog_limit_suppress(&pLimit->nSuppressed);
+		return 0;
+	}
+	long long nInterval = 1000000000LL / nPerSecond;
+	long long nBurst = nInterval * (nPerSecond - 1);
+	long long nNow = __wlog_limit_now_ns();
+	long long nNext = __wlog_limit_load(&pLimit->nNext);
+	for (;;) {
+		long long nStart = (nNext > nNow) ? nNext : nNow;
+		if (nStart - nNow > nBurst) {
+			__wlog_limit_suppress(&pLimit->nSuppressed);
+			return 0;
+		}
+		#ifdef _WIN32
+			long long nOld = nNext;
+			if (__wlog_limit_cas(&pLimit->nNext, nOld, nStart + nInterval)) break;
+			nNext = __wlog_limit_load(&pLimit->nNext);
+		#else
+			if (__wlog_limit_cas(&pLimit->nNext, nNext, nStart + nInterval)) break;
+		#endif
+	}
+	*pSuppressed = (0 != pLimit->nSuppressed) ? __wlog_limit_take(&pLimit->nSuppressed) : 0;
+	return 1;
+}
+
+//采样：每nSample次的第1次返回1，两次输出之间固定丢弃nSample - 1条；nSample为0或1时不采样，每次都输出
+inline int __wlog_limit_sample_imp(__wlog_limit_t* pLimit, unsigned int nSample, long* pSuppressed) {
+	if (nSample <= 1) {
+		*pSuppressed = 0;
+		return 1;
+	}
+	long long nCount = __wlog_limit_inc(&pLimit->nNext);
+	if (0 != nCount % nSample) return 0;
+	*pSuppressed = (nCount > 0) ? (long)nSample - 1 : 0;
+	return 1;
+}
+
+#endif //__WLOG_LIMIT_H__
@@ -0,0 +1,233 @@
+#ifndef __WLOG_MMAP_H__
+#define __WLOG_MMAP_H__
+/**
+ * @file wlog_mmap.h
+ * @brief WLOG_TO_MMAP内存映射文件输出，由wlog.h自动包含，不要单独include.
+ * <pre>日志文件按WLOG_MMAP_CHUNK_SIZE一段一段地预分配(posix_fallocate)并映射到内存，
+        写日志只是原子地推进文件尾再memcpy，稳定运行时没有任何系统调用，也没有stdio缓冲的刷新抖动。
+        日志对tail -f等其他进程立即可见，进程崩溃也不会丢失已经写完的日志。
+        正常退出时(atexit)把文件截断到实际长度；崩溃后文件末尾是预分配的'\0'，下次打开时
+        从末尾向前找到最后一个非'\0'字节，再截到它之前的最后一个'\n'，从那里继续写。
+        崩溃时还没写完的日志可能在文件中间留下一段'\0'，可以用grep -a查看。
+        可在include <wlog.h>之前修改的“宏”配置：
+		1. WLOG_MMAP_CHUNK_SIZE，每次预分配并映射的大小，必须是页大小的整数倍，默认64M
+		2. WLOG_MMAP_RESERVE_SIZE，本次运行最多写入的字节数(预留的虚拟地址空间)，超出后日志被丢弃并计数，
+			用wlogMmapDropped()读取，64位下默认64G，32位下默认512M
+		3. WLOG_FLUSH_SYNC_TYPES，这些类型的日志写完后msync落盘，默认0
+		wlogFlush()只是通知内核开始回写(msync MS_ASYNC)，日志本身不需要刷新。
+	</pre>
+ * @os linux
+ */
+#ifdef _WIN32
+	#error "haven't implement!"
+#endif
+
+#include <pthread.h>
+#include <string.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#ifndef WLOG_MMAP_CHUNK_SIZE
+	#define WLOG_MMAP_CHUNK_SIZE (64UL * 1024 * 1024)
+#endif
+#ifndef WLOG_MMAP_RESERVE_SIZE
+	#if (ULONG_MAX > 0xFFFFFFFFUL)
+		#define WLOG_MMAP_RESERVE_SIZE (64UL * 1024 * 1024 * 1024)
+	#else
+		#define WLOG_MMAP_RESERVE_SIZE (512UL * 1024 * 1024)
+	#endif
+#endif
+#if (WLOG_MMAP_RESERVE_SIZE < WLOG_MMAP_CHUNK_SIZE)
+	#error "WLOG_MMAP_RESERVE_SIZE must not be less than WLOG_MMAP_CHUNK_SIZE!"
+#endif
+#ifndef WLOG_FLUSH_SYNC_TYPES
+	#define WLOG_FLUSH_SYNC_TYPES 0
+#endif
+
+//文件中nOrigin处映射到pBase，以下位置都是相对nOrigin的偏移
+typedef struct __wlog_mmap_ctx_t {
+	unsigned long nTail __attribute__((aligned(64)));	//下一条日志的位置
+	unsigned long nMapped __attribute__((aligned(64)));	//已经映射的长度
+	unsigned long nLimit;		//不能超过的位置，预分配或映射失败后缩小
+	unsigned long nDropPos;		//第一条被丢弃的日志的位置
+	unsigned long nDropped;
+	off_t nOrigin;
+	char* pBase;
+	int hFile;
+	int bClosed;
+	pthread_mutex_t hMutex;
+} __wlog_mmap_ctx_t;
+
+inline __wlog_mmap_ctx_t* __wlog_mmap_ctx() {
+	static __wlog_mmap_ctx_t g_wlogMmapCtx = {0, 0, 0, ULONG_MAX, 0, 0, NULL, -1, 0, PTHREAD_MUTEX_INITIALIZER};
+	return &g_wlogMmapCtx;
+}
+
+//找到上次运行写到的位置：末尾不是'\0'说明上次正常关闭，否则截到最后一个非'\0'字节之前的最后一个'\n'
+inline off_t __wlog_mmap_recover_imp(int hFile) {
+	struct stat stFile;
+	char szBlock[64 * 1024];
+	if (0 != fstat(hFile, &stFile) || stFile.st_size == 0) return 0;
+	off_t nEnd = stFile.st_size;
+	int bFoundData = 0;
+	while (nEnd > 0) {
+		off_t nStart = (nEnd > (off_t)sizeof(szBlock)) ? nEnd - (off_t)sizeof(szBlock) : 0;
+		ssize_t nRead = pread(hFile, szBlock, (size_t)(nEnd - nStart), nStart);
+		if (nRead != (ssize_t)(nEnd - nStart)) return stFile.st_size;
+		ssize_t nIdx = nRead - 1;
+		if (!bFoundData) {
+			if (nEnd == stFile.st_size && 0 != szBlock[nIdx]) return stFile.st_size;
+			while (nIdx >= 0 && 0 == szBlock[nIdx]) --nIdx;
+			bFoundData = (nIdx >= 0);
+		}
+		while (nIdx >= 0 && '\n' != szBlock[nIdx]) --nIdx;
+		if (nIdx >= 0) {
+			nEnd = nStart + nIdx + 1;
+			break;
+		}
+		nEnd = nStart;
+	}
+	if (0 != ftruncate(hFile, nEnd)) return stFile.st_size;
+	return nEnd;
+}
+
+//保证[0, nEnd)已经映射，失败时缩小nLimit，之后越界的日志都被丢弃
+inline int __wlog_mmap_extend_imp(__wlog_mmap_ctx_t* pCtx, unsigned long nEnd) {
+	int bOk = 1;
+	pthread_mutex_lock(&pCtx->hMutex);
+	while (pCtx->nMapped < nEnd) {
+		unsigned long nMapped = pCtx->nMapped;
+		off_t nOffset = pCtx->nOrigin + (off_t)nMapped;
+		if (nMapped + WLOG_MMAP_CHUNK_SIZE > pCtx->nLimit
+			|| 0 != posix_fallocate(pCtx->hFile, nOffset, WLOG_MMAP_CHUNK_SIZE)
+			|| MAP_FAILED == mmap(pCtx->pBase + nMapped, WLOG_MMAP_CHUNK_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, pCtx->hFile, nOffset)) {
+			pCtx->nLimit = nMapped;
+			bOk = 0;
+			break;
+		}
+		__atomic_store_n(&pCtx->nMapped, nMapped + WLOG_MMAP_CHUNK_SIZE, __ATOMIC_RELEASE);
+	}
+	pthread_mutex_unlock(&pCtx->hMutex);
+	return bOk;
+}
+
+inline void __wlog_mmap_drop_imp(__wlog_mmap_ctx_t* pCtx, unsigned long nPos) {
+	unsigned long nDropPos = __atomic_load_n(&pCtx->nDropPos, __ATOMIC_RELAXED);
+	__atomic_fetch_add(&pCtx->nDropped, 1, __ATOMIC_RELAXED);
+	#if WLOG_STATS
+		__wlog_stats_drop_imp();
+	#endif
+	while (nPos < nDropPos && !__atomic_compare_exchange_n(&pCtx->nDropPos, &nDropPos, nPos, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+}
+
+//热路径：一次原子加法占位，再memcpy。越过最后一段的一半的那条日志顺便映射下一段，其他线程不用等
+inline void __wlog_mmap_append_imp(__wlog_mmap_ctx_t* pCtx, unsigned int nType, const char* pRecord, size_t nLen) {
+	#if WLOG_STATS
+		unsigned long long nStatsStart = __wlog_stats_now_ns();
+	#endif
+	unsigned long nPos = __atomic_fetch_add(&pCtx->nTail, (unsigned long)nLen, __ATOMIC_SEQ_CST);
+	if (__atomic_load_n(&pCtx->bClosed, __ATOMIC_SEQ_CST)) return;
+	unsigned long nMapped = __atomic_load_n(&pCtx->nMapped, __ATOMIC_ACQUIRE);
+	if (nPos + nLen > nMapped) {
+		if (!__wlog_mmap_extend_imp(pCtx, nPos + nLen)) {
+			__wlog_mmap_drop_imp(pCtx, nPos);
+			return;
+		}
+	} else if (nPos < nMapped - WLOG_MMAP_CHUNK_SIZE / 2 && nPos + nLen >= nMapped - WLOG_MMAP_CHUNK_SIZE / 2) {
+		__wlog_mmap_extend_imp(pCtx, nMapped + 1);
+	}
+	memcpy(pCtx->pBase + nPos, pRecord, nLen);
+	if (nType & WLOG_FLUSH_SYNC_TYPES) {
+		unsigned long nPage = (unsigned long)sysconf(_SC_PAGESIZE);
+		unsigned long nStart = nPos / nPage * nPage;
+		msync(pCtx->pBase + nStart, nPos + nLen - nStart, MS_SYNC);
+	}
+	#if WLOG_STATS
+		__wlog_stats_write_imp(nStatsStart, (long)nLen);
+	#endif
+}
+
+//正常退出：不再接受新日志，把文件截到实际长度。映射保留到进程结束，仍在memcpy的线程不会出错
+inline void __wlog_mmap_exit_imp() {
+	__wlog_mmap_ctx_t* pCtx = __wlog_mmap_ctx();
+	__atomic_store_n(&pCtx->bClosed, 1, __ATOMIC_SEQ_CST);
+	unsigned long nEnd = __atomic_load_n(&pCtx->nTail, __ATOMIC_SEQ_CST);
+	pthread_mutex_lock(&pCtx->hMutex);
+	if (nEnd > pCtx->nDropPos) nEnd = pCtx->nDropPos;
+	if (nEnd > pCtx->nMapped) nEnd = pCtx->nMapped;
+	int nRet = ftruncate(pCtx->hFile, pCtx->nOrigin + (off_t)nEnd);
+	(void)nRet;
+	pthread_mutex_unlock(&pCtx->hMutex);
+}
+
+inline void __wlog_mmap_init_imp() {
+	__wlog_mmap_ctx_t* pCtx = __wlog_mmap_ctx();
+	WLOG_CHECK_FILE_EXIST;
+	int hFile = open(WLOG_FILE_NAME, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+	if (hFile < 0) return;
+	off_t nEnd = __wlog_mmap_recover_imp(hFile);
+	off_t nPage = (off_t)sysconf(_SC_PAGESIZE);
+	void* pBase = mmap(NULL, WLOG_MMAP_RESERVE_SIZE, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+	if (MAP_FAILED == pBase) {
+		close(hFile);
+		return;
+	}
+	pCtx->hFile = hFile;
+	pCtx->nOrigin = nEnd / nPage * nPage;
+	pCtx->nTail = (unsigned long)(nEnd - pCtx->nOrigin);
+	pCtx->nLimit = WLOG_MMAP_RESERVE_SIZE;
+	pCtx->pBase = (char*)pBase;
+	atexit(__wlog_mmap_exit_imp);
+	#if !WLOG_JSON
+		__wlog_mmap_append_imp(pCtx, 0, _T("\n++++++++++WLOG+++++++++++\n"), 27);
+	#endif
+}
+
+//打开失败时返回NULL
+inline __wlog_mmap_ctx_t* __wlog_mmap_start() {
+	static pthread_once_t g_wlogMmapOnce = PTHREAD_ONCE_INIT;
+	pthread_once(&g_wlogMmapOnce, __wlog_mmap_init_imp);
+	__wlog_mmap_ctx_t* pCtx = __wlog_mmap_ctx();
+	return (NULL == pCtx->pBase) ? NULL : pCtx;
+}
+
+inline void __wlog_sink_write_imp(unsigned int nType, const char* pRecord, size_t nLen) {
+	__wlog_mmap_ctx_t* pCtx = __wlog_mmap_start();
+	if (0 == nLen) return;
+	if (NULL == pCtx) {
+		#if WLOG_STATS
+			__wlog_stats_write_imp(__wlog_stats_now_ns(), -1);
+		#endif
+		return;
+	}
+	__wlog_mmap_append_imp(pCtx, nType, pRecord, nLen);
+}
+
+inline void __wlog_mmap_write_imp(unsigned int nType, const char* format, ...) {
+	char szStack[WLOG_MAX_BUFFER_SIZE];
+	__wlog_arena_text_t text;
+	va_list arglist;
+	va_start(arglist, format);
+	int nLen = __wlog_arena_vformat(&text, szStack, sizeof(szStack), format, arglist);
+	va_end(arglist);
+	if (nLen >= 0) __wlog_sink_write_imp(nType, text.pData, (size_t)nLen);
+	__wlog_arena_text_free(&text);
+}
+
+inline void __wlog_mmap_flush_imp() {
+	__wlog_mmap_ctx_t* pCtx = __wlog_mmap_ctx();
+	if (NULL == pCtx->pBase) return;
+	msync(pCtx->pBase, __atomic_load_n(&pCtx->nMapped, __ATOMIC_ACQUIRE), MS_ASYNC);
+}
+
+//超出WLOG_MMAP_RESERVE_SIZE或磁盘空间不足时累计丢弃的日志条数
+inline unsigned long wlogMmapDropped() {
+	return __atomic_load_n(&__wlog_mmap_ctx()->nDropped, __ATOMIC_RELAXED);
+}
+
+#define wlogFlush() __wlog_mmap_flush_imp()
+
+#endif //__WLOG_MMAP_H__
@@ -0,0 +1,353 @@
+#ifndef __WLOG_ROTATE_H__
+#define __WLOG_ROTATE_H__
+/**
+ * @file wlog_rotate.h
+ * @brief WLOG_TO_FILE按大小或按时间切换日志文件，由wlog_file.h自动包含，不要单独include.
+ * <pre>定义了WLOG_ROTATE_SIZE或WLOG_ROTATE_INTERVAL_SEC后启用，当前日志始终写在WLOG_FILE_NAME，
+        切换时把它改名为WLOG_FILE_NAME.年月日-时分秒(同一秒内再切换时后面加.01、.02...)，再打开新的WLOG_FILE_NAME。
+        改名、打开、关闭、压缩和删除旧文件都由后台线程完成，写日志的线程只是原子地取得当前文件，
+        不会等待这些系统调用；旧文件在最后一个正在写它的线程离开后才关闭，切换时不会丢日志。
+        后台线程每WLOG_ROTATE_CHECK_MS检查一次，文件达到WLOG_ROTATE_SIZE时写日志的线程会立即唤醒它，
+        所以文件实际大小会略大于WLOG_ROTATE_SIZE。
+        可在include <wlog.h>之前修改的“宏”配置：
+		1. WLOG_ROTATE_SIZE，当前文件超过多少字节就切换，0表示不按大小，默认0
+		2. WLOG_ROTATE_INTERVAL_SEC，按本地时间对齐的切换周期(秒)，如3600为每个整点、86400为每天零点，
+			0表示不按时间，默认0
+		3. WLOG_ROTATE_KEEP，最多保留多少个切换出来的旧文件，超出的从最旧的开始删除，0表示全部保留，默认7
+		4. WLOG_ROTATE_COMPRESS，定义成1时旧文件用zlib压缩成.gz，需要链接-lz，默认0
+		5. WLOG_ROTATE_CHECK_MS，后台线程的检查间隔，默认100
+		如每天零点或超过256M时切换，保留30个压缩后的旧文件：
+			#define WLOG_ROTATE_SIZE (256UL * 1024 * 1024)
+			#define WLOG_ROTATE_INTERVAL_SEC 86400
+			#define WLOG_ROTATE_KEEP 30
+			#define WLOG_ROTATE_COMPRESS 1
+		进程启动时会顺便压缩上次退出时还没来得及压缩的旧文件。
+	</pre>
+ * @os linux
+ */
+#ifdef _WIN32
+	#error "haven't implement!"
+#endif
+
+#include <pthread.h>
+#include <string.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <errno.h>
+#include <time.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#if WLOG_ROTATE_COMPRESS
+	#include <zlib.h>
+#endif
+
+#ifndef WLOG_ROTATE_SIZE
+	#define WLOG_ROTATE_SIZE 0
+#endif
+#ifndef WLOG_ROTATE_INTERVAL_SEC
+	#define WLOG_ROTATE_INTERVAL_SEC 0
+#endif
+#ifndef WLOG_ROTATE_KEEP
+	#define WLOG_ROTATE_KEEP 7
+#endif
+#ifndef WLOG_ROTATE_COMPRESS
+	#define WLOG_ROTATE_COMPRESS 0
+#endif
+#ifndef WLOG_ROTATE_CHECK_MS
+	#define WLOG_ROTATE_CHECK_MS 100
+#endif
+
+//一个日志文件，两个交替使用：后台线程打开下一个文件后原子地替换pCurrent
+typedef struct __wlog_rotate_seg_t {
+	FILE* hFile;
+	unsigned long nRefs;	//正在写这个文件的线程数
+	unsigned long nSize;
+	long nPeriod;			//所属的WLOG_ROTATE_INTERVAL_SEC周期
+} __wlog_rotate_seg_t;
+
+typedef struct __wlog_rotate_ctx_t {
+	__wlog_rotate_seg_t* pCurrent;
+	__wlog_rotate_seg_t arrSegs[2];
+	int bReopen;			//写失败，由后台线程重新打开
+	int bWake;				//当前文件已经超过WLOG_ROTATE_SIZE，已通知过后台线程
+	pthread_mutex_t hMutex;	//只在第一次打开和唤醒后台线程时使用
+	pthread_cond_t hCond;
+	char szDir[PATH_MAX];
+	char szBase[NAME_MAX + 1];
+} __wlog_rotate_ctx_t;
+
+inline __wlog_rotate_ctx_t* __wlog_rotate_ctx() {
+	static __wlog_rotate_ctx_t g_wlogRotateCtx = {NULL, {{NULL, 0, 0, 0}, {NULL, 0, 0, 0}}, 0, 0,
+		PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, {0}, {0}};
+	return &g_wlogRotateCtx;
+}
+
+inline long __wlog_rotate_period(time_t nTime) {
+	#if (WLOG_ROTATE_INTERVAL_SEC > 0)
+		struct tm tmNow;
+		if (NULL == localtime_r(&nTime, &tmNow)) return 0;
+		return (long)((nTime + tmNow.tm_gmtoff) / WLOG_ROTATE_INTERVAL_SEC);
+	#else
+		(void)nTime;
+		return 0;
+	#endif
+}
+
+//旧文件名是szBase后面跟'.'和8位日期
+inline size_t __wlog_rotate_match(const char* szName) {
+	__wlog_rotate_ctx_t* pCtx = __wlog_rotate_ctx();
+	size_t nBase = strlen(pCtx->szBase);
+	if (0 != strncmp(szName, pCtx->szBase, nBase) || '.' != szName[nBase]) return 0;
+	size_t nIdx = 1;
+	for (; nIdx <= 8; ++nIdx) {
+		if (szName[nBase + nIdx] < '0' || szName[nBase + nIdx] > '9') return 0;
+	}
+	return strlen(szName);
+}
+
+//按去掉".gz"后的文件名排序，也就是按切换的先后
+inline size_t __wlog_rotate_key_len(const char* szName) {
+	size_t nLen = strlen(szName);
+	return (nLen > 3 && 0 == strcmp(szName + nLen - 3, ".gz")) ? nLen - 3 : nLen;
+}
+inline int __wlog_rotate_compare(const void* pLeft, const void* pRight) {
+	const char* szLeft = *(const char* const*)pLeft;
+	const char* szRight = *(const char* const*)pRight;
+	size_t nLeft = __wlog_rotate_key_len(szLeft), nRight = __wlog_rotate_key_len(szRight);
+	int nRet = strncmp(szLeft, szRight, nLeft < nRight ? nLeft : nRight);
+	if (0 != nRet) return nRet;
+	return (nLeft < nRight) ? -1 : (nLeft > nRight);
+}
+
+#if WLOG_ROTATE_COMPRESS
+	//压缩成功后删除原文件，失败时保留原文件，下次再试
+	inline void __wlog_rotate_compress_imp(const char* szPath) {
+		char szGz[PATH_MAX + NAME_MAX + 8];
+		snprintf(szGz, sizeof(szGz), "%s.gz", szPath);
+		FILE* hIn = fopen(szPath, "rb");
+		if (NULL == hIn) return;
+		gzFile hOut = gzopen(szGz, "wb6");
+		if (NULL == hOut) {
+			fclose(hIn);
+			return;
+		}
+		char szBuffer[64 * 1024];
+		size_t nRead;
+		int bOk = 1;
+		while (bOk && 0 < (nRead = fread(szBuffer, 1, sizeof(szBuffer), hIn))) {
+			bOk = (gzwrite(hOut, szBuffer, (unsigned int)nRead) == (int)nRead);
+		}
+		bOk = bOk && !ferror(hIn);
+		fclose(hIn);
+		bOk = (Z_OK == gzclose(hOut)) && bOk;
+		unlink(bOk ? szPath : szGz);
+	}
+#endif
+
+//删除超出WLOG_ROTATE_KEEP的旧文件，压缩剩下的未压缩的旧文件
+inline void __wlog_rotate_cleanup_imp() {
+	__wlog_rotate_ctx_t* pCtx = __wlog_rotate_ctx();
+	DIR* hDir = opendir(pCtx->szDir);
+	if (NULL == hDir) return;
+	char** ppNames = NULL;
+	size_t nCount = 0, nCapacity = 0;
+	struct dirent* pEntry;
+	while (NULL != (pEntry = readdir(hDir))) {
+		if (0 == __wlog_rotate_match(pEntry->d_name)) continue;
+		if (nCount == nCapacity) {
+			size_t nNew = nCapacity ? nCapacity * 2 : 64;
+			char** ppNew = (char**)realloc(ppNames, nNew * sizeof(char*));
+			if (NULL == ppNew) break;
+			ppNames = ppNew;
+			nCapacity = nNew;
+		}
+		if (NULL != (ppNames[nCount] = strdup(pEntry->d_name))) ++nCount;
+	}
+	closedir(hDir);
+	qsort(ppNames, nCount, sizeof(char*), __wlog_rotate_compare);
+	char szPath[PATH_MAX + NAME_MAX + 2];
+	size_t nIdx = 0;
+	for (; nIdx < nCount; ++nIdx) {
+		snprintf(szPath, sizeof(szPath), "%s/%s", pCtx->szDir, ppNames[nIdx]);
+		if (WLOG_ROTATE_KEEP > 0 && nIdx + WLOG_ROTATE_KEEP < nCount) {
+			unlink(szPath);
+		}
+		#if WLOG_ROTATE_COMPRESS
+			else if (__wlog_rotate_key_len(ppNames[nIdx]) == strlen(ppNames[nIdx])) {
+				__wlog_rotate_compress_imp(szPath);
+			}
+		#endif
+		free(ppNames[nIdx]);
+	}
+	free(ppNames);
+}
+
+//把当前文件改名，成功返回1；当前文件已经不存在时返回1，szRotated为空
+inline int __wlog_rotate_rename_imp(time_t nNow, char* szRotated, size_t nSize) {
+	struct tm tmNow;
+	localtime_r(&nNow, &tmNow);
+	int nLen = snprintf(szRotated, nSize, "%s.%04d%02d%02d-%02d%02d%02d", WLOG_FILE_NAME, tmNow.tm_year + 1900,
+		tmNow.tm_mon + 1, tmNow.tm_mday, tmNow.tm_hour, tmNow.tm_min, tmNow.tm_sec);
+	if (nLen < 0 || (size_t)nLen + 7 >= nSize) return 0;
+	char szGz[PATH_MAX + 4];
+	unsigned int nSeq = 0;
+	for (;;) {
+		snprintf(szGz, sizeof(szGz), "%s.gz", szRotated);
+		if (0 != access(szRotated, F_OK) && 0 != access(szGz, F_OK)) break;
+		if (++nSeq > 99) return 0;
+		snprintf(szRotated + nLen, nSize - nLen, ".%02u", nSeq);
+	}
+	if (0 == rename(WLOG_FILE_NAME, szRotated)) return 1;
+	szRotated[0] = 0;
+	return (ENOENT == errno);
+}
+
+//后台线程里执行：打开新文件、替换当前文件，等所有线程写完旧文件后关闭它
+inline void __wlog_rotate_switch_imp(__wlog_rotate_seg_t* pSeg, int bRotate, time_t nNow) {
+	__wlog_rotate_ctx_t* pCtx = __wlog_rotate_ctx();
+	char szRotated[PATH_MAX];
+	szRotated[0] = 0;
+	if (bRotate && !__wlog_rotate_rename_imp(nNow, szRotated, sizeof(szRotated))) return;
+	__wlog_rotate_seg_t* pNext = (pSeg == &pCtx->arrSegs[0]) ? &pCtx->arrSegs[1] : &pCtx->arrSegs[0];
+	pNext->hFile = __wlog_file_fopen_imp();
+	if (NULL == pNext->hFile) {
+		__atomic_store_n(&pCtx->bReopen, 1, __ATOMIC_RELAXED);
+		return;
+	}
+	pNext->nSize = 0;
+	pNext->nPeriod = __wlog_rotate_period(nNow);
+	#if WLOG_BINARY
+		__wlog_bin_session_begin_imp(pNext->hFile);
+	#else
+		__wlog_file_begin_imp(pNext->hFile);
+	#endif
+	fflush(pNext->hFile);
+	__atomic_store_n(&pCtx->bWake, 0, __ATOMIC_RELAXED);
+	__atomic_store_n(&pCtx->pCurrent, pNext, __ATOMIC_SEQ_CST);
+	#if WLOG_BINARY
+		__wlog_bin_session_end_imp();
+	#endif
+	while (0 != __atomic_load_n(&pSeg->nRefs, __ATOMIC_SEQ_CST)) {
+		usleep(1000);
+	}
+	fclose(pSeg->hFile);
+	pSeg->hFile = NULL;
+	if (szRotated[0]) {
+		__wlog_rotate_cleanup_imp();
+	}
+}
+
+inline void* __wlog_rotate_thread_imp(void* pArg) {
+	(void)pArg;
+	__wlog_rotate_ctx_t* pCtx = __wlog_rotate_ctx();
+	__wlog_rotate_cleanup_imp();
+	for (;;) {
+		struct timespec tsWait;
+		clock_gettime(CLOCK_REALTIME, &tsWait);
+		tsWait.tv_sec += WLOG_ROTATE_CHECK_MS / 1000;
+		tsWait.tv_nsec += (WLOG_ROTATE_CHECK_MS % 1000) * 1000000L;
+		if (tsWait.tv_nsec >= 1000000000L) {
+			++tsWait.tv_sec;
+			tsWait.tv_nsec -= 1000000000L;
+		}
+		pthread_mutex_lock(&pCtx->hMutex);
+		pthread_cond_timedwait(&pCtx->hCond, &pCtx->hMutex, &tsWait);
+		pthread_mutex_unlock(&pCtx->hMutex);
+
+		__wlog_rotate_seg_t* pSeg = __atomic_load_n(&pCtx->pCurrent, __ATOMIC_ACQUIRE);
+		time_t nNow = time(NULL);
+		int bRotate = 0;
+		#if (WLOG_ROTATE_SIZE > 0)
+			bRotate = bRotate || (__atomic_load_n(&pSeg->nSize, __ATOMIC_RELAXED) >= (unsigned long)WLOG_ROTATE_SIZE);
+		#endif
+		#if (WLOG_ROTATE_INTERVAL_SEC > 0)
+			bRotate = bRotate || (__wlog_rotate_period(nNow) != pSeg->nPeriod);
+		#endif
+		if (bRotate || __atomic_exchange_n(&pCtx->bReopen, 0, __ATOMIC_RELAXED)) {
+			__wlog_rotate_switch_imp(pSeg, bRotate, nNow);
+		}
+	}
+	return NULL;
+}
+
+inline void __wlog_rotate_start_imp() {
+	__wlog_rotate_ctx_t* pCtx = __wlog_rotate_ctx();
+	const char* szSlash = strrchr(WLOG_FILE_NAME, '/');
+	if (NULL == szSlash) {
+		strcpy(pCtx->szDir, ".");
+		snprintf(pCtx->szBase, sizeof(pCtx->szBase), "%s", WLOG_FILE_NAME);
+	} else {
+		snprintf(pCtx->szDir, sizeof(pCtx->szDir), "%.*s", (int)(szSlash - WLOG_FILE_NAME), WLOG_FILE_NAME);
+		if (0 == pCtx->szDir[0]) strcpy(pCtx->szDir, "/");
+		snprintf(pCtx->szBase, sizeof(pCtx->szBase), "%s", szSlash + 1);
+	}
+	pthread_t hThread;
+	if (0 == pthread_create(&hThread, NULL, __wlog_rotate_thread_imp, NULL)) {
+		pthread_detach(hThread);
+	}
+}
+
+//第一次写日志时打开文件，返回0表示打不开；已经存在的文件按它的修改时间算周期，启动后可能立即切换
+inline int __wlog_rotate_open_imp() {
+	__wlog_rotate_ctx_t* pCtx = __wlog_rotate_ctx();
+	pthread_mutex_lock(&pCtx->hMutex);
+	if (NULL == pCtx->pCurrent) {
+		__wlog_rotate_seg_t* pSeg = &pCtx->arrSegs[0];
+		__wlog_file_open_imp(&pSeg->hFile);
+		if (NULL != pSeg->hFile) {
+			struct stat stFile;
+			time_t nTime = time(NULL);
+			pSeg->nSize = 0;
+			if (0 == fstat(fileno(pSeg->hFile), &stFile)) {
+				pSeg->nSize = (unsigned long)stFile.st_size;
+				if (stFile.st_size > 0) nTime = stFile.st_mtime;
+			}
+			pSeg->nPeriod = __wlog_rotate_period(nTime);
+			__atomic_store_n(&pCtx->pCurrent, pSeg, __ATOMIC_SEQ_CST);
+			static pthread_once_t g_wlogRotateOnce = PTHREAD_ONCE_INIT;
+			pthread_once(&g_wlogRotateOnce, __wlog_rotate_start_imp);
+		}
+	}
+	pthread_mutex_unlock(&pCtx->hMutex);
+	return NULL != __atomic_load_n(&pCtx->pCurrent, __ATOMIC_ACQUIRE);
+}
+
+//先登记再确认它仍是当前文件，后台线程替换pCurrent后只需等旧文件的nRefs归零
+inline FILE* __wlog_file_acquire_imp(int bOpen) {
+	__wlog_rotate_ctx_t* pCtx = __wlog_rotate_ctx();
+	__wlog_rotate_seg_t* pSeg;
+	for (;;) {
+		pSeg = __atomic_load_n(&pCtx->pCurrent, __ATOMIC_SEQ_CST);
+		if (NULL == pSeg) {
+			if (!bOpen || !__wlog_rotate_open_imp()) return NULL;
+			continue;
+		}
+		__atomic_fetch_add(&pSeg->nRefs, 1, __ATOMIC_SEQ_CST);
+		if (pSeg == __atomic_load_n(&pCtx->pCurrent, __ATOMIC_SEQ_CST)) break;
+		__atomic_fetch_sub(&pSeg->nRefs, 1, __ATOMIC_SEQ_CST);
+	}
+	return pSeg->hFile;
+}
+//写失败时由后台线程重新打开
+inline void __wlog_file_release_imp(FILE* hFile, long nWritten) {
+	__wlog_rotate_ctx_t* pCtx = __wlog_rotate_ctx();
+	__wlog_rotate_seg_t* pSeg = (hFile == pCtx->arrSegs[0].hFile) ? &pCtx->arrSegs[0] : &pCtx->arrSegs[1];
+	if (nWritten < 0) {
+		__atomic_store_n(&pCtx->bReopen, 1, __ATOMIC_RELAXED);
+	} else {
+		__atomic_fetch_add(&pSeg->nSize, (unsigned long)nWritten, __ATOMIC_RELAXED);
+	}
+	#if (WLOG_ROTATE_SIZE > 0)
+		//已被替换的旧文件不再通知，否则bWake会挡住新文件的通知
+		if (__atomic_load_n(&pSeg->nSize, __ATOMIC_RELAXED) >= (unsigned long)WLOG_ROTATE_SIZE
+			&& pSeg == __atomic_load_n(&pCtx->pCurrent, __ATOMIC_ACQUIRE) && !__atomic_exchange_n(&pCtx->bWake, 1, __ATOMIC_RELAXED)) {
+			pthread_mutex_lock(&pCtx->hMutex);
+			pthread_cond_signal(&pCtx->hCond);
+			pthread_mutex_unlock(&pCtx->hMutex);
+		}
+	#endif
+	__atomic_fetch_sub(&pSeg->nRefs, 1, __ATOMIC_SEQ_CST);
+}
+
+#endif //__WLOG_ROTATE_H__
@@ -0,0 +1,474 @@
+#ifndef __WLOG_SHM_H__
+#define __WLOG_SHM_H__
+/**
+ * @file wlog_shm.h
+ * @brief WLOG_TO_SHM共享内存环形队列输出与收集进程，由wlog.h自动包含，不要单独include.
+ * <pre>同一台机器上多个进程写同一个日志文件时，每个进程有自己的stdio缓冲，日志会被截断、交错，每个进程也都要做I/O。
+        WLOG_TO_SHM下日志只格式化进POSIX共享内存WLOG_SHM_NAME里的无锁多生产者环形队列，写日志的进程不碰文件系统；
+        由一个收集进程(tools/wlog_collect，或在自己的程序里定义WLOG_SHM_COLLECTOR后调用wlogShmCollect)按顺序取出，
+        写进WLOG_FILE_NAME，切换、刷新等仍按WLOG_ROTATE_XXX、WLOG_FLUSH_XXX。
+        队列与wlog_async.h相同：固定大小的槽位，每个槽位一个序号，长日志占用连续多个槽位。
+        队列满(收集进程没有运行或跟不上)时直接丢弃并计数，写日志的进程从不等待收集进程，
+        收集进程会补写一行"WLOG SHM DROPPED n RECORDS"，写日志的进程可用wlogShmDropped()读取累计值。
+        写日志的进程在写一条日志的中途崩溃时，占用的槽位不会写好：收集进程发现占用它的进程已经不在，
+        或者等了WLOG_SHM_TORN_MS还没写好，就跳过这条日志(含它的其他槽位)，并补写一行"WLOG SHM SKIPPED n TORN SLOTS"。
+        logFatal、logVerify、logAssert和wlogFlush()会等收集进程把已经放进队列的日志写进文件，最多WLOG_SHM_FLUSH_TIMEOUT_MS。
+        只能有一个收集进程。不支持WLOG_BINARY，不支持与控制台同时输出。
+        可在include <wlog.h>之前修改的“宏”配置：
+		1. WLOG_SHM_NAME，共享内存的名字，写日志的进程与收集进程要相同，默认"/wlog.default"
+		2. WLOG_SHM_SLOT_COUNT，槽位数，必须是2的幂，默认8192
+		3. WLOG_SHM_RECORD_SIZE，每个槽位的大小，默认WLOG_MAX_BUFFER_SIZE；这两项所有进程也要相同，不同时打不开
+		4. WLOG_SHM_TORN_MS，没写好的槽位最多等多久，默认2000
+		5. WLOG_SHM_FLUSH_TIMEOUT_MS，wlogFlush()等待收集进程的最长时间，默认1000
+		6. WLOG_SHM_COLLECTOR，WLOG_TO_FILE下定义成1后提供收集进程的函数wlogShmOpen()、wlogShmDrain()、wlogShmCollect()
+	</pre>
+ * @os linux
+ */
+#ifdef _WIN32
+	#error "haven't implement!"
+#endif
+#if WLOG_BINARY
+	#error "WLOG_TO_SHM can't be used with WLOG_BINARY!"
+#endif
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+
+#ifndef WLOG_SHM_NAME
+	#define WLOG_SHM_NAME "/wlog.default"
+#endif
+#ifndef WLOG_SHM_SLOT_COUNT
+	#define WLOG_SHM_SLOT_COUNT 8192
+#endif
+#if (WLOG_SHM_SLOT_COUNT & (WLOG_SHM_SLOT_COUNT - 1))
+	#error "WLOG_SHM_SLOT_COUNT must be power of 2!"
+#endif
+#ifndef WLOG_SHM_RECORD_SIZE
+	#define WLOG_SHM_RECORD_SIZE WLOG_MAX_BUFFER_SIZE
+#endif
+#if (WLOG_SHM_RECORD_SIZE % 8)
+	#error "WLOG_SHM_RECORD_SIZE must be a multiple of 8!"
+#endif
+#ifndef WLOG_SHM_TORN_MS
+	#define WLOG_SHM_TORN_MS 2000
+#endif
+#ifndef WLOG_SHM_FLUSH_TIMEOUT_MS
+	#define WLOG_SHM_FLUSH_TIMEOUT_MS 1000
+#endif
+
+#define WLOG_SHM_MAGIC "WLOGSHM1"
+
+//共享内存里的布局，32位与64位进程可以共用
+typedef struct __wlog_shm_slot_t {
+	uint64_t nSeq;			//等于位置号时空闲或正在写，等于位置号+1时已写好
+	uint32_t nLen;
+	uint32_t nType;
+	uint32_t nPart;			//是这条日志的第几个槽位，从0开始
+	uint32_t nParts;		//这条日志一共几个槽位
+	int32_t nPid;			//占用它的进程，收集进程释放时清0
+	uint32_t nReserved;
+	char szData[WLOG_SHM_RECORD_SIZE];
+} __wlog_shm_slot_t;
+
+typedef struct __wlog_shm_head_t {
+	char szMagic[8];
+	uint32_t nSlotCount;
+	uint32_t nRecordSize;
+	uint32_t nState;		//0未初始化，1正在初始化，2可以使用
+	int32_t nCollector;		//收集进程
+	uint32_t nWake;			//收集进程睡眠时为1，写日志的进程看到后futex唤醒它
+	uint32_t nFlushReq;		//wlogFlush()的请求次数
+	uint64_t nEnqueuePos __attribute__((aligned(64)));
+	uint64_t nDequeuePos __attribute__((aligned(64)));
+	uint64_t nFlushedPos;	//收集进程已经写进文件并刷新的位置
+	uint64_t nDropped;
+	uint64_t nDroppedTotal;
+} __wlog_shm_head_t;
+
+#define __wlog_shm_slots(pHead) ((__wlog_shm_slot_t*)((char*)(pHead) + sizeof(__wlog_shm_head_t)))
+#define __WLOG_SHM_MAP_SIZE (sizeof(__wlog_shm_head_t) + (size_t)WLOG_SHM_SLOT_COUNT * sizeof(__wlog_shm_slot_t))
+
+inline long __wlog_shm_futex(uint32_t* pWord, int nOp, uint32_t nValue, const struct timespec* pTimeout) {
+	return syscall(SYS_futex, pWord, nOp, nValue, pTimeout, NULL, 0);
+}
+
+inline void __wlog_shm_init_imp(__wlog_shm_head_t* pHead) {
+	__wlog_shm_slot_t* pSlots = __wlog_shm_slots(pHead);
+	uint64_t nIdx = 0;
+	for (; nIdx < WLOG_SHM_SLOT_COUNT; ++nIdx) {
+		pSlots[nIdx].nPid = 0;
+		__atomic_store_n(&pSlots[nIdx].nSeq, nIdx, __ATOMIC_RELAXED);
+	}
+	memcpy(pHead->szMagic, WLOG_SHM_MAGIC, 8);
+	pHead->nSlotCount = WLOG_SHM_SLOT_COUNT;
+	pHead->nRecordSize = WLOG_SHM_RECORD_SIZE;
+	__atomic_store_n(&pHead->nState, 2, __ATOMIC_RELEASE);
+}
+
+//打开或创建共享内存，第一个打开的进程初始化；大小或配置不同时返回NULL
+inline __wlog_shm_head_t* __wlog_shm_map_imp(const char* szName) {
+	int hShm = shm_open(szName, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+	if (hShm < 0) return NULL;
+	struct stat stShm;
+	if (0 != fstat(hShm, &stShm) || (0 != stShm.st_size && (size_t)stShm.st_size != __WLOG_SHM_MAP_SIZE)
+		|| (0 == stShm.st_size && 0 != ftruncate(hShm, (off_t)__WLOG_SHM_MAP_SIZE))) {
+		close(hShm);
+		return NULL;
+	}
+	void* pMap = mmap(NULL, __WLOG_SHM_MAP_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, hShm, 0);
+	close(hShm);
+	if (MAP_FAILED == pMap) return NULL;
+	__wlog_shm_head_t* pHead = (__wlog_shm_head_t*)pMap;
+	uint32_t nState = 0;
+	if (__atomic_compare_exchange_n(&pHead->nState, &nState, 1, 0, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE)) {
+		__wlog_shm_init_imp(pHead);
+	} else {
+		//别的进程正在初始化；它在初始化中途退出时，还没有进程用过队列，由这里重新初始化
+		unsigned int nWaitMs = 0;
+		while (2 != __atomic_load_n(&pHead->nState, __ATOMIC_ACQUIRE)) {
+			if (++nWaitMs > 1000) {
+				__wlog_shm_init_imp(pHead);
+				break;
+			}
+			usleep(1000);
+		}
+	}
+	if (0 != memcmp(pHead->szMagic, WLOG_SHM_MAGIC, 8) || WLOG_SHM_SLOT_COUNT != pHead->nSlotCount
+		|| WLOG_SHM_RECORD_SIZE != pHead->nRecordSize) {
+		munmap(pMap, __WLOG_SHM_MAP_SIZE);
+		return NULL;
+	}
+	return pHead;
+}
+
+#if (WLOG_TO == WLOG_TO_SHM)
+	typedef struct __wlog_shm_ctx_t {
+		__wlog_shm_head_t* pHead;
+		int32_t nPid;
+	} __wlog_shm_ctx_t;
+
+	inline __wlog_shm_ctx_t* __wlog_shm_ctx() {
+		static __wlog_shm_ctx_t g_wlogShmCtx = {NULL, 0};
+		return &g_wlogShmCtx;
+	}
+
+	//fork出的子进程继续用同一块共享内存，只是进程号变了
+	inline void __wlog_shm_atfork_child_imp() {
+		__wlog_shm_ctx()->nPid = (int32_t)getpid();
+	}
+
+	inline void __wlog_shm_open_imp() {
+		__wlog_shm_ctx_t* pCtx = __wlog_shm_ctx();
+		pCtx->nPid = (int32_t)getpid();
+		pthread_atfork(NULL, NULL, __wlog_shm_atfork_child_imp);
+		__atomic_store_n(&pCtx->pHead, __wlog_shm_map_imp(WLOG_SHM_NAME), __ATOMIC_RELEASE);
+	}
+
+	//打开失败时返回NULL
+	inline __wlog_shm_head_t* __wlog_shm_start() {
+		static pthread_once_t g_wlogShmOnce = PTHREAD_ONCE_INIT;
+		pthread_once(&g_wlogShmOnce, __wlog_shm_open_imp);
+		return __atomic_load_n(&__wlog_shm_ctx()->pHead, __ATOMIC_ACQUIRE);
+	}
+
+	//连续占用nSlots个槽位，队列满时返回0。收集进程按顺序释放槽位，所以只要最后一个槽位空闲，前面的也一定空闲
+	inline int __wlog_shm_reserve_imp(__wlog_shm_head_t* pHead, uint64_t nSlots, uint64_t* pPos) {
+		__wlog_shm_slot_t* pSlots = __wlog_shm_slots(pHead);
+		uint64_t nPos = __atomic_load_n(&pHead->nEnqueuePos, __ATOMIC_RELAXED);
+		for (;;) {
+			uint64_t nLast = nPos + nSlots - 1;
+			int64_t nDiff = (int64_t)(__atomic_load_n(&pSlots[nLast & (WLOG_SHM_SLOT_COUNT - 1)].nSeq, __ATOMIC_ACQUIRE) - nLast);
+			if (nDiff == 0) {
+				if (__atomic_compare_exchange_n(&pHead->nEnqueuePos, &nPos, nPos + nSlots, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+					*pPos = nPos;
+					return 1;
+				}
+			} else if (nDiff < 0) {
+				__atomic_fetch_add(&pHead->nDropped, 1, __ATOMIC_RELAXED);
+				__atomic_fetch_add(&pHead->nDroppedTotal, 1, __ATOMIC_RELAXED);
+				#if WLOG_STATS
+					__wlog_stats_drop_imp();
+				#endif
+				return 0;
+			} else {
+				nPos = __atomic_load_n(&pHead->nEnqueuePos, __ATOMIC_RELAXED);
+			}
+		}
+	}
+
+	inline void __wlog_shm_notify_imp(__wlog_shm_head_t* pHead) {
+		__atomic_thread_fence(__ATOMIC_SEQ_CST);
+		if (__atomic_load_n(&pHead->nWake, __ATOMIC_RELAXED)) {
+			__wlog_shm_futex(&pHead->nWake, FUTEX_WAKE, 1, NULL);
+		}
+	}
+
+	//已经格式化好的整条日志，超过WLOG_SHM_RECORD_SIZE时占用连续多个槽位，收集进程按顺序拼接
+	inline void __wlog_sink_write_imp(unsigned int nType, const char* pRecord, size_t nLen) {
+		uint64_t nSlots = (uint64_t)((nLen + WLOG_SHM_RECORD_SIZE - 1) / WLOG_SHM_RECORD_SIZE);
+		if (0 == nSlots) return;
+		if (nSlots > WLOG_SHM_SLOT_COUNT / 2) {
+			nSlots = WLOG_SHM_SLOT_COUNT / 2;
+			nLen = (size_t)nSlots * WLOG_SHM_RECORD_SIZE;
+		}
+		#if WLOG_STATS
+			unsigned long long nStatsStart = __wlog_stats_now_ns();
+		#endif
+		__wlog_shm_head_t* pHead = __wlog_shm_start();
+		if (NULL == pHead) {
+			#if WLOG_STATS
+				__wlog_stats_write_imp(nStatsStart, -1);
+			#endif
+			return;
+		}
+		uint64_t nPos = 0;
+		if (!__wlog_shm_reserve_imp(pHead, nSlots, &nPos)) return;
+		#if WLOG_STATS
+			long nWritten = (long)nLen;
+		#endif
+		__wlog_shm_slot_t* pSlots = __wlog_shm_slots(pHead);
+		int32_t nPid = __wlog_shm_ctx()->nPid;
+		uint64_t nIdx = 0;
+		for (; nIdx < nSlots; ++nIdx) {
+			size_t nPart = (nLen > WLOG_SHM_RECORD_SIZE) ? WLOG_SHM_RECORD_SIZE : nLen;
+			__wlog_shm_slot_t* pSlot = &pSlots[(nPos + nIdx) & (WLOG_SHM_SLOT_COUNT - 1)];
+			__atomic_store_n(&pSlot->nPid, nPid, __ATOMIC_RELAXED);
+			pSlot->nType = nType;
+			pSlot->nLen = (uint32_t)nPart;
+			pSlot->nPart = (uint32_t)nIdx;
+			pSlot->nParts = (uint32_t)nSlots;
+			memcpy(pSlot->szData, pRecord, nPart);
+			//收集进程认为这个槽位写坏了而跳过时，序号已经变了，这里不能再改
+			uint64_t nExpect = nPos + nIdx;
+			__atomic_compare_exchange_n(&pSlot->nSeq, &nExpect, nPos + nIdx + 1, 0, __ATOMIC_RELEASE, __ATOMIC_RELAXED);
+			pRecord += nPart;
+			nLen -= nPart;
+		}
+		__wlog_shm_notify_imp(pHead);
+		#if WLOG_STATS
+			__wlog_stats_write_imp(nStatsStart, nWritten);
+		#endif
+	}
+
+	inline void __wlog_shm_write_imp(unsigned int nType, const char* format, ...) {
+		char szStack[WLOG_MAX_BUFFER_SIZE];
+		__wlog_arena_text_t text;
+		va_list arglist;
+		va_start(arglist, format);
+		int nLen = __wlog_arena_vformat(&text, szStack, sizeof(szStack), format, arglist);
+		va_end(arglist);
+		if (nLen >= 0) __wlog_sink_write_imp(nType, text.pData, (size_t)nLen);
+		__wlog_arena_text_free(&text);
+	}
+
+	//等收集进程把当前已进入队列的日志写进文件并刷新，没有收集进程时直接返回
+	inline void __wlog_shm_flush_imp() {
+		__wlog_shm_head_t* pHead = __atomic_load_n(&__wlog_shm_ctx()->pHead, __ATOMIC_ACQUIRE);
+		if (NULL == pHead) return;
+		uint64_t nTarget = __atomic_load_n(&pHead->nEnqueuePos, __ATOMIC_ACQUIRE);
+		__atomic_fetch_add(&pHead->nFlushReq, 1, __ATOMIC_SEQ_CST);
+		unsigned int nWaitMs = 0;
+		while ((int64_t)(__atomic_load_n(&pHead->nFlushedPos, __ATOMIC_ACQUIRE) - nTarget) < 0 && nWaitMs < WLOG_SHM_FLUSH_TIMEOUT_MS) {
+			int32_t nCollector = __atomic_load_n(&pHead->nCollector, __ATOMIC_RELAXED);
+			if (0 == nCollector || (0 != kill(nCollector, 0) && ESRCH == errno)) return;
+			__wlog_shm_futex(&pHead->nWake, FUTEX_WAKE, 1, NULL);
+			usleep(1000);
+			++nWaitMs;
+		}
+	}
+
+	//队列满时累计丢弃的日志条数，所有写日志的进程一起计数
+	inline unsigned long wlogShmDropped() {
+		__wlog_shm_head_t* pHead = __wlog_shm_start();
+		return (NULL == pHead) ? 0 : (unsigned long)__atomic_load_n(&pHead->nDroppedTotal, __ATOMIC_RELAXED);
+	}
+
+	#define wlogFlush() __wlog_shm_flush_imp()
+	#undef WLOG_ASYNC_DRAIN_CHECK
+	#define WLOG_ASYNC_DRAIN_CHECK(nType) if ((nType) & (WLOG_TYPE_VERIFY | WLOG_TYPE_ASSERT | WLOG_TYPE_FATAL)) __wlog_shm_flush_imp()
+#elif WLOG_SHM_COLLECTOR
+	typedef struct __wlog_shm_collector_t {
+		__wlog_shm_head_t* pHead;
+		uint64_t nStallPos;			//等待写好的槽位
+		unsigned long nStallSinceMs;
+		uint32_t nFlushSeen;
+		unsigned long nTorn;		//还没写进文件的跳过的槽位数
+	} __wlog_shm_collector_t;
+
+	inline __wlog_shm_collector_t* __wlog_shm_collector() {
+		static __wlog_shm_collector_t g_wlogShmCollector = {NULL, 0, 0, 0, 0};
+		return &g_wlogShmCollector;
+	}
+
+	//释放nPos处的槽位；它可能还没写好(写坏了被跳过)，这时生产者再写好也不能改序号
+	inline void __wlog_shm_release_imp(__wlog_shm_slot_t* pSlot, uint64_t nPos) {
+		__atomic_store_n(&pSlot->nPid, 0, __ATOMIC_RELAXED);
+		uint64_t nExpect = nPos;
+		if (!__atomic_compare_exchange_n(&pSlot->nSeq, &nExpect, nPos + WLOG_SHM_SLOT_COUNT, 0, __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+			__atomic_store_n(&pSlot->nSeq, nPos + WLOG_SHM_SLOT_COUNT, __ATOMIC_RELEASE);
+		}
+	}
+
+	//nPos处的槽位已经占用但还没写好：占用它的进程已经不在，或者等得太久，返回1表示当作写坏了跳过
+	inline int __wlog_shm_torn_imp(__wlog_shm_collector_t* pCollector, __wlog_shm_slot_t* pSlot, uint64_t nPos) {
+		unsigned long nNow = __wlog_flush_now_ms();
+		if (pCollector->nStallPos != nPos || 0 == pCollector->nStallSinceMs) {
+			pCollector->nStallPos = nPos;
+			pCollector->nStallSinceMs = nNow;
+			return 0;
+		}
+		int32_t nPid = __atomic_load_n(&pSlot->nPid, __ATOMIC_RELAXED);
+		if (0 != nPid && 0 != kill(nPid, 0) && ESRCH == errno) return 1;
+		return (nNow - pCollector->nStallSinceMs >= WLOG_SHM_TORN_MS);
+	}
+
+	//队列丢弃与跳过的条数补写成一行
+	inline void __wlog_shm_report_imp(__wlog_shm_collector_t* pCollector) {
+		char szLine[96];
+		unsigned long nDropped = (unsigned long)__atomic_exchange_n(&pCollector->pHead->nDropped, 0, __ATOMIC_RELAXED);
+		if (0 != nDropped) {
+			int nLen = snprintf(szLine, sizeof(szLine), _T("WLOG SHM DROPPED %lu RECORDS\n"), nDropped);
+			__wlog_sink_write_imp(WLOG_TYPE_TEXT, szLine, (size_t)nLen);
+		}
+		if (0 != pCollector->nTorn) {
+			int nLen = snprintf(szLine, sizeof(szLine), _T("WLOG SHM SKIPPED %lu TORN SLOTS\n"), pCollector->nTorn);
+			__wlog_sink_write_imp(WLOG_TYPE_TEXT, szLine, (size_t)nLen);
+			pCollector->nTorn = 0;
+		}
+	}
+
+	//打开共享内存并登记为收集进程，已经有别的收集进程在运行或打不开时返回0
+	inline int wlogShmOpen(const char* szName) {
+		__wlog_shm_collector_t* pCollector = __wlog_shm_collector();
+		if (NULL != pCollector->pHead) return 1;
+		__wlog_shm_head_t* pHead = __wlog_shm_map_imp(szName);
+		if (NULL == pHead) return 0;
+		int32_t nSelf = (int32_t)getpid();
+		int32_t nOld = __atomic_load_n(&pHead->nCollector, __ATOMIC_RELAXED);
+		for (;;) {
+			if (0 != nOld && nSelf != nOld && !(0 != kill(nOld, 0) && ESRCH == errno)) {
+				munmap(pHead, __WLOG_SHM_MAP_SIZE);
+				return 0;
+			}
+			if (__atomic_compare_exchange_n(&pHead->nCollector, &nOld, nSelf, 0, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) break;
+		}
+		pCollector->pHead = pHead;
+		pCollector->nFlushSeen = __atomic_load_n(&pHead->nFlushReq, __ATOMIC_ACQUIRE);
+		return 1;
+	}
+
+	//取出队列里已经写好的日志写进文件，返回写出的条数；有写日志的进程在等wlogFlush()时顺便刷新文件
+	inline unsigned long wlogShmDrain() {
+		__wlog_shm_collector_t* pCollector = __wlog_shm_collector();
+		__wlog_shm_head_t* pHead = pCollector->pHead;
+		if (NULL == pHead) return 0;
+		__wlog_shm_slot_t* pSlots = __wlog_shm_slots(pHead);
+		uint64_t nPos = __atomic_load_n(&pHead->nDequeuePos, __ATOMIC_RELAXED);
+		unsigned long nRecords = 0;
+		uint32_t nFlushReq = __atomic_load_n(&pHead->nFlushReq, __ATOMIC_ACQUIRE);
+		for (;;) {
+			__wlog_shm_slot_t* pSlot = &pSlots[nPos & (WLOG_SHM_SLOT_COUNT - 1)];
+			uint64_t nSeq = __atomic_load_n(&pSlot->nSeq, __ATOMIC_ACQUIRE);
+			if (nSeq != nPos + 1) {
+				if ((int64_t)(__atomic_load_n(&pHead->nEnqueuePos, __ATOMIC_ACQUIRE) - nPos) <= 0) break;
+				if (!__wlog_shm_torn_imp(pCollector, pSlot, nPos)) break;
+				__wlog_shm_release_imp(pSlot, nPos);
+				++pCollector->nTorn;
+				++nPos;
+				continue;
+			}
+			//一条日志的其他槽位：头一个槽位写坏被跳过后剩下的，也跳过
+			uint64_t nParts = pSlot->nParts;
+			if (0 != pSlot->nPart || 0 == nParts || nParts > WLOG_SHM_SLOT_COUNT / 2) {
+				__wlog_shm_release_imp(pSlot, nPos);
+				++pCollector->nTorn;
+				++nPos;
+				continue;
+			}
+			//所有槽位都写好了才写出，否则等；等不到就整条跳过
+			uint64_t nIdx = 1;
+			int bTorn = 0;
+			for (; nIdx < nParts; ++nIdx) {
+				__wlog_shm_slot_t* pPart = &pSlots[(nPos + nIdx) & (WLOG_SHM_SLOT_COUNT - 1)];
+				if (__atomic_load_n(&pPart->nSeq, __ATOMIC_ACQUIRE) == nPos + nIdx + 1) continue;
+				bTorn = __wlog_shm_torn_imp(pCollector, pPart, nPos + nIdx) ? 1 : -1;
+				break;
+			}
+			if (bTorn < 0) break;
+			for (nIdx = 0; nIdx < nParts; ++nIdx) {
+				__wlog_shm_slot_t* pPart = &pSlots[(nPos + nIdx) & (WLOG_SHM_SLOT_COUNT - 1)];
+				if (!bTorn) {
+					__wlog_sink_write_imp(pPart->nType, pPart->szData, pPart->nLen > WLOG_SHM_RECORD_SIZE ? WLOG_SHM_RECORD_SIZE : pPart->nLen);
+				}
+				__wlog_shm_release_imp(pPart, nPos + nIdx);
+			}
+			if (bTorn) {
+				pCollector->nTorn += (unsigned long)nParts;
+			} else {
+				++nRecords;
+			}
+			nPos += nParts;
+			__atomic_store_n(&pHead->nDequeuePos, nPos, __ATOMIC_RELEASE);
+		}
+		__atomic_store_n(&pHead->nDequeuePos, nPos, __ATOMIC_RELEASE);
+		__wlog_shm_report_imp(pCollector);
+		if (nFlushReq != pCollector->nFlushSeen) {
+			wlogFlush();
+			pCollector->nFlushSeen = nFlushReq;
+			__atomic_store_n(&pHead->nFlushedPos, nPos, __ATOMIC_RELEASE);
+		}
+		return nRecords;
+	}
+
+	//队列空时睡眠，先声明要睡眠再复查一次，避免和写日志的进程的唤醒错过；最多睡100毫秒
+	inline void __wlog_shm_wait_imp(__wlog_shm_head_t* pHead) {
+		__wlog_shm_slot_t* pSlots = __wlog_shm_slots(pHead);
+		uint64_t nPos = __atomic_load_n(&pHead->nDequeuePos, __ATOMIC_RELAXED);
+		__atomic_store_n(&pHead->nWake, 1, __ATOMIC_RELAXED);
+		__atomic_thread_fence(__ATOMIC_SEQ_CST);
+		if (__atomic_load_n(&pSlots[nPos & (WLOG_SHM_SLOT_COUNT - 1)].nSeq, __ATOMIC_ACQUIRE) != nPos + 1) {
+			struct timespec tsWait = {0, 100 * 1000 * 1000};
+			__wlog_shm_futex(&pHead->nWake, FUTEX_WAIT, 1, &tsWait);
+		}
+		__atomic_store_n(&pHead->nWake, 0, __ATOMIC_RELAXED);
+	}
+
+	//收集进程的主循环：一直取出日志写进文件，直到*pbStop非0，退出前取完剩下的并刷新。打不开或已有收集进程时返回-1
+	inline int wlogShmCollect(const char* szName, volatile int* pbStop) {
+		if (!wlogShmOpen(szName)) return -1;
+		__wlog_shm_head_t* pHead = __wlog_shm_collector()->pHead;
+		unsigned long nPending = 0;
+		while (!*pbStop) {
+			unsigned long nRecords = wlogShmDrain();
+			if (0 != nRecords) {
+				nPending += nRecords;
+				continue;
+			}
+			//队列空了就把已取出的日志刷进文件，空闲时不留在缓冲里
+			if (0 != nPending) {
+				wlogFlush();
+				__atomic_store_n(&pHead->nFlushedPos, __atomic_load_n(&pHead->nDequeuePos, __ATOMIC_ACQUIRE), __ATOMIC_RELEASE);
+				nPending = 0;
+			}
+			__wlog_shm_wait_imp(pHead);
+		}
+		wlogShmDrain();
+		wlogFlush();
+		__atomic_store_n(&pHead->nFlushedPos, __atomic_load_n(&pHead->nDequeuePos, __ATOMIC_ACQUIRE), __ATOMIC_RELEASE);
+		int32_t nSelf = (int32_t)getpid();
+		__atomic_compare_exchange_n(&pHead->nCollector, &nSelf, 0, 0, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED);
+		return 0;
+	}
+#endif
+
+#endif //__WLOG_SHM_H__
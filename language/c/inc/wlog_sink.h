@@ -0,0 +1,104 @@
+#ifndef __WLOG_SINK_H__
+#define __WLOG_SINK_H__
+/**
+ * @file wlog_sink.h
+ * @brief WLOG_TO同时指定多个输出时的分发，由wlog.h自动包含，不要单独include.
+ * <pre>WLOG_TO可以是WLOG_TO_CONSOLE与WLOG_TO_FILE或WLOG_TO_MMAP或起来，如
+            #define WLOG_TO (WLOG_TO_CONSOLE | WLOG_TO_FILE)
+            #define WLOG_CONSOLE_TYPES (WLOG_TYPE_WARNING | WLOG_TYPE_ERROR | WLOG_TYPE_FATAL)
+            #include <wlog.h>
+        即控制台只输出WARNING以上，文件里是全部日志。每条日志只格式化一次，放进同一块缓冲，
+        再交给每个要这条日志的输出，多一个输出只多一次写的开销。两个输出都不要的类型直接返回，不会格式化。
+        文件仍按WLOG_ASYNC、WLOG_FLUSH_XXX、WLOG_ROTATE_XXX等配置写入，控制台在调用线程里直接fwrite到stdout。
+        可在include <wlog.h>之前修改的“宏”配置：
+		1. WLOG_CONSOLE_TYPES，输出到控制台的日志类型，默认WLOG_TYPE_ALL
+		2. WLOG_FILE_TYPES，输出到文件的日志类型，默认WLOG_TYPE_ALL
+        运行时可以用wlogSetSinkTypes(WLOG_TO_CONSOLE, nMask)、wlogGetSinkTypes(WLOG_TO_FILE)修改、读取某个输出的类型，
+        WLOG_TO_MMAP的类型也用WLOG_FILE_TYPES、WLOG_TO_FILE修改。不支持WLOG_BINARY。
+	</pre>
+ * @os linux
+ */
+#if WLOG_BINARY
+	#error "WLOG_BINARY can't be used with multiple WLOG_TO!"
+#endif
+
+#include <stdlib.h>
+
+#ifndef WLOG_CONSOLE_TYPES
+	#define WLOG_CONSOLE_TYPES WLOG_TYPE_ALL
+#endif
+#ifndef WLOG_FILE_TYPES
+	#define WLOG_FILE_TYPES WLOG_TYPE_ALL
+#endif
+
+typedef struct __wlog_sink_types_t {
+	unsigned int nConsole;
+	unsigned int nFile;
+} __wlog_sink_types_t;
+
+inline __wlog_sink_types_t* __wlog_sink_types() {
+	static __wlog_sink_types_t g_wlogSinkTypes = {WLOG_CONSOLE_TYPES, WLOG_FILE_TYPES};
+	return &g_wlogSinkTypes;
+}
+
+inline unsigned int* __wlog_sink_types_of(unsigned int nSink) {
+	__wlog_sink_types_t* pTypes = __wlog_sink_types();
+	if (nSink == WLOG_TO_CONSOLE) return &pTypes->nConsole;
+	if (nSink == WLOG_TO_FILE || nSink == WLOG_TO_MMAP) return &pTypes->nFile;
+	return NULL;
+}
+
+//修改某个输出的日志类型，nSink为WLOG_TO_CONSOLE、WLOG_TO_FILE或WLOG_TO_MMAP
+inline void wlogSetSinkTypes(unsigned int nSink, unsigned int nMask) {
+	unsigned int* pTypes = __wlog_sink_types_of(nSink);
+	if (NULL != pTypes) __atomic_store_n(pTypes, nMask, __ATOMIC_RELAXED);
+}
+
+inline unsigned int wlogGetSinkTypes(unsigned int nSink) {
+	unsigned int* pTypes = __wlog_sink_types_of(nSink);
+	return (NULL == pTypes) ? 0 : __atomic_load_n(pTypes, __ATOMIC_RELAXED);
+}
+
+//已经格式化好的整条日志交给每个要它的输出
+inline void __wlog_write_record_imp(unsigned int nType, const char* pRecord, size_t nLen) {
+	__wlog_sink_types_t* pTypes = __wlog_sink_types();
+	if (nType & __atomic_load_n(&pTypes->nConsole, __ATOMIC_RELAXED)) {
+		#if WLOG_STATS
+			unsigned long long nStatsStart = __wlog_stats_now_ns();
+			__wlog_stats_write_imp(nStatsStart, (fwrite(pRecord, 1, nLen, stdout) == nLen) ? (long)nLen : -1);
+		#else
+			fwrite(pRecord, 1, nLen, stdout);
+		#endif
+	}
+	if (nType & __atomic_load_n(&pTypes->nFile, __ATOMIC_RELAXED)) {
+		__wlog_sink_write_imp(nType, pRecord, nLen);
+	}
+}
+
+//logText、logBase的格式化只在这里做一次
+inline void __wlog_sink_text_imp(unsigned int nType, const char* format, ...) {
+	__wlog_sink_types_t* pTypes = __wlog_sink_types();
+	if (!(nType & (__atomic_load_n(&pTypes->nConsole, __ATOMIC_RELAXED) | __atomic_load_n(&pTypes->nFile, __ATOMIC_RELAXED)))) return;
+	char szStack[WLOG_MAX_BUFFER_SIZE];
+	__wlog_arena_text_t text;
+	va_list arglist;
+	va_start(arglist, format);
+	int nLen = __wlog_arena_vformat(&text, szStack, sizeof(szStack), format, arglist);
+	va_end(arglist);
+	if (nLen >= 0) __wlog_write_record_imp(nType, text.pData, (size_t)nLen);
+	__wlog_arena_text_free(&text);
+}
+
+inline void __wlog_sink_flush_imp() {
+	wlogFlush();
+	fflush(stdout);
+}
+
+#undef logText
+#undef __wlog_log_text_t
+#undef wlogFlush
+#define logText(format, args...) WLOG_DYNAMIC_CHECK_TEXT __wlog_sink_text_imp(WLOG_TYPE_TEXT, format, ##args)
+#define __wlog_log_text_t(nType, format, args...) WLOG_DYNAMIC_CHECK_TEXT __wlog_sink_text_imp(nType, format, ##args)
+#define wlogFlush() __wlog_sink_flush_imp()
+
+#endif //__WLOG_SINK_H__
@@ -0,0 +1,200 @@
+#ifndef __WLOG_SITE_H__
+#define __WLOG_SITE_H__
+/**
+ * @file wlog_site.h
+ * @brief logBase调用点的编译期信息：不含路径的文件名与静态调用点登记，由wlog.h自动包含，不要单独include.
+ * <pre>WLOG_FILE_BASENAME是当前源文件不含路径的文件名，编译器支持__FILE_NAME__时直接用它，
+        C++11(或VS2015)以上用constexpr在编译时计算，都不支持的C编译器在linux下仍输出完整的__FILE__，
+        windows下运行时查找，路径里没有'\\'时输出完整路径，不会再越界。
+        C++下每个logBase调用点生成一个静态的__wlog_site_t(文件名、行号、类型字符、格式串)，
+        linux下gcc/clang编译可执行文件时还把它的地址放进"wlog_sites"段，main之前即可枚举所有调用点：
+            unsigned int nIdx = 0;
+            for (; nIdx < wlogSiteCount(); ++nIdx) {
+                const __wlog_site_t* pSite = wlogSiteGet(nIdx);
+            }
+        nId就是调用点在段内的序号，同一个可执行文件内固定不变，可以用来挂每个调用点的开关、统计等。
+        -fPIC编译的动态库里调用点在第一次执行时登记，只能枚举到已经执行过的调用点，nId按执行顺序分配。
+        WLOG_FULL_FILE_PATH，定义成1时logBase仍输出完整的__FILE__，默认0
+	</pre>
+ * @os windows, linux
+ */
+#include <stddef.h>
+
+#ifdef _WIN32
+	typedef TCHAR __wlog_site_char_t;
+#else
+	typedef char __wlog_site_char_t;
+#endif
+
+#if defined(__cplusplus) && (__cplusplus >= 201103L || (defined(_MSC_VER) && _MSC_VER >= 1900))
+	#define WLOG_SITE_CONSTEXPR 1
+	//在[pBegin, pEnd)里找最后一个路径分隔符，二分递归，递归深度只有log2(路径长度)
+	template <typename C> constexpr const C* __wlog_basename_range(const C* pBegin, const C* pEnd, const C* pNotFound) {
+		return (pEnd - pBegin == 0) ? pNotFound
+			: (pEnd - pBegin == 1) ? ((*pBegin == C('/') || *pBegin == C('\\')) ? pBegin + 1 : pNotFound)
+			: __wlog_basename_range(pBegin + (pEnd - pBegin) / 2, pEnd,
+				__wlog_basename_range(pBegin, pBegin + (pEnd - pBegin) / 2, pNotFound));
+	}
+	template <typename C, size_t N> constexpr const C* __wlog_basename(const C (&szPath)[N]) {
+		return __wlog_basename_range(szPath, szPath + N - 1, szPath);
+	}
+#else
+	#define WLOG_SITE_CONSTEXPR 0
+	inline const __wlog_site_char_t* __wlog_basename(const __wlog_site_char_t* szPath) {
+		const __wlog_site_char_t* pName = szPath;
+		for (; *szPath; ++szPath) {
+			if (*szPath == _T('/') || *szPath == _T('\\')) pName = szPath + 1;
+		}
+		return pName;
+	}
+#endif
+
+#if WLOG_FULL_FILE_PATH
+	#define WLOG_FILE_BASENAME __TFILE__
+#elif defined(__FILE_NAME__) && !defined(_WIN32)
+	#define WLOG_FILE_BASENAME __FILE_NAME__
+#elif WLOG_SITE_CONSTEXPR || defined(_WIN32)
+	#define WLOG_FILE_BASENAME __wlog_basename(__TFILE__)
+#else
+	#define WLOG_FILE_BASENAME __FILE__
+#endif
+
+//调用点信息，除nId外全部在编译时确定
+typedef struct __wlog_site_t {
+	const __wlog_site_char_t* szFile;
+	const __wlog_site_char_t* szFormat;
+	unsigned int nType;
+	int nLine;
+	__wlog_site_char_t chType;
+	unsigned int nId;
+} __wlog_site_t;
+
+#define WLOG_SITE_NONE 0xFFFFFFFFu
+
+#if WLOG_SITE_CONSTEXPR && defined(__GNUC__) && !defined(_WIN32)
+	#include <pthread.h>
+	#include <stdlib.h>
+	//WLOG_SITE_SECTION为1时调用点地址在编译时写进"wlog_sites"段，启动时即可枚举，
+	//gcc不允许inline函数里的静态变量与普通静态变量放进同一个段，所以段里只放指针，由内联汇编写入；
+	//-fPIC编译动态库时内联汇编取不到inline函数里静态变量的地址，改为调用点第一次执行时登记
+	#if defined(__PIC__) && !defined(__PIE__)
+		#define WLOG_SITE_SECTION 0
+	#else
+		#define WLOG_SITE_SECTION 1
+	#endif
+	#define WLOG_SITE_REGISTRY 1
+	#define __WLOG_SITE_STR(x) #x
+	#define __WLOG_SITE_XSTR(x) __WLOG_SITE_STR(x)
+
+	typedef struct __wlog_site_registry_t {
+		pthread_mutex_t hMutex;
+		unsigned int nCount;
+		unsigned int nCapacity;
+		__wlog_site_t** ppSites;
+	} __wlog_site_registry_t;
+
+	inline __wlog_site_registry_t* __wlog_site_registry() {
+		static __wlog_site_registry_t g_wlogSiteRegistry = {PTHREAD_MUTEX_INITIALIZER, 0, 0, NULL};
+		return &g_wlogSiteRegistry;
+	}
+
+	#if WLOG_SITE_SECTION
+		//链接器为"wlog_sites"段自动生成__start_wlog_sites/__stop_wlog_sites，一个调用点都没有时两者为NULL
+		extern __wlog_site_t* __start_wlog_sites[] __attribute__((weak, visibility("hidden")));
+		extern __wlog_site_t* __stop_wlog_sites[] __attribute__((weak, visibility("hidden")));
+
+		//同一个调用点被内联到多处时段里有多个相同的指针，这里去重、按段内顺序编号，结果原地压缩
+		inline void __wlog_site_init_imp() {
+			__wlog_site_registry_t* pRegistry = __wlog_site_registry();
+			unsigned int nCount = 0;
+			if (NULL != __start_wlog_sites) {
+				__wlog_site_t** ppSite = __start_wlog_sites;
+				for (; ppSite < __stop_wlog_sites; ++ppSite) {
+					if (WLOG_SITE_NONE != (*ppSite)->nId) continue;
+					(*ppSite)->nId = nCount;
+					__start_wlog_sites[nCount++] = *ppSite;
+				}
+			}
+			pRegistry->ppSites = __start_wlog_sites;
+			pRegistry->nCount = nCount;
+		}
+		inline __wlog_site_registry_t* __wlog_site_ready() {
+			static pthread_once_t g_wlogSiteOnce = PTHREAD_ONCE_INIT;
+			pthread_once(&g_wlogSiteOnce, __wlog_site_init_imp);
+			return __wlog_site_registry();
+		}
+		//每个包含wlog.h的编译单元一个，保证main之前所有调用点都已编号
+		static void __wlog_site_init_ctor() __attribute__((constructor));
+		static void __wlog_site_init_ctor() {
+			__wlog_site_ready();
+		}
+		#define WLOG_SITE_REGISTER(site) __asm__ __volatile__(".pushsection wlog_sites,\"aw\"\n\t.balign " \
+			__WLOG_SITE_XSTR(__SIZEOF_POINTER__) "\n\t.dc.a %c0\n\t.popsection" : : "i"(&(site)))
+	#else
+		inline __wlog_site_registry_t* __wlog_site_ready() {
+			return __wlog_site_registry();
+		}
+		inline void __wlog_site_register_imp(__wlog_site_t* pSite) {
+			__wlog_site_registry_t* pRegistry = __wlog_site_registry();
+			pthread_mutex_lock(&pRegistry->hMutex);
+			if (WLOG_SITE_NONE == pSite->nId) {
+				if (pRegistry->nCount == pRegistry->nCapacity) {
+					unsigned int nCapacity = pRegistry->nCapacity ? pRegistry->nCapacity * 2 : 256;
+					__wlog_site_t** ppSites = (__wlog_site_t**)realloc(pRegistry->ppSites, nCapacity * sizeof(__wlog_site_t*));
+					if (NULL == ppSites) {
+						pthread_mutex_unlock(&pRegistry->hMutex);
+						return;
+					}
+					pRegistry->ppSites = ppSites;
+					pRegistry->nCapacity = nCapacity;
+				}
+				pRegistry->ppSites[pRegistry->nCount] = pSite;
+				__atomic_store_n(&pSite->nId, pRegistry->nCount, __ATOMIC_RELEASE);
+				__atomic_store_n(&pRegistry->nCount, pRegistry->nCount + 1, __ATOMIC_RELEASE);
+			}
+			pthread_mutex_unlock(&pRegistry->hMutex);
+		}
+		#define WLOG_SITE_REGISTER(site) \
+			if (WLOG_SITE_NONE == __atomic_load_n(&(site).nId, __ATOMIC_ACQUIRE)) __wlog_site_register_imp(&(site))
+	#endif
+
+	inline unsigned int wlogSiteCount() {
+		return __atomic_load_n(&__wlog_site_ready()->nCount, __ATOMIC_ACQUIRE);
+	}
+	//nId从0开始，越界返回NULL
+	inline const __wlog_site_t* wlogSiteGet(unsigned int nId) {
+		__wlog_site_registry_t* pRegistry = __wlog_site_ready();
+		const __wlog_site_t* pSite = NULL;
+		#if !WLOG_SITE_SECTION
+			pthread_mutex_lock(&pRegistry->hMutex);
+		#endif
+		if (nId < pRegistry->nCount) pSite = pRegistry->ppSites[nId];
+		#if !WLOG_SITE_SECTION
+			pthread_mutex_unlock(&pRegistry->hMutex);
+		#endif
+		return pSite;
+	}
+#else
+	#define WLOG_SITE_REGISTRY 0
+	#define WLOG_SITE_REGISTER(site) (void)(site)
+	inline unsigned int wlogSiteCount() {
+		return 0;
+	}
+	inline const __wlog_site_t* wlogSiteGet(unsigned int nId) {
+		(void)nId;
+		return NULL;
+	}
+#endif
+
+//在logBase里展开，定义并登记本调用点的__wlog_site，WLOG_SITE_FILE为输出用的文件名
+#if WLOG_SITE_CONSTEXPR
+	#define WLOG_SITE_DEFINE(nType, chType, format) \
+		static __wlog_site_t __wlog_site = {WLOG_FILE_BASENAME, format, nType, __LINE__, chType, WLOG_SITE_NONE};\
+		WLOG_SITE_REGISTER(__wlog_site)
+	#define WLOG_SITE_FILE __wlog_site.szFile
+#else
+	#define WLOG_SITE_DEFINE(nType, chType, format)
+	#define WLOG_SITE_FILE WLOG_FILE_BASENAME
+#endif
+
+#endif //__WLOG_SITE_H__
@@ -0,0 +1,446 @@
+#ifndef __WLOG_SOCKET_H__
+#define __WLOG_SOCKET_H__
+/**
+ * @file wlog_socket.h
+ * @brief WLOG_TO_SOCKET通过unix域套接字把日志交给本机的syslog或日志代理，由wlog.h自动包含，不要单独include.
+ * <pre>日志的落地由本机的日志代理负责时，程序自己不再写文件。每条日志加上RFC 5424的头：
+            <PRI>1 时间(UTC，微秒) 主机名 程序名 进程号 - - 日志内容(去掉末尾的换行)
+        PRI = WLOG_SYSLOG_FACILITY * 8 + 级别：FATAL、VERIFY、ASSERT为2，ERROR为3，WARNING为4，NOTICE为5，
+        INFO、BASE、TEXT为6，DEBUG、TRACE为7。
+        默认是数据报套接字(如/dev/log)，每条日志一个数据报，攒够一批用一次sendmmsg发出，
+        对方能积压的数据报条数受net.unix.max_dgram_qlen限制，日志量大时可改用流式；
+        WLOG_SOCKET_STREAM为1时是流式套接字，按RFC 6587用"长度 空格 日志"分帧，一批的iovec用一次sendmsg发出(与writev相同，但可以用MSG_NOSIGNAL，对方断开时不会SIGPIPE)。
+        日志先放进进程内WLOG_SOCKET_BUFFER_SIZE的缓冲，满WLOG_SOCKET_BATCH条、出现WLOG_SOCKET_FLUSH_TYPES的日志、
+        距上次发送超过WLOG_SOCKET_INTERVAL_MS或wlogFlush()时发送；另有一个后台线程按WLOG_SOCKET_INTERVAL_MS发出空闲时剩下的日志。
+        发送都不阻塞：代理跟不上(EAGAIN)时日志留在缓冲里，写日志的线程每WLOG_SOCKET_BATCH条才再试一次，后台线程等套接字可写后接着发，
+        缓冲满了就丢弃新日志并计数，之后补发一条
+        "WLOG SOCKET DROPPED n RECORDS"，可用wlogSocketDropped()读取累计值。
+        代理没有启动或重启时每秒重连一次，连不上期间的日志同样先缓冲、满了丢弃。
+        logFatal、logVerify、logAssert和wlogFlush()最多等WLOG_SOCKET_FLUSH_TIMEOUT_MS把缓冲发完。
+        不支持WLOG_BINARY，不支持与控制台同时输出。
+        可在include <wlog.h>之前修改的“宏”配置：
+		1. WLOG_SOCKET_PATH，套接字路径，默认"/dev/log"
+		2. WLOG_SOCKET_STREAM，设置成1时连接流式(SOCK_STREAM)套接字，默认0，即数据报(SOCK_DGRAM)
+		3. WLOG_SYSLOG_FACILITY，默认1(user)
+		4. WLOG_SYSLOG_APP_NAME，程序名，默认为进程名
+		5. WLOG_SOCKET_BUFFER_SIZE，缓冲大小，默认256K，单条日志最多用其中的1/4，超过时截断
+		6. WLOG_SOCKET_BATCH，每批最多的条数，默认64
+		7. WLOG_SOCKET_INTERVAL_MS，最长攒多久发一次，默认100
+		8. WLOG_SOCKET_FLUSH_TYPES，立即发送的日志类型，默认(WLOG_TYPE_ERROR | WLOG_TYPE_VERIFY | WLOG_TYPE_ASSERT | WLOG_TYPE_FATAL)
+		9. WLOG_SOCKET_FLUSH_TIMEOUT_MS，wlogFlush()最多等多久，默认1000
+	</pre>
+ * @os linux
+ */
+#ifdef _WIN32
+	#error "haven't implement!"
+#endif
+#if WLOG_BINARY
+	#error "WLOG_TO_SOCKET can't be used with WLOG_BINARY!"
+#endif
+
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+
+#ifndef WLOG_SOCKET_PATH
+	#define WLOG_SOCKET_PATH "/dev/log"
+#endif
+#ifndef WLOG_SOCKET_STREAM
+	#define WLOG_SOCKET_STREAM 0
+#endif
+#ifndef WLOG_SYSLOG_FACILITY
+	#define WLOG_SYSLOG_FACILITY 1
+#endif
+#ifndef WLOG_SYSLOG_APP_NAME
+	#ifdef _GNU_SOURCE
+		#define WLOG_SYSLOG_APP_NAME program_invocation_short_name
+	#else
+		#define WLOG_SYSLOG_APP_NAME "-"
+	#endif
+#endif
+#ifndef WLOG_SOCKET_BUFFER_SIZE
+	#define WLOG_SOCKET_BUFFER_SIZE (256 * 1024)
+#endif
+#ifndef WLOG_SOCKET_BATCH
+	#define WLOG_SOCKET_BATCH 64
+#endif
+#ifndef WLOG_SOCKET_INTERVAL_MS
+	#define WLOG_SOCKET_INTERVAL_MS 100
+#endif
+#ifndef WLOG_SOCKET_FLUSH_TYPES
+	#define WLOG_SOCKET_FLUSH_TYPES (WLOG_TYPE_ERROR | WLOG_TYPE_VERIFY | WLOG_TYPE_ASSERT | WLOG_TYPE_FATAL)
+#endif
+#ifndef WLOG_SOCKET_FLUSH_TIMEOUT_MS
+	#define WLOG_SOCKET_FLUSH_TIMEOUT_MS 1000
+#endif
+
+#define __WLOG_SOCKET_RECORD_MAX (WLOG_SOCKET_BUFFER_SIZE / 4)
+#define __WLOG_SOCKET_RETRY_MS 1000
+
+//缓冲里每条日志前面是4字节的长度(不含这4字节)，后面是已经加好头(流式时还有分帧)的日志
+typedef struct __wlog_socket_t {
+	pthread_mutex_t hMutex;
+	int hSocket;					//-1表示还没连上
+	int32_t nPid;
+	unsigned long nRetryMs;			//下次重连的时间
+	unsigned long nLastSendMs;
+	unsigned long nDropped;			//还没补发说明的丢弃条数
+	unsigned long nDroppedTotal;
+	size_t nLen;
+	size_t nRecords;
+	size_t nHeadSent;				//流式时第一条日志已经发出的字节数
+	int bBusy;						//上次发送EAGAIN，缓冲发完之前主要由后台线程发送
+	unsigned int nBusyCalls;		//bBusy期间写日志的次数
+	char szHost[64];
+	char szData[WLOG_SOCKET_BUFFER_SIZE];
+} __wlog_socket_t;
+
+inline __wlog_socket_t* __wlog_socket() {
+	static __wlog_socket_t g_wlogSocket = {PTHREAD_MUTEX_INITIALIZER, -1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, {0}, {0}};
+	return &g_wlogSocket;
+}
+
+inline unsigned long __wlog_socket_now_ms() {
+	struct timespec tsNow;
+	clock_gettime(CLOCK_MONOTONIC, &tsNow);
+	return (unsigned long)tsNow.tv_sec * 1000 + (unsigned long)(tsNow.tv_nsec / 1000000);
+}
+
+//与struct mmsghdr相同，C下没有_GNU_SOURCE时也能用
+typedef struct __wlog_mmsghdr_t {
+	struct msghdr msg_hdr;
+	unsigned int msg_len;
+} __wlog_mmsghdr_t;
+
+//调用者持有hMutex；连不上时1秒内不再重试
+inline int __wlog_socket_connect_locked_imp(__wlog_socket_t* pSocket) {
+	if (pSocket->hSocket >= 0) return 1;
+	unsigned long nNow = __wlog_socket_now_ms();
+	if (0 != pSocket->nRetryMs && (long)(nNow - pSocket->nRetryMs) < 0) return 0;
+	pSocket->nRetryMs = nNow + __WLOG_SOCKET_RETRY_MS;
+	int hSocket = socket(AF_UNIX, (WLOG_SOCKET_STREAM ? SOCK_STREAM : SOCK_DGRAM) | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if (hSocket < 0) return 0;
+	struct sockaddr_un addrPeer;
+	memset(&addrPeer, 0, sizeof(addrPeer));
+	addrPeer.sun_family = AF_UNIX;
+	strncpy(addrPeer.sun_path, WLOG_SOCKET_PATH, sizeof(addrPeer.sun_path) - 1);
+	if (0 != connect(hSocket, (struct sockaddr*)&addrPeer, sizeof(addrPeer))) {
+		close(hSocket);
+		return 0;
+	}
+	pSocket->hSocket = hSocket;
+	pSocket->nRetryMs = 0;
+	return 1;
+}
+
+//连接断了：流式时发了一半的那条日志剩下的部分不能发给新连接
+inline void __wlog_socket_close_locked_imp(__wlog_socket_t* pSocket) {
+	close(pSocket->hSocket);
+	pSocket->hSocket = -1;
+	pSocket->bBusy = 0;
+	pSocket->nRetryMs = __wlog_socket_now_ms() + __WLOG_SOCKET_RETRY_MS;
+	if (0 != pSocket->nHeadSent) {
+		uint32_t nHead = 0;
+		memcpy(&nHead, pSocket->szData, 4);
+		memmove(pSocket->szData, pSocket->szData + 4 + nHead, pSocket->nLen - 4 - nHead);
+		pSocket->nLen -= 4 + nHead;
+		pSocket->nRecords -= 1;
+		pSocket->nHeadSent = 0;
+	}
+}
+
+//从缓冲头部去掉已经发出的nCount条
+inline void __wlog_socket_consume_locked_imp(__wlog_socket_t* pSocket, size_t nCount) {
+	size_t nOffset = 0;
+	size_t nIdx = 0;
+	for (; nIdx < nCount; ++nIdx) {
+		uint32_t nRecord = 0;
+		memcpy(&nRecord, pSocket->szData + nOffset, 4);
+		nOffset += 4 + nRecord;
+	}
+	memmove(pSocket->szData, pSocket->szData + nOffset, pSocket->nLen - nOffset);
+	pSocket->nLen -= nOffset;
+	pSocket->nRecords -= nCount;
+}
+
+//发一批，返回发出的条数，-1表示发不出去(EAGAIN或连接断了)
+inline long __wlog_socket_send_batch_locked_imp(__wlog_socket_t* pSocket) {
+	struct iovec vecParts[WLOG_SOCKET_BATCH];
+	size_t nCount = 0;
+	size_t nOffset = 0;
+	size_t nBytes = 0;
+	for (; nCount < WLOG_SOCKET_BATCH && nCount < pSocket->nRecords; ++nCount) {
+		uint32_t nRecord = 0;
+		memcpy(&nRecord, pSocket->szData + nOffset, 4);
+		vecParts[nCount].iov_base = pSocket->szData + nOffset + 4;
+		vecParts[nCount].iov_len = nRecord;
+		nOffset += 4 + nRecord;
+		nBytes += nRecord;
+	}
+	#if WLOG_STATS
+		unsigned long long nStatsStart = __wlog_stats_now_ns();
+	#endif
+	long nSent = 0;
+	#if WLOG_SOCKET_STREAM
+		vecParts[0].iov_base = (char*)vecParts[0].iov_base + pSocket->nHeadSent;
+		vecParts[0].iov_len -= pSocket->nHeadSent;
+		nBytes -= pSocket->nHeadSent;
+		struct msghdr msgBatch;
+		memset(&msgBatch, 0, sizeof(msgBatch));
+		msgBatch.msg_iov = vecParts;
+		msgBatch.msg_iovlen = nCount;
+		ssize_t nRet = sendmsg(pSocket->hSocket, &msgBatch, MSG_DONTWAIT | MSG_NOSIGNAL);
+		if (nRet < 0) {
+			nSent = -1;
+		} else {
+			//整条发出的去掉，发了一半的记下位置
+			size_t nDone = (size_t)nRet;
+			size_t nIdx = 0;
+			for (; nIdx < nCount && nDone >= vecParts[nIdx].iov_len; ++nIdx) {
+				nDone -= vecParts[nIdx].iov_len;
+			}
+			pSocket->nHeadSent = (0 == nIdx) ? pSocket->nHeadSent + nDone : nDone;
+			nSent = (long)nIdx;
+			nBytes = (size_t)nRet;
+		}
+	#else
+		__wlog_mmsghdr_t msgParts[WLOG_SOCKET_BATCH];
+		memset(msgParts, 0, sizeof(__wlog_mmsghdr_t) * nCount);
+		size_t nIdx = 0;
+		for (; nIdx < nCount; ++nIdx) {
+			msgParts[nIdx].msg_hdr.msg_iov = &vecParts[nIdx];
+			msgParts[nIdx].msg_hdr.msg_iovlen = 1;
+		}
+		int nRet = (int)syscall(SYS_sendmmsg, pSocket->hSocket, msgParts, (unsigned int)nCount, MSG_DONTWAIT | MSG_NOSIGNAL);
+		if (nRet < 0 && EMSGSIZE == errno) {
+			//对方收不下这么大的数据报，只能丢掉这一条
+			pSocket->nDropped += 1;
+			pSocket->nDroppedTotal += 1;
+			nRet = 1;
+		}
+		nSent = nRet;
+		if (nRet >= 0) {
+			nBytes = 0;
+			for (nIdx = 0; nIdx < (size_t)nRet; ++nIdx) nBytes += vecParts[nIdx].iov_len;
+		}
+	#endif
+	#if WLOG_STATS
+		__wlog_stats_write_imp(nStatsStart, (nSent < 0) ? -1 : (long)nBytes);
+	#endif
+	if (nSent < 0) {
+		if (EAGAIN == errno || EWOULDBLOCK == errno) {
+			pSocket->bBusy = 1;
+		} else if (EINTR != errno) {
+			__wlog_socket_close_locked_imp(pSocket);
+		}
+		return -1;
+	}
+	__wlog_socket_consume_locked_imp(pSocket, (size_t)nSent);
+	return nSent;
+}
+
+inline void __wlog_socket_append_locked_imp(__wlog_socket_t* pSocket, unsigned int nType, const char* pRecord, size_t nLen);
+
+//尽量发完缓冲，不等待；返回1表示已经发完
+inline int __wlog_socket_flush_locked_imp(__wlog_socket_t* pSocket) {
+	if (0 != pSocket->nDropped && pSocket->nLen + 4 + 256 <= WLOG_SOCKET_BUFFER_SIZE) {
+		char szLine[64];
+		int nLen = snprintf(szLine, sizeof(szLine), _T("WLOG SOCKET DROPPED %lu RECORDS"), pSocket->nDropped);
+		pSocket->nDropped = 0;
+		__wlog_socket_append_locked_imp(pSocket, WLOG_TYPE_WARNING, szLine, (size_t)nLen);
+	}
+	pSocket->nLastSendMs = __wlog_socket_now_ms();
+	if (0 == pSocket->nRecords) return 1;
+	if (!__wlog_socket_connect_locked_imp(pSocket)) return 0;
+	while (0 != pSocket->nRecords) {
+		if (__wlog_socket_send_batch_locked_imp(pSocket) < 0) return 0;
+	}
+	pSocket->bBusy = 0;
+	return 1;
+}
+
+inline unsigned int __wlog_socket_severity(unsigned int nType) {
+	if (nType & (WLOG_TYPE_FATAL | WLOG_TYPE_VERIFY | WLOG_TYPE_ASSERT)) return 2;
+	if (nType & WLOG_TYPE_ERROR) return 3;
+	if (nType & WLOG_TYPE_WARNING) return 4;
+	if (nType & WLOG_TYPE_NOTICE) return 5;
+	if (nType & (WLOG_TYPE_DEBUG | WLOG_TYPE_TRACE)) return 7;
+	return 6;
+}
+
+//RFC 5424的时间，每个线程缓存到秒："YYYY-MM-DDTHH:MM:SS.uuuuuuZ"
+inline void __wlog_socket_format_time_imp(char szTime[28]) {
+	static __thread time_t g_wlogSocketSecond = -1;
+	static __thread char g_wlogSocketTime[20];
+	struct timespec tsNow;
+	clock_gettime(CLOCK_REALTIME, &tsNow);
+	if (tsNow.tv_sec != g_wlogSocketSecond) {
+		struct tm tmNow;
+		gmtime_r(&tsNow.tv_sec, &tmNow);
+		strftime(g_wlogSocketTime, sizeof(g_wlogSocketTime), "%Y-%m-%dT%H:%M:%S", &tmNow);
+		g_wlogSocketSecond = tsNow.tv_sec;
+	}
+	memcpy(szTime, g_wlogSocketTime, 19);
+	unsigned int nMicro = (unsigned int)(tsNow.tv_nsec / 1000);
+	int nIdx = 25;
+	szTime[19] = '.';
+	for (; nIdx > 19; --nIdx) {
+		szTime[nIdx] = (char)('0' + nMicro % 10);
+		nMicro /= 10;
+	}
+	szTime[26] = 'Z';
+	szTime[27] = 0;
+}
+
+//加上头放进缓冲，放不下时丢弃并计数
+inline void __wlog_socket_append_locked_imp(__wlog_socket_t* pSocket, unsigned int nType, const char* pRecord, size_t nLen) {
+	while (nLen > 0 && ('\n' == pRecord[nLen - 1] || '\r' == pRecord[nLen - 1])) --nLen;
+	if (nLen > __WLOG_SOCKET_RECORD_MAX) nLen = __WLOG_SOCKET_RECORD_MAX;
+	char szTime[28];
+	__wlog_socket_format_time_imp(szTime);
+	char szHead[256];
+	int nHead = snprintf(szHead, sizeof(szHead), "<%u>1 %s %s %s %d - - ", WLOG_SYSLOG_FACILITY * 8 + __wlog_socket_severity(nType),
+		szTime, pSocket->szHost, WLOG_SYSLOG_APP_NAME, (int)pSocket->nPid);
+	if (nHead < 0 || (size_t)nHead >= sizeof(szHead)) return;
+	char szFrame[16];
+	int nFrame = 0;
+	#if WLOG_SOCKET_STREAM
+		nFrame = snprintf(szFrame, sizeof(szFrame), "%lu ", (unsigned long)(nHead + nLen));
+	#endif
+	uint32_t nRecord = (uint32_t)(nFrame + nHead + nLen);
+	if (pSocket->nLen + 4 + nRecord > WLOG_SOCKET_BUFFER_SIZE) {
+		pSocket->nDropped += 1;
+		pSocket->nDroppedTotal += 1;
+		#if WLOG_STATS
+			__wlog_stats_drop_imp();
+		#endif
+		return;
+	}
+	char* pOut = pSocket->szData + pSocket->nLen;
+	memcpy(pOut, &nRecord, 4);
+	memcpy(pOut + 4, szFrame, (size_t)nFrame);
+	memcpy(pOut + 4 + nFrame, szHead, (size_t)nHead);
+	memcpy(pOut + 4 + nFrame + nHead, pRecord, nLen);
+	pSocket->nLen += 4 + nRecord;
+	pSocket->nRecords += 1;
+}
+
+inline void __wlog_socket_atfork_child_imp() {
+	__wlog_socket()->nPid = (int32_t)getpid();
+}
+
+//空闲时把缓冲里剩下的日志发出去，连不上时顺便重连；代理跟不上时等套接字可写后接着发
+inline void* __wlog_socket_timer_imp(void* pArg) {
+	(void)pArg;
+	__wlog_socket_t* pSocket = __wlog_socket();
+	for (;;) {
+		pthread_mutex_lock(&pSocket->hMutex);
+		int hSocket = pSocket->bBusy ? pSocket->hSocket : -1;
+		pthread_mutex_unlock(&pSocket->hMutex);
+		if (hSocket >= 0) {
+			struct pollfd pfdOut = {hSocket, POLLOUT, 0};
+			poll(&pfdOut, 1, WLOG_SOCKET_INTERVAL_MS);
+		} else {
+			usleep(WLOG_SOCKET_INTERVAL_MS * 1000);
+		}
+		pthread_mutex_lock(&pSocket->hMutex);
+		if ((0 != pSocket->nRecords || 0 != pSocket->nDropped)
+			&& (pSocket->bBusy || __wlog_socket_now_ms() - pSocket->nLastSendMs >= WLOG_SOCKET_INTERVAL_MS)) {
+			__wlog_socket_flush_locked_imp(pSocket);
+		}
+		pthread_mutex_unlock(&pSocket->hMutex);
+	}
+	return NULL;
+}
+
+//最多等WLOG_SOCKET_FLUSH_TIMEOUT_MS把缓冲发完
+inline void __wlog_socket_flush_imp() {
+	__wlog_socket_t* pSocket = __wlog_socket();
+	unsigned long nStart = __wlog_socket_now_ms();
+	pthread_mutex_lock(&pSocket->hMutex);
+	while (!__wlog_socket_flush_locked_imp(pSocket)) {
+		unsigned long nCost = __wlog_socket_now_ms() - nStart;
+		if (nCost >= WLOG_SOCKET_FLUSH_TIMEOUT_MS) break;
+		if (pSocket->hSocket >= 0) {
+			struct pollfd pfdOut = {pSocket->hSocket, POLLOUT, 0};
+			pthread_mutex_unlock(&pSocket->hMutex);
+			poll(&pfdOut, 1, (int)(WLOG_SOCKET_FLUSH_TIMEOUT_MS - nCost));
+		} else {
+			//等重连
+			pthread_mutex_unlock(&pSocket->hMutex);
+			usleep(10 * 1000);
+		}
+		pthread_mutex_lock(&pSocket->hMutex);
+	}
+	pthread_mutex_unlock(&pSocket->hMutex);
+}
+
+inline void __wlog_socket_init_imp() {
+	__wlog_socket_t* pSocket = __wlog_socket();
+	if (0 != gethostname(pSocket->szHost, sizeof(pSocket->szHost) - 1) || 0 == pSocket->szHost[0]) {
+		strcpy(pSocket->szHost, "-");
+	}
+	pSocket->nPid = (int32_t)getpid();
+	pSocket->nLastSendMs = __wlog_socket_now_ms();
+	pthread_atfork(NULL, NULL, __wlog_socket_atfork_child_imp);
+	pthread_t hThread;
+	if (0 == pthread_create(&hThread, NULL, __wlog_socket_timer_imp, NULL)) {
+		pthread_detach(hThread);
+	}
+	atexit(__wlog_socket_flush_imp);
+}
+
+//已经格式化好的整条日志
+inline void __wlog_sink_write_imp(unsigned int nType, const char* pRecord, size_t nLen) {
+	static pthread_once_t g_wlogSocketOnce = PTHREAD_ONCE_INIT;
+	pthread_once(&g_wlogSocketOnce, __wlog_socket_init_imp);
+	__wlog_socket_t* pSocket = __wlog_socket();
+	pthread_mutex_lock(&pSocket->hMutex);
+	__wlog_socket_append_locked_imp(pSocket, nType, pRecord, nLen);
+	if (pSocket->bBusy) {
+		//每次都试只会多出许多EAGAIN的系统调用
+		if (++pSocket->nBusyCalls >= WLOG_SOCKET_BATCH) {
+			pSocket->nBusyCalls = 0;
+			__wlog_socket_flush_locked_imp(pSocket);
+		}
+	} else if (pSocket->nRecords >= WLOG_SOCKET_BATCH || (nType & WLOG_SOCKET_FLUSH_TYPES)
+		|| pSocket->nLen > WLOG_SOCKET_BUFFER_SIZE / 2
+		|| __wlog_socket_now_ms() - pSocket->nLastSendMs >= WLOG_SOCKET_INTERVAL_MS) {
+		__wlog_socket_flush_locked_imp(pSocket);
+	}
+	pthread_mutex_unlock(&pSocket->hMutex);
+}
+
+inline void __wlog_socket_write_imp(unsigned int nType, const char* format, ...) {
+	char szStack[WLOG_MAX_BUFFER_SIZE];
+	__wlog_arena_text_t text;
+	va_list arglist;
+	va_start(arglist, format);
+	int nLen = __wlog_arena_vformat(&text, szStack, sizeof(szStack), format, arglist);
+	va_end(arglist);
+	if (nLen >= 0) __wlog_sink_write_imp(nType, text.pData, (size_t)nLen);
+	__wlog_arena_text_free(&text);
+}
+
+//缓冲满丢弃的日志条数
+inline unsigned long wlogSocketDropped() {
+	__wlog_socket_t* pSocket = __wlog_socket();
+	pthread_mutex_lock(&pSocket->hMutex);
+	unsigned long nDropped = pSocket->nDroppedTotal;
+	pthread_mutex_unlock(&pSocket->hMutex);
+	return nDropped;
+}
+
+#define wlogFlush() __wlog_socket_flush_imp()
+#undef WLOG_ASYNC_DRAIN_CHECK
+#define WLOG_ASYNC_DRAIN_CHECK(nType) if ((nType) & (WLOG_TYPE_VERIFY | WLOG_TYPE_ASSERT | WLOG_TYPE_FATAL)) __wlog_socket_flush_imp()
+
+#endif //__WLOG_SOCKET_H__
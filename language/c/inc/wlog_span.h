@@ -0,0 +1,356 @@
+#ifndef __WLOG_SPAN_H__
+#define __WLOG_SPAN_H__
+/**
+ * @file wlog_span.h
+ * @brief WLOG_SPAN计时区间、计数与事件，输出Chrome/Perfetto的trace-event JSON，由wlog.h在linux用户态自动包含，不要单独include.
+ * <pre>以前用logTrace在函数进出时各打一条，再用秒级的时间相减，基本看不出耗时。WLOG_SPAN定义成1后可以用：
+            1. logSpan("name")，从这里到所在作用域结束为一个区间，用CLOCK_MONOTONIC记下开始时间与耗时(纳秒)，
+               离开作用域(包括return、break)时自动结束，C与C++都可以用(GCC的cleanup属性)
+            2. logSpanBegin("name")、logSpanEnd("name")，跨函数的区间，同一个线程内成对使用
+            3. logCounter("name", fValue)，计数器，如队列长度、内存用量，在查看器里画成曲线，NaN、Inf记为null
+            4. logInstant("name")，没有时长的事件，如收到信号、切换配置
+        name是事件的名字，必须是字符串常量或在程序结束前一直有效的字符串，记录时只保存指针。
+        事件先记进每个线程自己的缓冲，不格式化、不加锁，缓冲满、线程退出、程序正常退出或调用wlogSpanFlush()时
+        才格式化成JSON追加到WLOG_SPAN_FILE，与普通日志是不同的文件。程序退出时补上结尾的"]"，
+        没有正常退出的文件缺少"]"，chrome://tracing与ui.perfetto.dev都能直接打开。
+        区间与普通日志一样受开关控制：WLOG_STATIC_TYPE_SWITCH关掉WLOG_SPAN_TYPE时全部展开为空，
+        WLOG_DYNAMIC_TYPE_SWITCH关掉时只多一次判断，不读时钟。不支持WLOG_TO_KERNEL与windows。
+        可在include <wlog.h>之前修改的“宏”配置：
+		1. WLOG_SPAN，是否启用，默认0
+		2. WLOG_SPAN_TYPE，logSpan系列归属的日志类型，默认WLOG_TYPE_TRACE
+		3. WLOG_SPAN_FILE，输出的JSON文件，每次启动时清空，默认"wlog.trace.json"
+		4. WLOG_SPAN_EVENTS，每个线程缓冲的事件数，缓冲满时写一次文件，默认2048
+		5. WLOG_SPAN_CATEGORY，事件的"cat"字段，默认是编译单元的WLOG_CATEGORY_NAME，没有定义时为"wlog"
+	</pre>
+ * @os linux
+ */
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+#ifndef WLOG_SPAN_FILE
+	#define WLOG_SPAN_FILE "wlog.trace.json"
+#endif
+#ifndef WLOG_SPAN_EVENTS
+	#define WLOG_SPAN_EVENTS 2048
+#endif
+#ifndef WLOG_SPAN_CATEGORY
+	#ifdef WLOG_CATEGORY_NAME
+		#define WLOG_SPAN_CATEGORY WLOG_CATEGORY_NAME
+	#else
+		#define WLOG_SPAN_CATEGORY "wlog"
+	#endif
+#endif
+
+#if (WLOG_SPAN_EVENTS < 16)
+	#error "WLOG_SPAN_EVENTS must be at least 16!"
+#endif
+
+//名字、分类超过这个长度的部分不写出；一个事件最多写出3次名字、1次分类，转义后每次最多两倍长
+#define __WLOG_SPAN_NAME_MAX 256
+#define __WLOG_SPAN_EVENT_MAX (8 * __WLOG_SPAN_NAME_MAX + 256)
+
+//ph字段：X区间、B/E开始结束、C计数器、i事件
+typedef struct __wlog_span_event_t {
+	const char* szName;
+	const char* szCat;
+	unsigned long long nTsNs;
+	unsigned long long nDurNs;
+	double fValue;
+	char chPhase;
+} __wlog_span_event_t;
+
+//每个线程一个，只有本线程增加nHead；nTail在写文件时由持有锁的线程修改，线程退出后留给之后新建的线程复用
+typedef struct __wlog_span_buf_t {
+	unsigned long nHead;
+	unsigned long nTail;
+	long nTid;
+	int bInUse;
+	struct __wlog_span_buf_t* pNext;
+	__wlog_span_event_t events[WLOG_SPAN_EVENTS];
+} __wlog_span_buf_t;
+
+typedef struct __wlog_span_ctx_t {
+	pthread_mutex_t hMutex;
+	pthread_once_t hOnce;
+	pthread_key_t hKey;
+	__wlog_span_buf_t* pBufs;
+	int hFd;
+	int bFirst;
+	int bClosed;
+} __wlog_span_ctx_t;
+
+//logSpan在作用域里的变量，szName为NULL表示动态开关关掉了，结束时什么也不做
+typedef struct __wlog_span_t {
+	const char* szName;
+	const char* szCat;
+	unsigned long long nStartNs;
+} __wlog_span_t;
+
+inline __wlog_span_ctx_t* __wlog_span_ctx() {
+	static __wlog_span_ctx_t g_wlogSpanCtx = {PTHREAD_MUTEX_INITIALIZER, PTHREAD_ONCE_INIT, 0, NULL, -1, 1, 0};
+	return &g_wlogSpanCtx;
+}
+
+inline __wlog_span_buf_t** __wlog_span_tls() {
+	static __thread __wlog_span_buf_t* g_wlogSpanBuf = NULL;
+	return &g_wlogSpanBuf;
+}
+
+inline unsigned long long __wlog_span_now_ns() {
+	struct timespec tsNow;
+	clock_gettime(CLOCK_MONOTONIC, &tsNow);
+	return (unsigned long long)tsNow.tv_sec * 1000000000ULL + (unsigned long long)tsNow.tv_nsec;
+}
+
+inline void __wlog_span_write_all_imp(int hFd, const char* pData, size_t nLen) {
+	while (nLen > 0) {
+		ssize_t nWritten = write(hFd, pData, nLen);
+		if (nWritten < 0) {
+			if (EINTR == errno) continue;
+			return;
+		}
+		pData += nWritten;
+		nLen -= (size_t)nWritten;
+	}
+}
+
+//字符串写成JSON字符串的内容，转义引号、反斜杠，去掉控制字符
+inline char* __wlog_span_put_str(char* pOut, const char* szStr) {
+	size_t nIdx = 0;
+	for (; szStr[nIdx] && nIdx < __WLOG_SPAN_NAME_MAX; ++nIdx) {
+		char chCur = szStr[nIdx];
+		if ('"' == chCur || '\\' == chCur) *pOut++ = '\\';
+		else if ((unsigned char)chCur < 0x20) continue;
+		*pOut++ = chCur;
+	}
+	return pOut;
+}
+
+//纳秒写成微秒，保留3位小数
+inline char* __wlog_span_put_us(char* pOut, unsigned long long nNs) {
+	char szDigits[24];
+	int nLen = 0;
+	unsigned long long nUs = nNs / 1000;
+	unsigned int nFraction = (unsigned int)(nNs % 1000);
+	do {
+		szDigits[nLen++] = (char)('0' + nUs % 10);
+		nUs /= 10;
+	} while (nUs > 0);
+	while (nLen > 0) *pOut++ = szDigits[--nLen];
+	*pOut++ = '.';
+	*pOut++ = (char)('0' + nFraction / 100);
+	*pOut++ = (char)('0' + nFraction / 10 % 10);
+	*pOut++ = (char)('0' + nFraction % 10);
+	return pOut;
+}
+
+inline char* __wlog_span_put_lit(char* pOut, const char* szLit) {
+	size_t nLen = strlen(szLit);
+	memcpy(pOut, szLit, nLen);
+	return pOut + nLen;
+}
+
+//一个事件格式化成一个JSON对象，前面是分隔的",\n"(第一个除外)，pOut至少要有__WLOG_SPAN_EVENT_MAX字节；
+//szIds是同一个缓冲的事件共用的",\"pid\":P,\"tid\":T"，每次写文件时只生成一次
+inline char* __wlog_span_format_imp(char* pOut, const __wlog_span_event_t* pEvent, const char* szIds, int bFirst) {
+	char szPhase[2] = {pEvent->chPhase, 0};
+	if (!bFirst) pOut = __wlog_span_put_lit(pOut, ",\n");
+	pOut = __wlog_span_put_lit(pOut, "{\"name\":\"");
+	pOut = __wlog_span_put_str(pOut, pEvent->szName);
+	pOut = __wlog_span_put_lit(pOut, "\",\"cat\":\"");
+	pOut = __wlog_span_put_str(pOut, pEvent->szCat);
+	pOut = __wlog_span_put_lit(pOut, "\",\"ph\":\"");
+	pOut = __wlog_span_put_lit(pOut, szPhase);
+	pOut = __wlog_span_put_lit(pOut, "\",\"ts\":");
+	pOut = __wlog_span_put_us(pOut, pEvent->nTsNs);
+	if ('X' == pEvent->chPhase) {
+		pOut = __wlog_span_put_lit(pOut, ",\"dur\":");
+		pOut = __wlog_span_put_us(pOut, pEvent->nDurNs);
+	} else if ('i' == pEvent->chPhase) {
+		pOut = __wlog_span_put_lit(pOut, ",\"s\":\"t\"");
+	}
+	pOut = __wlog_span_put_lit(pOut, szIds);
+	if ('C' == pEvent->chPhase) {
+		pOut = __wlog_span_put_lit(pOut, ",\"args\":{\"");
+		pOut = __wlog_span_put_str(pOut, pEvent->szName);
+		//JSON没有NaN、Inf，写成null，查看器会跳过这个点
+		if (isfinite(pEvent->fValue)) {
+			pOut += sprintf(pOut, "\":%.17g}", pEvent->fValue);
+		} else {
+			pOut = __wlog_span_put_lit(pOut, "\":null}");
+		}
+	}
+	*pOut++ = '}';
+	return pOut;
+}
+
+//把一个线程缓冲里的事件写进文件并清空，调用者必须持有hMutex；文件已关闭时直接丢掉
+inline void __wlog_span_flush_buf_imp(__wlog_span_ctx_t* pCtx, __wlog_span_buf_t* pBuf) {
+	unsigned long nHead = __atomic_load_n(&pBuf->nHead, __ATOMIC_ACQUIRE);
+	unsigned long nTail = pBuf->nTail;
+	if (nHead == nTail) return;
+	if (pCtx->hFd < 0 && !pCtx->bClosed) {
+		pCtx->hFd = open(WLOG_SPAN_FILE, O_WRONLY | O_CREAT | O_TRUNC | O_APPEND | O_CLOEXEC, 0666);
+		if (pCtx->hFd >= 0) __wlog_span_write_all_imp(pCtx->hFd, "[\n", 2);
+	}
+	if (pCtx->hFd >= 0) {
+		char szOut[16 * 1024];
+		char* pOut = szOut;
+		char szIds[64];
+		snprintf(szIds, sizeof(szIds), ",\"pid\":%d,\"tid\":%ld", (int)getpid(), pBuf->nTid);
+		for (; nTail != nHead; ++nTail) {
+			if ((size_t)(pOut - szOut) > sizeof(szOut) - __WLOG_SPAN_EVENT_MAX) {
+				__wlog_span_write_all_imp(pCtx->hFd, szOut, (size_t)(pOut - szOut));
+				pOut = szOut;
+			}
+			pOut = __wlog_span_format_imp(pOut, &pBuf->events[nTail % WLOG_SPAN_EVENTS], szIds, pCtx->bFirst);
+			pCtx->bFirst = 0;
+		}
+		__wlog_span_write_all_imp(pCtx->hFd, szOut, (size_t)(pOut - szOut));
+	}
+	__atomic_store_n(&pBuf->nTail, nHead, __ATOMIC_RELEASE);
+}
+
+//写出所有线程缓冲里的事件。其他线程可能正在记录，只写出已经记完的
+inline void wlogSpanFlush() {
+	__wlog_span_ctx_t* pCtx = __wlog_span_ctx();
+	pthread_mutex_lock(&pCtx->hMutex);
+	__wlog_span_buf_t* pBuf = pCtx->pBufs;
+	for (; NULL != pBuf; pBuf = pBuf->pNext) {
+		__wlog_span_flush_buf_imp(pCtx, pBuf);
+	}
+	pthread_mutex_unlock(&pCtx->hMutex);
+}
+
+//程序正常退出时写出所有事件，补上结尾的"]"，之后记录的事件不再写出
+inline void __wlog_span_exit_imp() {
+	__wlog_span_ctx_t* pCtx = __wlog_span_ctx();
+	wlogSpanFlush();
+	pthread_mutex_lock(&pCtx->hMutex);
+	if (pCtx->hFd >= 0) {
+		__wlog_span_write_all_imp(pCtx->hFd, "\n]\n", 3);
+		close(pCtx->hFd);
+		pCtx->hFd = -1;
+	}
+	pCtx->bClosed = 1;
+	pthread_mutex_unlock(&pCtx->hMutex);
+}
+
+//线程退出时写出本线程的事件，把缓冲还回去
+inline void __wlog_span_release_imp(void* pData) {
+	__wlog_span_ctx_t* pCtx = __wlog_span_ctx();
+	__wlog_span_buf_t* pBuf = (__wlog_span_buf_t*)pData;
+	pthread_mutex_lock(&pCtx->hMutex);
+	__wlog_span_flush_buf_imp(pCtx, pBuf);
+	__atomic_store_n(&pBuf->bInUse, 0, __ATOMIC_RELEASE);
+	pthread_mutex_unlock(&pCtx->hMutex);
+}
+
+inline void __wlog_span_init_imp() {
+	__wlog_span_ctx_t* pCtx = __wlog_span_ctx();
+	pthread_key_create(&pCtx->hKey, __wlog_span_release_imp);
+	atexit(__wlog_span_exit_imp);
+}
+
+//本线程第一次记录时取一个空闲的缓冲，没有就新分配一个
+inline __wlog_span_buf_t* __wlog_span_attach_imp() {
+	__wlog_span_ctx_t* pCtx = __wlog_span_ctx();
+	pthread_once(&pCtx->hOnce, __wlog_span_init_imp);
+	__wlog_span_buf_t* pBuf = NULL;
+	pthread_mutex_lock(&pCtx->hMutex);
+	for (pBuf = pCtx->pBufs; NULL != pBuf; pBuf = pBuf->pNext) {
+		if (!__atomic_load_n(&pBuf->bInUse, __ATOMIC_ACQUIRE)) break;
+	}
+	if (NULL == pBuf) {
+		pBuf = (__wlog_span_buf_t*)malloc(sizeof(__wlog_span_buf_t));
+		if (NULL != pBuf) {
+			pBuf->nHead = 0;
+			pBuf->nTail = 0;
+			pBuf->pNext = pCtx->pBufs;
+			pCtx->pBufs = pBuf;
+		}
+	}
+	if (NULL != pBuf) {
+		pBuf->nTid = (long)syscall(SYS_gettid);
+		__atomic_store_n(&pBuf->bInUse, 1, __ATOMIC_RELEASE);
+		pthread_setspecific(pCtx->hKey, pBuf);
+	}
+	pthread_mutex_unlock(&pCtx->hMutex);
+	*__wlog_span_tls() = pBuf;
+	return pBuf;
+}
+
+//记一个事件，缓冲满时先把本线程的事件写进文件
+inline void __wlog_span_add_imp(char chPhase, const char* szName, const char* szCat,
+	unsigned long long nTsNs, unsigned long long nDurNs, double fValue) {
+	__wlog_span_buf_t* pBuf = *__wlog_span_tls();
+	if (NULL == pBuf && NULL == (pBuf = __wlog_span_attach_imp())) return;
+	unsigned long nHead = pBuf->nHead;
+	if (nHead - __atomic_load_n(&pBuf->nTail, __ATOMIC_ACQUIRE) >= WLOG_SPAN_EVENTS) {
+		__wlog_span_ctx_t* pCtx = __wlog_span_ctx();
+		pthread_mutex_lock(&pCtx->hMutex);
+		__wlog_span_flush_buf_imp(pCtx, pBuf);
+		pthread_mutex_unlock(&pCtx->hMutex);
+	}
+	__wlog_span_event_t* pEvent = &pBuf->events[nHead % WLOG_SPAN_EVENTS];
+	pEvent->szName = szName;
+	pEvent->szCat = szCat;
+	pEvent->nTsNs = nTsNs;
+	pEvent->nDurNs = nDurNs;
+	pEvent->fValue = fValue;
+	pEvent->chPhase = chPhase;
+	__atomic_store_n(&pBuf->nHead, nHead + 1, __ATOMIC_RELEASE);
+}
+
+inline __wlog_span_t __wlog_span_begin_imp(const char* szName, const char* szCat) {
+	__wlog_span_t span;
+	span.szName = szName;
+	span.szCat = szCat;
+	span.nStartNs = (NULL != szName) ? __wlog_span_now_ns() : 0;
+	return span;
+}
+
+//离开作用域时由cleanup属性调用，一个区间只记一个"X"事件
+inline void __wlog_span_end_imp(__wlog_span_t* pSpan) {
+	if (NULL == pSpan->szName) return;
+	unsigned long long nEndNs = __wlog_span_now_ns();
+	__wlog_span_add_imp('X', pSpan->szName, pSpan->szCat, pSpan->nStartNs, nEndNs - pSpan->nStartNs, 0);
+}
+
+#if WLOG_DYNAMIC_TYPE_SWITCH
+	#define WLOG_SPAN_ENABLED() ((WLOG_SPAN_TYPE) & WLOG_DYNAMIC_MASK())
+#else
+	#define WLOG_SPAN_ENABLED() 1
+#endif
+
+#define __WLOG_SPAN_JOIN_IMP(a, b) a##b
+#define __WLOG_SPAN_JOIN(a, b) __WLOG_SPAN_JOIN_IMP(a, b)
+
+#define logSpan(szName) __wlog_span_t __WLOG_SPAN_JOIN(__wlog_span_, __COUNTER__) __attribute__((cleanup(__wlog_span_end_imp))) = \
+	__wlog_span_begin_imp(WLOG_SPAN_ENABLED() ? (szName) : NULL, WLOG_SPAN_CATEGORY)
+#define logSpanBegin(szName) do {\
+	WLOG_DYNAMIC_CHECK(WLOG_SPAN_TYPE);\
+	__wlog_span_add_imp('B', szName, WLOG_SPAN_CATEGORY, __wlog_span_now_ns(), 0, 0);\
+} while (0)
+#define logSpanEnd(szName) do {\
+	WLOG_DYNAMIC_CHECK(WLOG_SPAN_TYPE);\
+	__wlog_span_add_imp('E', szName, WLOG_SPAN_CATEGORY, __wlog_span_now_ns(), 0, 0);\
+} while (0)
+#define logCounter(szName, fValue) do {\
+	WLOG_DYNAMIC_CHECK(WLOG_SPAN_TYPE);\
+	__wlog_span_add_imp('C', szName, WLOG_SPAN_CATEGORY, __wlog_span_now_ns(), 0, (double)(fValue));\
+} while (0)
+#define logInstant(szName) do {\
+	WLOG_DYNAMIC_CHECK(WLOG_SPAN_TYPE);\
+	__wlog_span_add_imp('i', szName, WLOG_SPAN_CATEGORY, __wlog_span_now_ns(), 0, 0);\
+} while (0)
+
+#endif //__WLOG_SPAN_H__
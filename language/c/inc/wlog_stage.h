@@ -0,0 +1,311 @@
+#ifndef __WLOG_STAGE_H__
+#define __WLOG_STAGE_H__
+/**
+ * @file wlog_stage.h
+ * @brief WLOG_TO_FILE同步模式下每个线程自己的暂存缓冲，由wlog.h自动包含，不要单独include.
+ * <pre>每个线程第一次写日志时分配一块WLOG_STAGE_SIZE的缓冲，日志直接格式化进去，
+        按wlog_file.h的刷新策略(条数、字节数、时间、类型)把整块缓冲用一次write写进文件，
+        不再经过stdio，线程之间不再争用同一个FILE锁。文件以O_APPEND | O_CLOEXEC打开，
+        每次write都整体追加在文件末尾，一条日志不会与其他线程、其他进程的日志交错。
+        默认WLOG_FLUSH_RECORDS为1，即每条日志一次write，与以前每条fflush一次时文件里看到的内容相同；
+        改成按字节数等分组刷新后，同一线程的日志保持顺序，不同线程之间按各自写出的先后排列。
+        超过缓冲大小的单条日志先写出缓冲里已有的，再单独分配内存一次写出。
+        线程退出时写出它缓冲里剩下的日志，wlogFlush()和进程退出时写出所有线程的缓冲。
+        WLOG_FILE_NAME是管道、FIFO(如/dev/stdout被重定向到管道)时，超过PIPE_BUF的write可能与其他进程交错，
+        这时按日志边界(换行)把缓冲分成每次不超过PIPE_BUF的write；单条日志本身超过PIPE_BUF时在flock(LOCK_EX)下
+        分多次写出，其余时候持有LOCK_SH，所以多个进程用wlog写同一个管道时每条日志都是完整的。
+        可在include <wlog.h>之前修改的“宏”配置：
+		1. WLOG_STAGE_SIZE，每个线程的暂存缓冲大小，默认16K
+		2. WLOG_FILE_ATOMIC_SIZE，一次write不会交错的最大字节数，0表示不限，默认普通文件为0、其他为PIPE_BUF
+	</pre>
+ * @os linux
+ */
+#ifdef _WIN32
+	#error "haven't implement!"
+#endif
+
+#include <pthread.h>
+#include <string.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/file.h>
+
+#ifndef WLOG_STAGE_SIZE
+	#define WLOG_STAGE_SIZE (16 * 1024)
+#endif
+
+typedef struct __wlog_stage_t {
+	pthread_mutex_t hMutex;		//只在wlogFlush()与本线程同时操作时才有竞争
+	struct __wlog_stage_t* pPrev;
+	struct __wlog_stage_t* pNext;
+	unsigned long nLen;
+	unsigned long nRecords;
+	unsigned long nLastFlushMs;
+	unsigned int nTypes;		//缓冲里日志类型的并集
+	char szData[WLOG_STAGE_SIZE];
+} __wlog_stage_t;
+
+//所有线程的缓冲，wlogFlush()和退出时遍历
+typedef struct __wlog_stage_list_t {
+	pthread_mutex_t hMutex;
+	pthread_key_t hKey;
+	__wlog_stage_t* pHead;
+} __wlog_stage_list_t;
+
+inline __wlog_stage_list_t* __wlog_stage_list() {
+	static __wlog_stage_list_t g_wlogStageList = {PTHREAD_MUTEX_INITIALIZER, 0, NULL};
+	return &g_wlogStageList;
+}
+
+inline __wlog_stage_t** __wlog_stage_tls() {
+	static __thread __wlog_stage_t* g_wlogStage = NULL;
+	return &g_wlogStage;
+}
+
+//一次write写出，被信号打断或短写时接着写剩下的，返回写出的字节数
+inline size_t __wlog_stage_write_all_imp(int hFd, const char* pData, size_t nLen) {
+	size_t nDone = 0;
+	while (nDone < nLen) {
+		ssize_t nRet = write(hFd, pData + nDone, nLen - nDone);
+		if (nRet < 0) {
+			if (EINTR == errno) continue;
+			break;
+		}
+		nDone += (size_t)nRet;
+	}
+	return nDone;
+}
+
+//有原子上限的文件(管道等)：按换行分成不超过nAtomic的多次write，超长的单条日志改持LOCK_EX写出
+inline size_t __wlog_stage_write_split_imp(int hFd, size_t nAtomic, const char* pData, size_t nLen) {
+	size_t nDone = 0;
+	flock(hFd, LOCK_SH);
+	while (nDone < nLen) {
+		const char* pChunk = pData + nDone;
+		size_t nChunk = nLen - nDone;
+		int bOversize = 0;
+		if (nChunk > nAtomic) {
+			size_t nEnd = nAtomic;
+			while (nEnd > 0 && '\n' != pChunk[nEnd - 1]) --nEnd;
+			if (nEnd > 0) {
+				nChunk = nEnd;
+			} else {
+				const char* pEnd = (const char*)memchr(pChunk + nAtomic, '\n', nChunk - nAtomic);
+				if (NULL != pEnd) nChunk = (size_t)(pEnd - pChunk) + 1;
+				bOversize = 1;
+			}
+		}
+		//flock的转换不是原子的，先放掉LOCK_SH再等LOCK_EX，两个进程同时转换也不会死锁
+		if (bOversize) flock(hFd, LOCK_EX);
+		size_t nWritten = __wlog_stage_write_all_imp(hFd, pChunk, nChunk);
+		if (bOversize) flock(hFd, LOCK_SH);
+		nDone += nWritten;
+		if (nWritten != nChunk) break;
+	}
+	flock(hFd, LOCK_UN);
+	return nDone;
+}
+
+#if WLOG_INDEX
+	//写普通文件并记进索引：先在锁外扫描，写与取得写后的位置在同一个锁里，其他线程不会插进来
+	inline size_t __wlog_stage_write_index_imp(int hFd, const char* pData, size_t nLen) {
+		if (!__wlog_index_active()) return __wlog_stage_write_all_imp(hFd, pData, nLen);
+		__wlog_index_entry_t sum;
+		__wlog_index_entry_init(&sum, 0);
+		__wlog_index_scan(&sum, pData, nLen);
+		__wlog_index_lock_imp();
+		size_t nDone = __wlog_stage_write_all_imp(hFd, pData, nLen);
+		off_t nEnd = (nDone == nLen) ? lseek(hFd, 0, SEEK_CUR) : -1;
+		if (nEnd >= 0) __wlog_index_add_data_locked_imp(&sum, pData, nLen, (uint64_t)nEnd);
+		__wlog_index_unlock_imp();
+		return nDone;
+	}
+	#define __wlog_stage_write_regular_imp __wlog_stage_write_index_imp
+#else
+	#define __wlog_stage_write_regular_imp __wlog_stage_write_all_imp
+#endif
+
+//整段追加到当前日志文件，普通文件只有一次write
+inline void __wlog_stage_write_fd_imp(unsigned int nTypes, const char* pData, size_t nLen) {
+	#if WLOG_STATS
+		unsigned long long nStatsStart = __wlog_stats_now_ns();
+	#endif
+	FILE* hFile = __wlog_file_acquire_imp(1);
+	if (NULL == hFile) {
+		#if WLOG_STATS
+			__wlog_stats_write_imp(nStatsStart, -1);
+		#endif
+		return;
+	}
+	int hFd = fileno(hFile);
+	size_t nAtomic = *__wlog_file_atomic_size();
+	size_t nDone = (0 == nAtomic) ? __wlog_stage_write_regular_imp(hFd, pData, nLen) : __wlog_stage_write_split_imp(hFd, nAtomic, pData, nLen);
+	if (nTypes & WLOG_FLUSH_SYNC_TYPES) {
+		fdatasync(hFd);
+	}
+	__wlog_file_release_imp(hFile, (nDone == nLen) ? (long)nLen : -1);
+	#if WLOG_STATS
+		__wlog_stats_write_imp(nStatsStart, (nDone == nLen) ? (long)nLen : -1);
+	#endif
+}
+
+//调用者持有pStage->hMutex
+inline void __wlog_stage_flush_locked_imp(__wlog_stage_t* pStage) {
+	if (0 == pStage->nLen) return;
+	__wlog_stage_write_fd_imp(pStage->nTypes, pStage->szData, pStage->nLen);
+	pStage->nLen = 0;
+	pStage->nRecords = 0;
+	pStage->nTypes = 0;
+	#if (WLOG_FLUSH_INTERVAL_MS > 0)
+		pStage->nLastFlushMs = __wlog_flush_now_ms();
+	#endif
+}
+
+//缓冲里新增了一条nLen字节的日志，按刷新策略决定是否写出，与__wlog_flush_policy_imp相同
+inline void __wlog_stage_commit_imp(__wlog_stage_t* pStage, unsigned int nType, unsigned long nLen) {
+	pStage->nLen += nLen;
+	pStage->nRecords += 1;
+	pStage->nTypes |= nType;
+	int bFlush = (0 != (nType & (WLOG_FLUSH_TYPES | __WLOG_FLUSH_NOW)));
+	#if (WLOG_FLUSH_RECORDS > 0)
+		bFlush = bFlush || (pStage->nRecords >= WLOG_FLUSH_RECORDS);
+	#endif
+	#if (WLOG_FLUSH_BYTES > 0)
+		bFlush = bFlush || (pStage->nLen >= WLOG_FLUSH_BYTES);
+	#endif
+	#if (WLOG_FLUSH_INTERVAL_MS > 0)
+		bFlush = bFlush || (__wlog_flush_now_ms() - pStage->nLastFlushMs >= WLOG_FLUSH_INTERVAL_MS);
+	#endif
+	if (bFlush) {
+		__wlog_stage_flush_locked_imp(pStage);
+	}
+}
+
+inline void __wlog_stage_flush_all_imp() {
+	__wlog_stage_list_t* pList = __wlog_stage_list();
+	pthread_mutex_lock(&pList->hMutex);
+	__wlog_stage_t* pStage = pList->pHead;
+	for (; NULL != pStage; pStage = pStage->pNext) {
+		pthread_mutex_lock(&pStage->hMutex);
+		__wlog_stage_flush_locked_imp(pStage);
+		pthread_mutex_unlock(&pStage->hMutex);
+	}
+	pthread_mutex_unlock(&pList->hMutex);
+}
+
+//线程退出时写出剩下的日志并释放缓冲
+inline void __wlog_stage_destroy_imp(void* pArg) {
+	__wlog_stage_t* pStage = (__wlog_stage_t*)pArg;
+	__wlog_stage_list_t* pList = __wlog_stage_list();
+	pthread_mutex_lock(&pList->hMutex);
+	pthread_mutex_lock(&pStage->hMutex);
+	__wlog_stage_flush_locked_imp(pStage);
+	pthread_mutex_unlock(&pStage->hMutex);
+	if (pStage->pPrev) pStage->pPrev->pNext = pStage->pNext;
+	else pList->pHead = pStage->pNext;
+	if (pStage->pNext) pStage->pNext->pPrev = pStage->pPrev;
+	pthread_mutex_unlock(&pList->hMutex);
+	*__wlog_stage_tls() = NULL;
+	pthread_mutex_destroy(&pStage->hMutex);
+	free(pStage);
+}
+
+inline void __wlog_stage_init_imp() {
+	pthread_key_create(&__wlog_stage_list()->hKey, __wlog_stage_destroy_imp);
+	#if WLOG_INDEX
+		//atexit后登记的先执行：先写出所有缓冲，再写最后一块索引
+		atexit(__wlog_index_flush_imp);
+	#endif
+	atexit(__wlog_stage_flush_all_imp);
+}
+
+//取得本线程的缓冲，第一次调用时分配并登记，分配失败返回NULL
+inline __wlog_stage_t* __wlog_stage_get() {
+	__wlog_stage_t** ppStage = __wlog_stage_tls();
+	if (NULL != *ppStage) return *ppStage;
+	static pthread_once_t g_wlogStageOnce = PTHREAD_ONCE_INIT;
+	pthread_once(&g_wlogStageOnce, __wlog_stage_init_imp);
+	__wlog_stage_t* pStage = (__wlog_stage_t*)malloc(sizeof(__wlog_stage_t));
+	if (NULL == pStage) return NULL;
+	pthread_mutex_init(&pStage->hMutex, NULL);
+	pStage->pPrev = NULL;
+	pStage->nLen = 0;
+	pStage->nRecords = 0;
+	pStage->nLastFlushMs = __wlog_flush_now_ms();
+	pStage->nTypes = 0;
+	__wlog_stage_list_t* pList = __wlog_stage_list();
+	pthread_setspecific(pList->hKey, pStage);
+	pthread_mutex_lock(&pList->hMutex);
+	pStage->pNext = pList->pHead;
+	if (pList->pHead) pList->pHead->pPrev = pStage;
+	pList->pHead = pStage;
+	pthread_mutex_unlock(&pList->hMutex);
+	*ppStage = pStage;
+	return pStage;
+}
+
+//放不进缓冲的日志单独格式化到缓冲池的缓冲，一次写出
+inline void __wlog_stage_write_large_imp(unsigned int nType, int nLen, const char* format, va_list arglist) {
+	size_t nCap = 0;
+	char* pRecord = __wlog_arena_alloc((size_t)nLen + 1, &nCap);
+	if (NULL == pRecord) return;
+	vsnprintf(pRecord, nCap, format, arglist);
+	__wlog_stage_write_fd_imp(nType, pRecord, (size_t)nLen);
+	__wlog_arena_free(pRecord, nCap);
+}
+
+inline void __wlog_file_write_valist_imp(unsigned int nType, const char* format, va_list arglist) {
+	__wlog_stage_t* pStage = __wlog_stage_get();
+	if (NULL == pStage) {
+		char szStack[WLOG_MAX_BUFFER_SIZE];
+		__wlog_arena_text_t text;
+		int nLen = __wlog_arena_vformat(&text, szStack, sizeof(szStack), format, arglist);
+		if (nLen > 0) __wlog_stage_write_fd_imp(nType, text.pData, (size_t)nLen);
+		__wlog_arena_text_free(&text);
+		return;
+	}
+	pthread_mutex_lock(&pStage->hMutex);
+	size_t nFree = WLOG_STAGE_SIZE - pStage->nLen;
+	va_list argCopy;
+	va_copy(argCopy, arglist);
+	int nLen = vsnprintf(pStage->szData + pStage->nLen, nFree, format, argCopy);
+	va_end(argCopy);
+	if (nLen > 0 && (size_t)nLen >= nFree) {
+		//放不下：先写出缓冲里已有的日志，再整条重新格式化
+		__wlog_stage_flush_locked_imp(pStage);
+		if ((size_t)nLen < WLOG_STAGE_SIZE) {
+			vsnprintf(pStage->szData, WLOG_STAGE_SIZE, format, arglist);
+		} else {
+			__wlog_stage_write_large_imp(nType, nLen, format, arglist);
+			nLen = 0;
+		}
+	}
+	if (nLen > 0) {
+		__wlog_stage_commit_imp(pStage, nType, (unsigned long)nLen);
+	}
+	pthread_mutex_unlock(&pStage->hMutex);
+}
+
+inline void __wlog_sink_write_imp(unsigned int nType, const char* pRecord, size_t nLen) {
+	__wlog_stage_t* pStage = __wlog_stage_get();
+	if (NULL == pStage) {
+		__wlog_stage_write_fd_imp(nType, pRecord, nLen);
+		return;
+	}
+	pthread_mutex_lock(&pStage->hMutex);
+	if (nLen > WLOG_STAGE_SIZE - pStage->nLen) {
+		__wlog_stage_flush_locked_imp(pStage);
+	}
+	if (nLen > WLOG_STAGE_SIZE) {
+		__wlog_stage_write_fd_imp(nType, pRecord, nLen);
+	} else if (nLen > 0) {
+		memcpy(pStage->szData + pStage->nLen, pRecord, nLen);
+		__wlog_stage_commit_imp(pStage, nType, (unsigned long)nLen);
+	}
+	pthread_mutex_unlock(&pStage->hMutex);
+}
+
+#define wlogFlush() __wlog_stage_flush_all_imp()
+
+#endif //__WLOG_STAGE_H__
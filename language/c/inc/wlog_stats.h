@@ -0,0 +1,323 @@
+#ifndef __WLOG_STATS_H__
+#define __WLOG_STATS_H__
+/**
+ * @file wlog_stats.h
+ * @brief WLOG_STATS日志自身的统计：按类型的条数、字节数、丢弃、写失败与耗时直方图，由wlog.h在linux用户态自动包含，不要单独include.
+ * <pre>每个线程一份计数，只有本线程写，不加锁也没有原子加法；wlogGetStats()读取时把所有线程的计数加起来，
+        退出的线程在退出时并进总数。统计的内容：
+            1. nRecords，logBase系列(含N、R、S、F、KV)每种类型输出的条数，下标是类型的位号，也可用wlogStatsRecords(pStats, WLOG_TYPE_XXX)
+            2. nBytes、nWrites，写进文件(或WLOG_TO_MMAP、多输出时的控制台)的字节数与次数，异步模式在写线程里统计
+            3. nFailedWrites，打不开文件或写不完整的次数，以前这种情况是悄悄丢掉的
+            4. nDropped，异步队列满(WLOG_ASYNC_DROP、WLOG_ASYNC_DROP_COUNT)或WLOG_TO_MMAP空间不足丢弃的条数
+            5. nSuppressed，logXXXR限速、logXXXS采样丢弃的条数
+            6. histFormat，每条日志在调用线程里花的时间(纳秒)，扣除了同一次调用里同步写输出的时间
+            7. histWrite，每次写输出花的时间(纳秒)，WLOG_ASYNC_IO_URING下是从提交到收到完成结果
+        直方图与HdrHistogram相同按2的幂分段，每段再等分成8个桶，误差不超过12.5%，最大记到2^36纳秒(约68秒)，
+        用wlogStatsPercentile(&stats.histFormat, 99.0)取百分位数。每条日志多两次clock_gettime，默认关闭。
+        可在include <wlog.h>之前修改的“宏”配置：
+		1. WLOG_STATS，是否启用，默认0
+		2. WLOG_STATS_FILE，定义后由后台线程每WLOG_STATS_INTERVAL_SEC秒把wlogStatsDump()的内容追加到这个文件，退出时再写一次，默认不定义
+		3. WLOG_STATS_INTERVAL_SEC，写WLOG_STATS_FILE的间隔，默认60
+	</pre>
+ * @os linux
+ */
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifndef WLOG_STATS_INTERVAL_SEC
+	#define WLOG_STATS_INTERVAL_SEC 60
+#endif
+
+//类型的位号从1到11
+#define WLOG_STATS_TYPE_COUNT	12
+//每个2的幂分成2^WLOG_STATS_SUB_BITS个桶，最大记到2^WLOG_STATS_MAX_BITS纳秒
+#define WLOG_STATS_SUB_BITS		3
+#define WLOG_STATS_MAX_BITS		36
+#define WLOG_STATS_BUCKETS		((WLOG_STATS_MAX_BITS - WLOG_STATS_SUB_BITS + 1) << WLOG_STATS_SUB_BITS)
+
+typedef struct wlog_stats_hist_t {
+	unsigned long nCount;
+	unsigned long long nSumNs;
+	unsigned long long nMaxNs;
+	unsigned long nBuckets[WLOG_STATS_BUCKETS];
+} wlog_stats_hist_t;
+
+typedef struct wlog_stats_t {
+	unsigned long nRecords[WLOG_STATS_TYPE_COUNT];
+	unsigned long long nBytes;
+	unsigned long nWrites;
+	unsigned long nFailedWrites;
+	unsigned long nDropped;
+	unsigned long nSuppressed;
+	wlog_stats_hist_t histFormat;
+	wlog_stats_hist_t histWrite;
+} wlog_stats_t;
+
+//每个线程一个，nWriteNs是本线程累计的写输出时间，格式化耗时要扣掉调用期间增加的部分
+typedef struct __wlog_stats_tls_t {
+	struct __wlog_stats_tls_t* pPrev;
+	struct __wlog_stats_tls_t* pNext;
+	unsigned long long nWriteNs;
+	wlog_stats_t stats;
+} __wlog_stats_tls_t;
+
+//所有线程的计数，退出的线程并进stRetired
+typedef struct __wlog_stats_list_t {
+	pthread_mutex_t hMutex;
+	pthread_key_t hKey;
+	__wlog_stats_tls_t* pHead;
+	wlog_stats_t stRetired;
+} __wlog_stats_list_t;
+
+//logBase开始时记下的时间
+typedef struct __wlog_stats_mark_t {
+	__wlog_stats_tls_t* pTls;
+	unsigned long long nStartNs;
+	unsigned long long nWriteNs;
+} __wlog_stats_mark_t;
+
+//只有本线程写，读的一方用原子读，不需要原子加法
+#define __wlog_stats_add(x, n) __atomic_store_n(&(x), (x) + (n), __ATOMIC_RELAXED)
+#define __wlog_stats_load(x) __atomic_load_n(&(x), __ATOMIC_RELAXED)
+
+inline __wlog_stats_list_t* __wlog_stats_list() {
+	static __wlog_stats_list_t g_wlogStatsList = {PTHREAD_MUTEX_INITIALIZER, 0, NULL, {{0}, 0, 0, 0, 0, 0, {0, 0, 0, {0}}, {0, 0, 0, {0}}}};
+	return &g_wlogStatsList;
+}
+
+inline __wlog_stats_tls_t** __wlog_stats_tls() {
+	static __thread __wlog_stats_tls_t* g_wlogStatsTls = NULL;
+	return &g_wlogStatsTls;
+}
+
+inline unsigned long long __wlog_stats_now_ns() {
+	struct timespec tsNow;
+	clock_gettime(CLOCK_MONOTONIC, &tsNow);
+	return (unsigned long long)tsNow.tv_sec * 1000000000ULL + (unsigned long long)tsNow.tv_nsec;
+}
+
+inline unsigned int __wlog_stats_bucket(unsigned long long nNs) {
+	if (nNs < (1ULL << WLOG_STATS_SUB_BITS)) return (unsigned int)nNs;
+	if (nNs >= (1ULL << WLOG_STATS_MAX_BITS)) return WLOG_STATS_BUCKETS - 1;
+	unsigned int nMsb = 63 - (unsigned int)__builtin_clzll(nNs);
+	return ((nMsb - WLOG_STATS_SUB_BITS + 1) << WLOG_STATS_SUB_BITS)
+		| (unsigned int)((nNs >> (nMsb - WLOG_STATS_SUB_BITS)) & ((1U << WLOG_STATS_SUB_BITS) - 1));
+}
+
+//桶里的最大值
+inline unsigned long long __wlog_stats_bucket_max(unsigned int nBucket) {
+	if (nBucket < (1U << WLOG_STATS_SUB_BITS)) return nBucket;
+	unsigned int nShift = (nBucket >> WLOG_STATS_SUB_BITS) - 1;
+	unsigned long long nSub = (1ULL << WLOG_STATS_SUB_BITS) + (nBucket & ((1U << WLOG_STATS_SUB_BITS) - 1));
+	return ((nSub + 1) << nShift) - 1;
+}
+
+inline void __wlog_stats_hist_add(wlog_stats_hist_t* pHist, unsigned long long nNs) {
+	__wlog_stats_add(pHist->nCount, 1);
+	__wlog_stats_add(pHist->nSumNs, nNs);
+	if (nNs > pHist->nMaxNs) __atomic_store_n(&pHist->nMaxNs, nNs, __ATOMIC_RELAXED);
+	__wlog_stats_add(pHist->nBuckets[__wlog_stats_bucket(nNs)], 1);
+}
+
+inline void __wlog_stats_hist_merge(wlog_stats_hist_t* pTo, wlog_stats_hist_t* pFrom) {
+	pTo->nCount += __wlog_stats_load(pFrom->nCount);
+	pTo->nSumNs += __wlog_stats_load(pFrom->nSumNs);
+	unsigned long long nMax = __wlog_stats_load(pFrom->nMaxNs);
+	if (nMax > pTo->nMaxNs) pTo->nMaxNs = nMax;
+	unsigned int nIdx = 0;
+	for (; nIdx < WLOG_STATS_BUCKETS; ++nIdx) {
+		pTo->nBuckets[nIdx] += __wlog_stats_load(pFrom->nBuckets[nIdx]);
+	}
+}
+
+inline void __wlog_stats_merge(wlog_stats_t* pTo, wlog_stats_t* pFrom) {
+	unsigned int nIdx = 0;
+	for (; nIdx < WLOG_STATS_TYPE_COUNT; ++nIdx) {
+		pTo->nRecords[nIdx] += __wlog_stats_load(pFrom->nRecords[nIdx]);
+	}
+	pTo->nBytes += __wlog_stats_load(pFrom->nBytes);
+	pTo->nWrites += __wlog_stats_load(pFrom->nWrites);
+	pTo->nFailedWrites += __wlog_stats_load(pFrom->nFailedWrites);
+	pTo->nDropped += __wlog_stats_load(pFrom->nDropped);
+	pTo->nSuppressed += __wlog_stats_load(pFrom->nSuppressed);
+	__wlog_stats_hist_merge(&pTo->histFormat, &pFrom->histFormat);
+	__wlog_stats_hist_merge(&pTo->histWrite, &pFrom->histWrite);
+}
+
+//线程退出时并进总数并释放
+inline void __wlog_stats_destroy_imp(void* pArg) {
+	__wlog_stats_tls_t* pTls = (__wlog_stats_tls_t*)pArg;
+	__wlog_stats_list_t* pList = __wlog_stats_list();
+	pthread_mutex_lock(&pList->hMutex);
+	__wlog_stats_merge(&pList->stRetired, &pTls->stats);
+	if (pTls->pPrev) pTls->pPrev->pNext = pTls->pNext;
+	else pList->pHead = pTls->pNext;
+	if (pTls->pNext) pTls->pNext->pPrev = pTls->pPrev;
+	pthread_mutex_unlock(&pList->hMutex);
+	*__wlog_stats_tls() = NULL;
+	free(pTls);
+}
+
+inline void wlogStatsDump(FILE* hOut);
+
+#ifdef WLOG_STATS_FILE
+	inline void __wlog_stats_dump_file_imp() {
+		FILE* hOut = fopen(WLOG_STATS_FILE, "a");
+		if (NULL == hOut) return;
+		wlogStatsDump(hOut);
+		fclose(hOut);
+	}
+	inline void* __wlog_stats_timer_imp(void* pArg) {
+		(void)pArg;
+		for (;;) {
+			sleep(WLOG_STATS_INTERVAL_SEC);
+			__wlog_stats_dump_file_imp();
+		}
+		return NULL;
+	}
+#endif
+
+inline void __wlog_stats_init_imp() {
+	pthread_key_create(&__wlog_stats_list()->hKey, __wlog_stats_destroy_imp);
+	#ifdef WLOG_STATS_FILE
+		pthread_t hThread;
+		if (0 == pthread_create(&hThread, NULL, __wlog_stats_timer_imp, NULL)) {
+			pthread_detach(hThread);
+		}
+		atexit(__wlog_stats_dump_file_imp);
+	#endif
+}
+
+//取得本线程的计数，第一次调用时分配并登记，分配失败返回NULL
+inline __wlog_stats_tls_t* __wlog_stats_get() {
+	__wlog_stats_tls_t** ppTls = __wlog_stats_tls();
+	if (NULL != *ppTls) return *ppTls;
+	static pthread_once_t g_wlogStatsOnce = PTHREAD_ONCE_INIT;
+	pthread_once(&g_wlogStatsOnce, __wlog_stats_init_imp);
+	__wlog_stats_tls_t* pTls = (__wlog_stats_tls_t*)calloc(1, sizeof(__wlog_stats_tls_t));
+	if (NULL == pTls) return NULL;
+	__wlog_stats_list_t* pList = __wlog_stats_list();
+	pthread_setspecific(pList->hKey, pTls);
+	pthread_mutex_lock(&pList->hMutex);
+	pTls->pNext = pList->pHead;
+	if (pList->pHead) pList->pHead->pPrev = pTls;
+	pList->pHead = pTls;
+	pthread_mutex_unlock(&pList->hMutex);
+	*ppTls = pTls;
+	return pTls;
+}
+
+inline void __wlog_stats_begin_imp(__wlog_stats_mark_t* pMark) {
+	pMark->pTls = __wlog_stats_get();
+	pMark->nWriteNs = (NULL != pMark->pTls) ? pMark->pTls->nWriteNs : 0;
+	pMark->nStartNs = __wlog_stats_now_ns();
+}
+
+inline void __wlog_stats_end_imp(const __wlog_stats_mark_t* pMark, unsigned int nType) {
+	__wlog_stats_tls_t* pTls = pMark->pTls;
+	if (NULL == pTls) return;
+	unsigned long long nCost = __wlog_stats_now_ns() - pMark->nStartNs;
+	unsigned long long nWrite = pTls->nWriteNs - pMark->nWriteNs;
+	nCost = (nCost > nWrite) ? nCost - nWrite : 0;
+	unsigned int nIdx = (unsigned int)__builtin_ctz(nType);
+	if (nIdx < WLOG_STATS_TYPE_COUNT) __wlog_stats_add(pTls->stats.nRecords[nIdx], 1);
+	__wlog_stats_hist_add(&pTls->stats.histFormat, nCost);
+}
+
+//写输出之前取__wlog_stats_now_ns()，写完后调用；nWritten小于0表示写失败
+inline void __wlog_stats_write_imp(unsigned long long nStartNs, long nWritten) {
+	__wlog_stats_tls_t* pTls = __wlog_stats_get();
+	if (NULL == pTls) return;
+	unsigned long long nCost = __wlog_stats_now_ns() - nStartNs;
+	pTls->nWriteNs += nCost;
+	__wlog_stats_add(pTls->stats.nWrites, 1);
+	if (nWritten < 0) {
+		__wlog_stats_add(pTls->stats.nFailedWrites, 1);
+	} else {
+		__wlog_stats_add(pTls->stats.nBytes, (unsigned long long)nWritten);
+	}
+	__wlog_stats_hist_add(&pTls->stats.histWrite, nCost);
+}
+
+inline void __wlog_stats_drop_imp() {
+	__wlog_stats_tls_t* pTls = __wlog_stats_get();
+	if (NULL != pTls) __wlog_stats_add(pTls->stats.nDropped, 1);
+}
+
+inline void __wlog_stats_suppress_imp() {
+	__wlog_stats_tls_t* pTls = __wlog_stats_get();
+	if (NULL != pTls) __wlog_stats_add(pTls->stats.nSuppressed, 1);
+}
+
+//所有线程的计数之和，各线程之间不是同一时刻的快照
+inline void wlogGetStats(wlog_stats_t* pStats) {
+	__wlog_stats_list_t* pList = __wlog_stats_list();
+	memset(pStats, 0, sizeof(*pStats));
+	pthread_mutex_lock(&pList->hMutex);
+	__wlog_stats_merge(pStats, &pList->stRetired);
+	__wlog_stats_tls_t* pTls = pList->pHead;
+	for (; NULL != pTls; pTls = pTls->pNext) {
+		__wlog_stats_merge(pStats, &pTls->stats);
+	}
+	pthread_mutex_unlock(&pList->hMutex);
+}
+
+inline unsigned long wlogStatsRecords(const wlog_stats_t* pStats, unsigned int nType) {
+	unsigned int nIdx = (0 == nType) ? WLOG_STATS_TYPE_COUNT : (unsigned int)__builtin_ctz(nType);
+	return (nIdx < WLOG_STATS_TYPE_COUNT) ? pStats->nRecords[nIdx] : 0;
+}
+
+//fPercent在0到100之间，返回所在桶的最大值，不超过记到的最大值
+inline unsigned long long wlogStatsPercentile(const wlog_stats_hist_t* pHist, double fPercent) {
+	if (0 == pHist->nCount) return 0;
+	double fRank = pHist->nCount * fPercent / 100.0;
+	unsigned long nRank = (unsigned long)fRank;
+	if (nRank < fRank || 0 == nRank) ++nRank;
+	unsigned long nSeen = 0;
+	unsigned int nIdx = 0;
+	for (; nIdx < WLOG_STATS_BUCKETS; ++nIdx) {
+		nSeen += pHist->nBuckets[nIdx];
+		if (nSeen >= nRank) break;
+	}
+	unsigned long long nValue = __wlog_stats_bucket_max(nIdx < WLOG_STATS_BUCKETS ? nIdx : WLOG_STATS_BUCKETS - 1);
+	return (nValue < pHist->nMaxNs) ? nValue : pHist->nMaxNs;
+}
+
+inline void __wlog_stats_dump_hist(FILE* hOut, const char* szName, const wlog_stats_hist_t* pHist) {
+	fprintf(hOut, "%s(ns): count %lu avg %llu p50 %llu p90 %llu p99 %llu p99.9 %llu max %llu\n", szName, pHist->nCount,
+		pHist->nCount ? pHist->nSumNs / pHist->nCount : 0ULL, wlogStatsPercentile(pHist, 50.0), wlogStatsPercentile(pHist, 90.0),
+		wlogStatsPercentile(pHist, 99.0), wlogStatsPercentile(pHist, 99.9), pHist->nMaxNs);
+}
+
+//写出当前的统计，几行文本
+inline void wlogStatsDump(FILE* hOut) {
+	static const char* const g_wlogStatsNames[WLOG_STATS_TYPE_COUNT] = {NULL, "text", "base", "trace", "debug", "info",
+		"notice", "warning", "error", "verify", "assert", "fatal"};
+	wlog_stats_t* pStats = (wlog_stats_t*)malloc(sizeof(wlog_stats_t));
+	if (NULL == pStats) return;
+	wlogGetStats(pStats);
+	time_t nNow = time(NULL);
+	struct tm tmNow;
+	localtime_r(&nNow, &tmNow);
+	fprintf(hOut, "++++++++++WLOG STATS %04d-%02d-%02d %02d:%02d:%02d+++++++++++\nrecords:", tmNow.tm_year + 1900, tmNow.tm_mon + 1,
+		tmNow.tm_mday, tmNow.tm_hour, tmNow.tm_min, tmNow.tm_sec);
+	unsigned int nIdx = 1;
+	for (; nIdx < WLOG_STATS_TYPE_COUNT; ++nIdx) {
+		fprintf(hOut, " %s %lu", g_wlogStatsNames[nIdx], pStats->nRecords[nIdx]);
+	}
+	fprintf(hOut, "\nbytes %llu writes %lu failed %lu dropped %lu suppressed %lu\n", pStats->nBytes, pStats->nWrites,
+		pStats->nFailedWrites, pStats->nDropped, pStats->nSuppressed);
+	__wlog_stats_dump_hist(hOut, "format", &pStats->histFormat);
+	__wlog_stats_dump_hist(hOut, "write", &pStats->histWrite);
+	fflush(hOut);
+	free(pStats);
+}
+
+#define WLOG_STATS_BEGIN() __wlog_stats_mark_t __wlog_stats_mark; __wlog_stats_begin_imp(&__wlog_stats_mark)
+#define WLOG_STATS_END(nType) __wlog_stats_end_imp(&__wlog_stats_mark, nType)
+#define WLOG_STATS_SUPPRESSED(nType) __wlog_stats_suppress_imp()
+
+#endif //__WLOG_STATS_H__
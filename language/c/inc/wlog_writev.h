@@ -0,0 +1,364 @@
+#ifndef __WLOG_WRITEV_H__
+#define __WLOG_WRITEV_H__
+/**
+ * @file wlog_writev.h
+ * @brief WLOG_ASYNC_IO为WLOG_ASYNC_IO_WRITEV或WLOG_ASYNC_IO_URING时异步写线程的实现，由wlog_async.h自动包含，不要单独include.
+ * <pre>写线程不再把槽位里的日志复制到一块缓冲再fwrite，而是每个槽位一个iovec，整批直接从队列里写出，
+        写完之后才释放这批槽位，每批只有一次系统调用。
+        WLOG_ASYNC_IO_URING下通过io_uring提交writev(不依赖liburing)，提交后写线程立即去收集下一批，
+        再收取上一批的完成结果，收集与写文件重叠进行；同一时间只有一批在写，文件里的顺序与队列相同。
+        io_uring_setup失败(内核太旧、被seccomp禁止等)或内核不支持IORING_OP_WRITEV时自动改用writev。
+        写不完整时剩下的部分用writev补写。批次大小仍受WLOG_ASYNC_BATCH_SIZE限制。
+        可在include <wlog.h>之前修改的“宏”配置：
+		1. WLOG_ASYNC_IOV_MAX，每批最多的iovec个数，默认1024(IOV_MAX)
+	</pre>
+ * @os linux
+ */
+#include <errno.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/uio.h>
+#if (WLOG_ASYNC_IO == WLOG_ASYNC_IO_URING)
+	#if defined(__has_include)
+		#if !__has_include(<linux/io_uring.h>)
+			#undef WLOG_ASYNC_IO
+			#define WLOG_ASYNC_IO WLOG_ASYNC_IO_WRITEV
+		#endif
+	#endif
+#endif
+#if (WLOG_ASYNC_IO == WLOG_ASYNC_IO_URING)
+	#include <linux/io_uring.h>
+	#include <sys/mman.h>
+	#include <sys/syscall.h>
+#endif
+
+#ifndef WLOG_ASYNC_IOV_MAX
+	#define WLOG_ASYNC_IOV_MAX 1024
+#endif
+
+//一批日志：从nStartPos到nEndPos的槽位，加上可能的一行丢弃说明
+typedef struct __wlog_iov_batch_t {
+	struct iovec iovs[WLOG_ASYNC_IOV_MAX];
+	int nIovs;
+	size_t nBytes;
+	unsigned long nStartPos;
+	unsigned long nEndPos;
+	unsigned int nTypes;
+	FILE* hFile;
+	#if WLOG_STATS
+		unsigned long long nStatsStart;	//开始写的时间，io_uring下是提交的时间
+	#endif
+	char szDropped[64];
+} __wlog_iov_batch_t;
+
+//从nPos开始收集已写好的槽位，不释放
+inline void __wlog_iov_collect_imp(__wlog_async_ctx_t* pCtx, __wlog_iov_batch_t* pBatch, unsigned long nPos) {
+	pBatch->nIovs = 0;
+	pBatch->nBytes = 0;
+	pBatch->nTypes = 0;
+	pBatch->hFile = NULL;
+	pBatch->nStartPos = nPos;
+	while (pBatch->nIovs < WLOG_ASYNC_IOV_MAX - 1) {
+		__wlog_async_slot_t* pSlot = &pCtx->slots[nPos & (WLOG_ASYNC_SLOT_COUNT - 1)];
+		if (__atomic_load_n(&pSlot->nSeq, __ATOMIC_ACQUIRE) != nPos + 1) break;
+		if (pBatch->nBytes + pSlot->nLen > WLOG_ASYNC_BATCH_SIZE) break;
+		if (pSlot->nLen > 0) {
+			pBatch->iovs[pBatch->nIovs].iov_base = pSlot->szData;
+			pBatch->iovs[pBatch->nIovs].iov_len = pSlot->nLen;
+			++pBatch->nIovs;
+		}
+		pBatch->nBytes += pSlot->nLen;
+		pBatch->nTypes |= pSlot->nType;
+		++nPos;
+	}
+	pBatch->nEndPos = nPos;
+	#if (WLOG_ASYNC_OVERFLOW == WLOG_ASYNC_DROP_COUNT)
+		size_t nDropped = __wlog_async_dropped_imp(pCtx, pBatch->szDropped);
+		if (nDropped > 0) {
+			pBatch->iovs[pBatch->nIovs].iov_base = pBatch->szDropped;
+			pBatch->iovs[pBatch->nIovs].iov_len = nDropped;
+			++pBatch->nIovs;
+			pBatch->nBytes += nDropped;
+		}
+	#endif
+}
+
+//已写出nDone字节，用writev补写剩下的部分，返回最终写出的字节数，出错返回-1
+inline long __wlog_iov_finish_imp(int hFd, __wlog_iov_batch_t* pBatch, size_t nDone) {
+	struct iovec* pIov = pBatch->iovs;
+	int nIovs = pBatch->nIovs;
+	size_t nSkip = nDone;
+	for (;;) {
+		while (nIovs > 0 && nSkip >= pIov->iov_len) {
+			nSkip -= pIov->iov_len;
+			++pIov;
+			--nIovs;
+		}
+		if (0 == nIovs) return (long)pBatch->nBytes;
+		pIov->iov_base = (char*)pIov->iov_base + nSkip;
+		pIov->iov_len -= nSkip;
+		ssize_t nRet = writev(hFd, pIov, nIovs);
+		__atomic_fetch_add(&__wlog_async_ctx()->nWrites, 1, __ATOMIC_RELAXED);
+		if (nRet < 0) {
+			if (EINTR == errno) {
+				nSkip = 0;
+				continue;
+			}
+			return -1;
+		}
+		nSkip = (size_t)nRet;
+	}
+}
+
+#if WLOG_INDEX
+	//槽位释放之前从槽位里扫描这一批，iovec可能已被补写改动过
+	inline void __wlog_iov_index_imp(__wlog_async_ctx_t* pCtx, const __wlog_iov_batch_t* pBatch, long nWritten) {
+		if (!__wlog_index_active()) return;
+		if (nWritten < 0) {
+			__wlog_index_stop_imp();
+			return;
+		}
+		__wlog_index_entry_t sum;
+		__wlog_index_entry_init(&sum, 0);
+		unsigned long nPos = pBatch->nStartPos;
+		for (; nPos != pBatch->nEndPos; ++nPos) {
+			const __wlog_async_slot_t* pSlot = &pCtx->slots[nPos & (WLOG_ASYNC_SLOT_COUNT - 1)];
+			__wlog_index_scan(&sum, pSlot->szData, pSlot->nLen);
+		}
+		__wlog_index_lock_imp();
+		if (__wlog_index_fits_locked_imp(&sum, pBatch->nBytes)) {
+			__wlog_index_add_locked_imp(&sum, pBatch->nBytes, (uint64_t)-1);
+		} else {
+			//这一批放不进当前块，按槽位逐行扫描，在日志头处切开
+			__wlog_index_entry_t part;
+			__wlog_index_entry_init(&part, 0);
+			size_t nSlotBytes = 0;
+			for (nPos = pBatch->nStartPos; nPos != pBatch->nEndPos; ++nPos) {
+				const __wlog_async_slot_t* pSlot = &pCtx->slots[nPos & (WLOG_ASYNC_SLOT_COUNT - 1)];
+				__wlog_index_feed_locked_imp(&part, pSlot->szData, pSlot->nLen);
+				nSlotBytes += pSlot->nLen;
+			}
+			//批尾丢弃计数的那一行
+			__wlog_index_feed_locked_imp(&part, pBatch->szDropped, pBatch->nBytes - nSlotBytes);
+			__wlog_index_feed_end_locked_imp(&part);
+		}
+		__wlog_index_unlock_imp();
+	}
+#endif
+
+//写完一批：刷新策略、释放槽位、推进已写出的位置
+inline void __wlog_iov_complete_imp(__wlog_async_ctx_t* pCtx, __wlog_iov_batch_t* pBatch, long nWritten) {
+	FILE* hFile = pBatch->hFile;
+	if (NULL != hFile) {
+		if (nWritten >= 0) {
+			__wlog_file_lock(hFile);
+			__wlog_flush_policy_imp(hFile, pBatch->nTypes, pBatch->nEndPos - pBatch->nStartPos, pBatch->nBytes);
+			__wlog_file_unlock(hFile);
+		}
+		__wlog_file_release_imp(hFile, nWritten);
+		#if WLOG_INDEX
+			__wlog_iov_index_imp(pCtx, pBatch, nWritten);
+		#endif
+	}
+	#if WLOG_STATS
+		if (NULL != hFile || nWritten < 0) __wlog_stats_write_imp(pBatch->nStatsStart, nWritten);
+	#endif
+	unsigned long nPos = pBatch->nStartPos;
+	for (; nPos != pBatch->nEndPos; ++nPos) {
+		__atomic_store_n(&pCtx->slots[nPos & (WLOG_ASYNC_SLOT_COUNT - 1)].nSeq, nPos + WLOG_ASYNC_SLOT_COUNT, __ATOMIC_RELEASE);
+	}
+	__atomic_store_n(&pCtx->nDequeuePos, pBatch->nEndPos, __ATOMIC_RELEASE);
+	__atomic_store_n(&pCtx->nFlushedPos, pBatch->nEndPos, __ATOMIC_RELEASE);
+}
+
+//同步写出一批
+inline void __wlog_iov_write_imp(__wlog_async_ctx_t* pCtx, __wlog_iov_batch_t* pBatch) {
+	#if WLOG_STATS
+		pBatch->nStatsStart = __wlog_stats_now_ns();
+	#endif
+	pBatch->hFile = __wlog_file_acquire_imp(1);
+	long nWritten = -1;
+	if (NULL != pBatch->hFile) {
+		nWritten = __wlog_iov_finish_imp(fileno(pBatch->hFile), pBatch, 0);
+	}
+	__wlog_iov_complete_imp(pCtx, pBatch, nWritten);
+}
+
+#if (WLOG_ASYNC_IO == WLOG_ASYNC_IO_URING)
+	//只用到一个提交项：同一时间只有一批在写
+	typedef struct __wlog_uring_t {
+		int hRing;
+		unsigned* pSqTail;
+		unsigned* pSqMask;
+		unsigned* pSqArray;
+		unsigned* pCqHead;
+		unsigned* pCqTail;
+		unsigned* pCqMask;
+		struct io_uring_sqe* pSqes;
+		struct io_uring_cqe* pCqes;
+		void* pSqMap;
+		void* pCqMap;
+		size_t nSqMap;
+		size_t nCqMap;
+		size_t nSqeMap;
+	} __wlog_uring_t;
+
+	inline void __wlog_uring_close_imp(__wlog_uring_t* pRing) {
+		if (NULL != pRing->pSqes && MAP_FAILED != (void*)pRing->pSqes) munmap(pRing->pSqes, pRing->nSqeMap);
+		if (NULL != pRing->pCqMap && MAP_FAILED != pRing->pCqMap && pRing->pCqMap != pRing->pSqMap) munmap(pRing->pCqMap, pRing->nCqMap);
+		if (NULL != pRing->pSqMap && MAP_FAILED != pRing->pSqMap) munmap(pRing->pSqMap, pRing->nSqMap);
+		if (pRing->hRing >= 0) close(pRing->hRing);
+		memset(pRing, 0, sizeof(*pRing));
+		pRing->hRing = -1;
+	}
+
+	//成功返回1，失败返回0并改用writev
+	inline int __wlog_uring_open_imp(__wlog_uring_t* pRing) {
+		struct io_uring_params params;
+		memset(pRing, 0, sizeof(*pRing));
+		memset(&params, 0, sizeof(params));
+		pRing->hRing = (int)syscall(__NR_io_uring_setup, 2, &params);
+		if (pRing->hRing < 0) return 0;
+		//需要IORING_FEAT_RW_CUR_POS才能用-1表示当前位置
+		if (!(params.features & IORING_FEAT_RW_CUR_POS)) {
+			__wlog_uring_close_imp(pRing);
+			return 0;
+		}
+		pRing->nSqMap = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+		pRing->nCqMap = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+		if (params.features & IORING_FEAT_SINGLE_MMAP) {
+			if (pRing->nCqMap > pRing->nSqMap) pRing->nSqMap = pRing->nCqMap;
+			pRing->nCqMap = pRing->nSqMap;
+		}
+		pRing->pSqMap = mmap(NULL, pRing->nSqMap, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, pRing->hRing, IORING_OFF_SQ_RING);
+		if (MAP_FAILED == pRing->pSqMap) {
+			__wlog_uring_close_imp(pRing);
+			return 0;
+		}
+		if (params.features & IORING_FEAT_SINGLE_MMAP) {
+			pRing->pCqMap = pRing->pSqMap;
+		} else {
+			pRing->pCqMap = mmap(NULL, pRing->nCqMap, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, pRing->hRing, IORING_OFF_CQ_RING);
+			if (MAP_FAILED == pRing->pCqMap) {
+				__wlog_uring_close_imp(pRing);
+				return 0;
+			}
+		}
+		pRing->nSqeMap = params.sq_entries * sizeof(struct io_uring_sqe);
+		pRing->pSqes = (struct io_uring_sqe*)mmap(NULL, pRing->nSqeMap, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, pRing->hRing, IORING_OFF_SQES);
+		if (MAP_FAILED == (void*)pRing->pSqes) {
+			__wlog_uring_close_imp(pRing);
+			return 0;
+		}
+		char* pSq = (char*)pRing->pSqMap;
+		char* pCq = (char*)pRing->pCqMap;
+		pRing->pSqTail = (unsigned*)(pSq + params.sq_off.tail);
+		pRing->pSqMask = (unsigned*)(pSq + params.sq_off.ring_mask);
+		pRing->pSqArray = (unsigned*)(pSq + params.sq_off.array);
+		pRing->pCqHead = (unsigned*)(pCq + params.cq_off.head);
+		pRing->pCqTail = (unsigned*)(pCq + params.cq_off.tail);
+		pRing->pCqMask = (unsigned*)(pCq + params.cq_off.ring_mask);
+		pRing->pCqes = (struct io_uring_cqe*)(pCq + params.cq_off.cqes);
+		return 1;
+	}
+
+	//提交一批，返回0表示提交失败，调用者改用writev
+	inline int __wlog_uring_submit_imp(__wlog_uring_t* pRing, int hFd, __wlog_iov_batch_t* pBatch) {
+		unsigned nTail = *pRing->pSqTail;
+		unsigned nIndex = nTail & *pRing->pSqMask;
+		struct io_uring_sqe* pSqe = &pRing->pSqes[nIndex];
+		memset(pSqe, 0, sizeof(*pSqe));
+		pSqe->opcode = IORING_OP_WRITEV;
+		pSqe->fd = hFd;
+		pSqe->addr = (unsigned long long)(uintptr_t)pBatch->iovs;
+		pSqe->len = (unsigned)pBatch->nIovs;
+		pSqe->off = (unsigned long long)-1;
+		pRing->pSqArray[nIndex] = nIndex;
+		__atomic_store_n(pRing->pSqTail, nTail + 1, __ATOMIC_RELEASE);
+		for (;;) {
+			int nRet = (int)syscall(__NR_io_uring_enter, pRing->hRing, 1, 0, 0, NULL, 0);
+			if (nRet >= 0) break;
+			if (EINTR == errno) continue;
+			return 0;
+		}
+		__atomic_fetch_add(&__wlog_async_ctx()->nWrites, 1, __ATOMIC_RELAXED);
+		return 1;
+	}
+
+	//等待并收取上一批的结果，返回写出的字节数或-errno
+	inline int __wlog_uring_reap_imp(__wlog_uring_t* pRing) {
+		for (;;) {
+			unsigned nHead = *pRing->pCqHead;
+			if (nHead != __atomic_load_n(pRing->pCqTail, __ATOMIC_ACQUIRE)) {
+				int nRes = pRing->pCqes[nHead & *pRing->pCqMask].res;
+				__atomic_store_n(pRing->pCqHead, nHead + 1, __ATOMIC_RELEASE);
+				return nRes;
+			}
+			if (syscall(__NR_io_uring_enter, pRing->hRing, 0, 1, IORING_ENTER_GETEVENTS, NULL, 0) < 0 && EINTR != errno) {
+				return -errno;
+			}
+		}
+	}
+#endif
+
+//两批轮流使用：一批在写，另一批收集
+inline void* __wlog_async_writer_imp(void* pArg) {
+	__wlog_async_ctx_t* pCtx = __wlog_async_ctx();
+	(void)pArg;
+	static __wlog_iov_batch_t g_wlogIovBatches[2];
+	int nCurrent = 0;
+	unsigned long nPos = pCtx->nDequeuePos;
+	#if (WLOG_ASYNC_IO == WLOG_ASYNC_IO_URING)
+		__wlog_uring_t ring;
+		int bUring = __wlog_uring_open_imp(&ring);
+		__wlog_iov_batch_t* pInflight = NULL;
+	#endif
+	for (;;) {
+		__wlog_iov_batch_t* pBatch = &g_wlogIovBatches[nCurrent];
+		__wlog_iov_collect_imp(pCtx, pBatch, nPos);
+		nPos = pBatch->nEndPos;
+		#if (WLOG_ASYNC_IO == WLOG_ASYNC_IO_URING)
+			if (NULL != pInflight) {
+				int nRes = __wlog_uring_reap_imp(&ring);
+				long nWritten = -1;
+				if (nRes >= 0) {
+					nWritten = __wlog_iov_finish_imp(fileno(pInflight->hFile), pInflight, (size_t)nRes);
+				} else if (-EINVAL == nRes || -EOPNOTSUPP == nRes) {
+					//内核不支持IORING_OP_WRITEV，这批与以后都用writev
+					nWritten = __wlog_iov_finish_imp(fileno(pInflight->hFile), pInflight, 0);
+					__wlog_uring_close_imp(&ring);
+					bUring = 0;
+				}
+				__wlog_iov_complete_imp(pCtx, pInflight, nWritten);
+				pInflight = NULL;
+			}
+			if (bUring && pBatch->nIovs > 0) {
+				#if WLOG_STATS
+					pBatch->nStatsStart = __wlog_stats_now_ns();
+				#endif
+				pBatch->hFile = __wlog_file_acquire_imp(1);
+				if (NULL != pBatch->hFile && __wlog_uring_submit_imp(&ring, fileno(pBatch->hFile), pBatch)) {
+					pInflight = pBatch;
+					nCurrent ^= 1;
+					continue;
+				}
+				if (NULL != pBatch->hFile) __wlog_file_release_imp(pBatch->hFile, 0);
+				__wlog_uring_close_imp(&ring);
+				bUring = 0;
+			}
+		#endif
+		if (pBatch->nIovs > 0) {
+			__wlog_iov_write_imp(pCtx, pBatch);
+			continue;
+		}
+		__wlog_iov_complete_imp(pCtx, pBatch, 0);
+		if (__atomic_load_n(&pCtx->bStop, __ATOMIC_ACQUIRE)) break;
+		__wlog_async_wait_imp(pCtx, nPos);
+	}
+	#if (WLOG_ASYNC_IO == WLOG_ASYNC_IO_URING)
+		if (bUring) __wlog_uring_close_imp(&ring);
+	#endif
+	return NULL;
+}
+
+#endif //__WLOG_WRITEV_H__
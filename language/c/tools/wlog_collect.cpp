@@ -0,0 +1,58 @@
+/**
+ * @file wlog_collect.cpp
+ * @brief WLOG_TO_SHM的收集进程：把共享内存环形队列里的日志写进切换的日志文件，队列格式见inc/wlog_shm.h.
+ * <pre>编译运行：
+		g++ -O2 -I../inc wlog_collect.cpp -o wlog_collect -lpthread -lrt && ./wlog_collect /wlog.default w.log
+		默认每256M切换一次文件、保留7个，每64K或200毫秒写一次文件，可在编译时用-DWLOG_ROTATE_SIZE=...等修改；
+		WLOG_SHM_SLOT_COUNT、WLOG_SHM_RECORD_SIZE必须与写日志的进程相同。
+		先启动或后启动都可以，收到SIGINT、SIGTERM后取完队列里的日志、刷新文件再退出。
+		写日志的进程崩溃时写了一半的日志会被跳过，文件里记一行"WLOG SHM SKIPPED n TORN SLOTS"。
+	</pre>
+ * @os linux
+ */
+#include <signal.h>
+#include <stdio.h>
+
+static const char* g_szCollectFile = "wlog.collect.log";
+
+#define WLOG_TO WLOG_TO_FILE
+#define WLOG_FILE_NAME g_szCollectFile
+#define WLOG_SHM_COLLECTOR 1
+#ifndef WLOG_ROTATE_SIZE
+	#define WLOG_ROTATE_SIZE (256UL * 1024 * 1024)
+#endif
+#ifndef WLOG_FLUSH_RECORDS
+	#define WLOG_FLUSH_RECORDS 0
+#endif
+#ifndef WLOG_FLUSH_BYTES
+	#define WLOG_FLUSH_BYTES (64 * 1024)
+#endif
+#ifndef WLOG_FLUSH_INTERVAL_MS
+	#define WLOG_FLUSH_INTERVAL_MS 200
+#endif
+#include <wlog.h>
+
+static volatile int g_bStop = 0;
+
+static void collect_on_signal(int nSignal) {
+	(void)nSignal;
+	g_bStop = 1;
+}
+
+int main(int argc, char* argv[]) {
+	if (argc < 3) {
+		fprintf(stderr, "usage: %s <shm name> <log file>\n", argv[0]);
+		return 1;
+	}
+	g_szCollectFile = argv[2];
+	struct sigaction stAction;
+	memset(&stAction, 0, sizeof(stAction));
+	stAction.sa_handler = collect_on_signal;
+	sigaction(SIGINT, &stAction, NULL);
+	sigaction(SIGTERM, &stAction, NULL);
+	if (0 != wlogShmCollect(argv[1], &g_bStop)) {
+		fprintf(stderr, "can't open %s, or another collector is running\n", argv[1]);
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,198 @@
+/**
+ * @file wlog_decode.cpp
+ * @brief 把WLOG_BINARY模式写出的二进制日志还原成与文本模式相同的日志，格式见inc/wlog_binary.h.
+ * <pre>编译运行：
+		g++ -O2 -I../inc wlog_decode.cpp -o wlog_decode && ./wlog_decode wlog.bin [输出文件]
+		不给输出文件时输出到标准输出。文件末尾不完整的记录(如进程崩溃时只写了一半)会被忽略。
+		参数按inc/wlog_bin_arg.h的__wlog_bin_format还原，与WLOG_FLIGHT写出时的规则相同。
+	</pre>
+ * @os linux
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <string>
+#include <vector>
+#include <wlog_bin_arg.h>
+
+#define WLOG_BIN_MAGIC		"WLOGBIN1"
+#define WLOG_BIN_SESSION	'M'
+#define WLOG_BIN_SITE		'S'
+#define WLOG_BIN_RECORD		'R'
+#define WLOG_BIN_TEXT		'T'
+#define WLOG_BIN_HEAD_SIZE	5
+
+struct decode_site_t {
+	int bValid;
+	char chType;
+	uint32_t nLine;
+	std::string strFile;
+	std::string strFormat;
+};
+
+//按记录顺序读取，越界时bOk置0
+struct decode_reader_t {
+	const unsigned char* pData;
+	size_t nLen;
+	size_t nPos;
+	int bOk;
+	template <typename T> T get() {
+		T value = T();
+		if (nPos + sizeof(T) > nLen) {
+			bOk = 0;
+			return value;
+		}
+		memcpy(&value, pData + nPos, sizeof(T));
+		nPos += sizeof(T);
+		return value;
+	}
+	std::string get_string() {
+		uint32_t nSize = get<uint32_t>();
+		if (!bOk || nPos + nSize > nLen) {
+			bOk = 0;
+			return std::string();
+		}
+		std::string strValue((const char*)pData + nPos, nSize);
+		nPos += nSize;
+		return strValue;
+	}
+};
+
+static int g_nPrecision = 3;
+static std::vector<decode_site_t> g_vecSites;
+
+static void decode_time(FILE* hOut, uint64_t nTimeNs) {
+	time_t nSecond = (time_t)(nTimeNs / 1000000000ULL);
+	unsigned long nNs = (unsigned long)(nTimeNs % 1000000000ULL);
+	struct tm tmNow;
+	if (NULL == localtime_r(&nSecond, &tmNow)) {
+		fputs("<error time>", hOut);
+		return;
+	}
+	fprintf(hOut, "%02d-%02d %02d:%02d:%02d", tmNow.tm_mon + 1, tmNow.tm_mday, tmNow.tm_hour, tmNow.tm_min, tmNow.tm_sec);
+	if (3 == g_nPrecision) {
+		fprintf(hOut, ".%03lu", nNs / 1000000);
+	} else if (6 == g_nPrecision) {
+		fprintf(hOut, ".%06lu", nNs / 1000);
+	}
+}
+
+//校验参数区并数出参数个数，类型或长度不对时返回0
+static int decode_args(const char* pArgs, size_t nArgs, unsigned int* pCount) {
+	const char* pEnd = pArgs + nArgs;
+	__wlog_bin_value_t value;
+	*pCount = 0;
+	while (pArgs < pEnd) {
+		if (!__wlog_bin_next(&pArgs, pEnd, &value)) return 0;
+		++*pCount;
+	}
+	return 1;
+}
+
+//按格式串还原参数，与wlog_flight.h写出时用同一个__wlog_bin_format；放不下时加大缓冲重新还原
+static void decode_format(FILE* hOut, const std::string& strFormat, const char* pArgs, size_t nArgs) {
+	static std::vector<char> vecText(64 * 1024);
+	size_t nLen = __wlog_bin_format(&vecText[0], vecText.size(), strFormat.c_str(), pArgs, nArgs);
+	while (nLen + 1 >= vecText.size() && vecText.size() < 64 * 1024 * 1024) {
+		vecText.resize(vecText.size() * 2);
+		nLen = __wlog_bin_format(&vecText[0], vecText.size(), strFormat.c_str(), pArgs, nArgs);
+	}
+	fwrite(&vecText[0], 1, nLen, hOut);
+}
+
+//返回0表示记录格式错误
+static int decode_record(FILE* hOut, char chKind, const unsigned char* pData, size_t nLen) {
+	decode_reader_t reader = {pData, nLen, 0, 1};
+	switch (chKind) {
+	case WLOG_BIN_SESSION:
+		if (nLen < 9 || 0 != memcmp(pData, WLOG_BIN_MAGIC, 8)) return 0;
+		g_nPrecision = pData[8];
+		fputs("\n++++++++++WLOG+++++++++++\n", hOut);
+		return 1;
+	case WLOG_BIN_SITE: {
+		uint32_t nId = reader.get<uint32_t>();
+		reader.get<uint32_t>();
+		decode_site_t site;
+		site.bValid = 1;
+		site.nLine = reader.get<uint32_t>();
+		site.chType = (char)reader.get<uint8_t>();
+		site.strFile = reader.get_string();
+		site.strFormat = reader.get_string();
+		if (!reader.bOk) return 0;
+		if (nId >= g_vecSites.size()) g_vecSites.resize(nId + 1);
+		g_vecSites[nId] = site;
+		return 1;
+	}
+	case WLOG_BIN_RECORD: {
+		uint32_t nId = reader.get<uint32_t>();
+		uint64_t nTimeNs = reader.get<uint64_t>();
+		const char* pArgs = (const char*)pData + reader.nPos;
+		size_t nArgs = nLen - reader.nPos;
+		unsigned int nCount = 0;
+		if (!reader.bOk || !decode_args(pArgs, nArgs, &nCount)) return 0;
+		decode_time(hOut, nTimeNs);
+		if (nId >= g_vecSites.size() || !g_vecSites[nId].bValid) {
+			fprintf(hOut, " ? <unknown site %u>| <%u args>\n", nId, nCount);
+			return 1;
+		}
+		const decode_site_t& site = g_vecSites[nId];
+		fprintf(hOut, " %c %s:%-4d| ", site.chType, site.strFile.c_str(), (int)site.nLine);
+		decode_format(hOut, site.strFormat, pArgs, nArgs);
+		fputc('\n', hOut);
+		return 1;
+	}
+	case WLOG_BIN_TEXT:
+		fwrite(pData, 1, nLen, hOut);
+		return 1;
+	default:
+		return 0;
+	}
+}
+
+int main(int argc, char* argv[]) {
+	if (argc < 2) {
+		fprintf(stderr, "usage: %s <binary log> [output]\n", argv[0]);
+		return 1;
+	}
+	FILE* hIn = fopen(argv[1], "rb");
+	if (NULL == hIn) {
+		perror(argv[1]);
+		return 1;
+	}
+	FILE* hOut = (argc > 2) ? fopen(argv[2], "w") : stdout;
+	if (NULL == hOut) {
+		perror(argv[2]);
+		return 1;
+	}
+	std::vector<unsigned char> vecRecord;
+	unsigned long nRecords = 0;
+	long nOffset = 0;
+	for (;;) {
+		unsigned char szHead[WLOG_BIN_HEAD_SIZE];
+		size_t nRead = fread(szHead, 1, WLOG_BIN_HEAD_SIZE, hIn);
+		if (0 == nRead) break;
+		uint32_t nSize = 0;
+		memcpy(&nSize, szHead, 4);
+		if (nRead < WLOG_BIN_HEAD_SIZE || nSize < WLOG_BIN_HEAD_SIZE) {
+			fprintf(stderr, "truncated record at offset %ld\n", nOffset);
+			break;
+		}
+		vecRecord.resize(nSize - WLOG_BIN_HEAD_SIZE);
+		if (vecRecord.size() > 0 && fread(&vecRecord[0], 1, vecRecord.size(), hIn) != vecRecord.size()) {
+			fprintf(stderr, "truncated record at offset %ld\n", nOffset);
+			break;
+		}
+		if (!decode_record(hOut, (char)szHead[4], vecRecord.empty() ? NULL : &vecRecord[0], vecRecord.size())) {
+			fprintf(stderr, "bad record '%c' at offset %ld\n", szHead[4], nOffset);
+			break;
+		}
+		nOffset += nSize;
+		++nRecords;
+	}
+	fprintf(stderr, "%lu records\n", nRecords);
+	fclose(hIn);
+	if (hOut != stdout) fclose(hOut);
+	return 0;
+}
@@ -0,0 +1,323 @@
+/**
+ * @file wlog_query.cpp
+ * @brief 按时间范围、级别、子串查询文本或JSON日志，有WLOG_INDEX写的索引时只扫描可能匹配的块，索引格式见inc/wlog_index.h.
+ * <pre>编译运行：
+		g++ -O2 -I../inc wlog_query.cpp -o wlog_query && ./wlog_query [-f 开始时间] [-t 结束时间] [-l 级别] [-s 子串] [-c] w.log [索引文件]
+		时间按日志里的样子写"MM-DD HH:MM:SS.mmm"，可以只写前面一部分，如-f "10-17 18" -t "10-17 18:30"，
+		开始时间缺的部分补0，结束时间缺的部分补到最大，都包含在内；前面带年份"2026-10-17 ..."时忽略年份。
+		级别是logBase的级别字符，如-l EWF；子串区分大小写，整条日志(含logXXXN的数据行)里出现就算匹配；-c只输出条数。
+		不给索引文件时用w.log.idx，没有索引或索引不属于这个文件时整个文件扫描。
+		日志文件整个mmap进来，先按时间在索引里二分找到范围，再跳过时间、级别不符的块，剩下的部分有子串时
+		先用SSE2找子串，找到后才解析所在的那条日志。匹配的日志原样输出到标准输出，统计输出到标准错误。
+	</pre>
+ * @os linux
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+#if defined(__SSE2__)
+	#include <emmintrin.h>
+#endif
+#include <wlog_index.h>
+
+struct query_t {
+	int bTime;
+	uint64_t nFrom;
+	uint64_t nTo;
+	uint32_t nLevels;		//0表示不按级别
+	const char* szNeedle;
+	size_t nNeedle;
+	int bCount;
+	unsigned long nMatched;
+	uint64_t nScanned;
+};
+
+struct query_range_t {
+	uint64_t nBegin;
+	uint64_t nEnd;
+};
+
+//"MM-DD HH:MM:SS.ffffff"的前面一部分，bEnd时缺的部分补到最大，返回0表示格式错误
+static int query_parse_time(const char* szTime, int bEnd, uint64_t* pKey) {
+	const char* p = szTime;
+	if (strlen(p) > 5 && '-' == p[4] && __wlog_index_digits(p, 4) >= 0) p += 5;
+	int nFields[5] = {0, 0, bEnd ? 23 : 0, bEnd ? 59 : 0, bEnd ? 59 : 0};
+	const char* szSeps = "- ::";
+	int nField = 0;
+	for (; nField < 5; ++nField) {
+		if (nField > 0) {
+			if (0 == *p) break;
+			if (*p != szSeps[nField - 1] && !(2 == nField && 'T' == *p)) return 0;
+			++p;
+		}
+		nFields[nField] = __wlog_index_digits(p, 2);
+		if (nFields[nField] < 0) return 0;
+		p += 2;
+	}
+	if (nField < 2 || nFields[0] < 1 || nFields[0] > 12 || nFields[1] < 1 || nFields[1] > 31) return 0;
+	uint32_t nMicro = 0, nScale = 100000;
+	if ('.' == *p) {
+		for (++p; *p >= '0' && *p <= '9' && nScale > 0; ++p) {
+			nMicro += (uint32_t)(*p - '0') * nScale;
+			nScale /= 10;
+		}
+	} else if (5 == nField && 0 != *p) {
+		return 0;
+	}
+	if (bEnd) nMicro += (nScale > 0) ? nScale * 10 - 1 : 0;
+	*pKey = (((((uint64_t)nFields[0] * 32 + nFields[1]) * 24 + nFields[2]) * 60 + nFields[3]) * 60 + nFields[4]) * 1000000 + nMicro;
+	return 1;
+}
+
+//在[p, pEnd)里找子串：SSE2每次比较16个位置的首尾字符，都相同时再比较中间
+static const char* query_find(const char* p, const char* pEnd, const char* szNeedle, size_t nNeedle) {
+	if ((size_t)(pEnd - p) < nNeedle) return NULL;
+	if (1 == nNeedle) return (const char*)memchr(p, szNeedle[0], (size_t)(pEnd - p));
+	#if defined(__SSE2__)
+		const __m128i vFirst = _mm_set1_epi8(szNeedle[0]);
+		const __m128i vLast = _mm_set1_epi8(szNeedle[nNeedle - 1]);
+		while ((size_t)(pEnd - p) >= 16 + nNeedle - 1) {
+			__m128i vHead = _mm_loadu_si128((const __m128i*)p);
+			__m128i vTail = _mm_loadu_si128((const __m128i*)(p + nNeedle - 1));
+			unsigned int nMask = (unsigned int)_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(vHead, vFirst), _mm_cmpeq_epi8(vTail, vLast)));
+			while (0 != nMask) {
+				int nBit = __builtin_ctz(nMask);
+				if (0 == memcmp(p + nBit + 1, szNeedle + 1, nNeedle - 2)) return p + nBit;
+				nMask &= nMask - 1;
+			}
+			p += 16;
+		}
+	#endif
+	const char* pLast = pEnd - nNeedle;
+	for (; p <= pLast; ++p) {
+		if (szNeedle[0] == *p && 0 == memcmp(p + 1, szNeedle + 1, nNeedle - 1)) return p;
+	}
+	return NULL;
+}
+
+static const char* query_next_line(const char* p, const char* pEnd) {
+	const char* pLf = (const char*)memchr(p, '\n', (size_t)(pEnd - p));
+	return (NULL == pLf) ? pEnd : pLf + 1;
+}
+
+static int query_is_head(const char* p, const char* pEnd) {
+	uint64_t nKey;
+	return 0 != __wlog_index_parse_head(p, (size_t)(pEnd - p), &nKey);
+}
+
+//没有日志头的行(文件开头的标记行、logText)只在不按时间、级别查询时匹配
+static int query_match_head(const query_t* pQuery, const char* p, const char* pEnd) {
+	uint64_t nKey = 0;
+	char chLevel = __wlog_index_parse_head(p, (size_t)(pEnd - p), &nKey);
+	if (0 == chLevel) return !pQuery->bTime && 0 == pQuery->nLevels;
+	if (pQuery->bTime && (nKey < pQuery->nFrom || nKey > pQuery->nTo)) return 0;
+	if (0 != pQuery->nLevels && 0 == (pQuery->nLevels & __wlog_index_level_bit(chLevel))) return 0;
+	return 1;
+}
+
+static int query_match_block(const query_t* pQuery, const __wlog_index_entry_t* pEntry) {
+	if (0 != pQuery->nLevels && 0 == (pQuery->nLevels & pEntry->nLevels)) return 0;
+	if (pQuery->bTime && (pEntry->nTimeMax < pQuery->nFrom || pEntry->nTimeMin > pQuery->nTo)) return 0;
+	return 1;
+}
+
+static void query_output(query_t* pQuery, const char* pRecord, const char* pEnd) {
+	++pQuery->nMatched;
+	if (!pQuery->bCount) fwrite(pRecord, 1, (size_t)(pEnd - pRecord), stdout);
+}
+
+//从p开始的一条日志：日志头那一行加上后面不是日志头的行
+static const char* query_record_end(const char* p, const char* pEnd) {
+	for (p = query_next_line(p, pEnd); p < pEnd && !query_is_head(p, pEnd); p = query_next_line(p, pEnd)) {
+	}
+	return p;
+}
+
+//扫描一段连续的日志，段首不是日志头的行单独算一条
+static void query_scan(query_t* pQuery, const char* pBegin, const char* pEnd) {
+	pQuery->nScanned += (uint64_t)(pEnd - pBegin);
+	const char* p = pBegin;
+	if (0 == pQuery->nNeedle) {
+		while (p < pEnd) {
+			const char* pRecordEnd = query_record_end(p, pEnd);
+			if (query_match_head(pQuery, p, pEnd)) query_output(pQuery, p, pRecordEnd);
+			p = pRecordEnd;
+		}
+		return;
+	}
+	//有子串时先找子串，找到后往前找到所在日志的日志头，只解析这些日志
+	while (p < pEnd) {
+		const char* pHit = query_find(p, pEnd, pQuery->szNeedle, pQuery->nNeedle);
+		if (NULL == pHit) break;
+		const char* pRecord = pHit;
+		for (;;) {
+			while (pRecord > p && '\n' != pRecord[-1]) --pRecord;
+			if (pRecord == p || query_is_head(pRecord, pEnd)) break;
+			--pRecord;
+		}
+		const char* pRecordEnd = query_record_end(pRecord, pEnd);
+		if (query_match_head(pQuery, pRecord, pEnd)) query_output(pQuery, pRecord, pRecordEnd);
+		p = pRecordEnd;
+	}
+}
+
+static void query_add_range(std::vector<query_range_t>* pRanges, uint64_t nBegin, uint64_t nEnd) {
+	if (nBegin >= nEnd) return;
+	if (!pRanges->empty() && pRanges->back().nEnd == nBegin) {
+		pRanges->back().nEnd = nEnd;
+		return;
+	}
+	query_range_t range = {nBegin, nEnd};
+	pRanges->push_back(range);
+}
+
+static bool query_entry_less(const __wlog_index_entry_t& left, const __wlog_index_entry_t& right) {
+	return left.nOffset < right.nOffset;
+}
+
+//读索引，不属于这个日志文件时返回0
+static int query_load_index(const char* szIndex, const struct stat* pLog, std::vector<__wlog_index_entry_t>* pEntries) {
+	FILE* hIndex = fopen(szIndex, "rb");
+	if (NULL == hIndex) return 0;
+	__wlog_index_head_t head;
+	int bOk = (1 == fread(&head, sizeof(head), 1, hIndex)) && 0 == memcmp(head.szMagic, WLOG_INDEX_MAGIC, 8)
+		&& head.nEntrySize == sizeof(__wlog_index_entry_t) && head.nDev == (uint64_t)pLog->st_dev && head.nIno == (uint64_t)pLog->st_ino;
+	__wlog_index_entry_t entry;
+	while (bOk && 1 == fread(&entry, sizeof(entry), 1, hIndex)) {
+		if (entry.nLength > 0 && entry.nOffset + entry.nLength <= (uint64_t)pLog->st_size) pEntries->push_back(entry);
+	}
+	fclose(hIndex);
+	return bOk;
+}
+
+int main(int argc, char* argv[]) {
+	query_t query;
+	memset(&query, 0, sizeof(query));
+	query.nTo = (uint64_t)-1;
+	int nOpt;
+	while (-1 != (nOpt = getopt(argc, argv, "f:t:l:s:c"))) {
+		switch (nOpt) {
+		case 'f':
+		case 't':
+			if (!query_parse_time(optarg, 't' == nOpt, ('t' == nOpt) ? &query.nTo : &query.nFrom)) {
+				fprintf(stderr, "bad time \"%s\", use \"MM-DD HH:MM:SS.mmm\" or a prefix of it\n", optarg);
+				return 1;
+			}
+			query.bTime = 1;
+			break;
+		case 'l':
+			for (const char* p = optarg; *p; ++p) query.nLevels |= __wlog_index_level_bit(*p);
+			break;
+		case 's':
+			query.szNeedle = optarg;
+			query.nNeedle = strlen(optarg);
+			break;
+		case 'c':
+			query.bCount = 1;
+			break;
+		default:
+			fprintf(stderr, "usage: %s [-f from] [-t to] [-l levels] [-s substring] [-c] <log file> [index file]\n", argv[0]);
+			return 1;
+		}
+	}
+	if (optind >= argc) {
+		fprintf(stderr, "usage: %s [-f from] [-t to] [-l levels] [-s substring] [-c] <log file> [index file]\n", argv[0]);
+		return 1;
+	}
+	struct timespec tsStart;
+	clock_gettime(CLOCK_MONOTONIC, &tsStart);
+	const char* szLog = argv[optind];
+	std::string strIndex = (optind + 1 < argc) ? std::string(argv[optind + 1]) : std::string(szLog) + WLOG_INDEX_SUFFIX;
+	int hLog = open(szLog, O_RDONLY | O_CLOEXEC);
+	struct stat stLog;
+	if (hLog < 0 || 0 != fstat(hLog, &stLog)) {
+		perror(szLog);
+		return 1;
+	}
+	uint64_t nSize = (uint64_t)stLog.st_size;
+	const char* pData = NULL;
+	if (nSize > 0) {
+		void* pMap = mmap(NULL, (size_t)nSize, PROT_READ, MAP_PRIVATE, hLog, 0);
+		if (MAP_FAILED == pMap) {
+			perror(szLog);
+			return 1;
+		}
+		pData = (const char*)pMap;
+	}
+	std::vector<__wlog_index_entry_t> vecEntries;
+	if (!query_load_index(strIndex.c_str(), &stLog, &vecEntries)) {
+		if (0 == access(strIndex.c_str(), F_OK)) fprintf(stderr, "%s doesn't belong to %s, scanning the whole file\n", strIndex.c_str(), szLog);
+		vecEntries.clear();
+	}
+	//多个进程写同一个文件时索引项不一定按偏移排列；丢掉与前面重叠的项
+	if (!std::is_sorted(vecEntries.begin(), vecEntries.end(), query_entry_less)) {
+		std::sort(vecEntries.begin(), vecEntries.end(), query_entry_less);
+	}
+	std::vector<__wlog_index_entry_t> vecBlocks;
+	for (size_t nIdx = 0; nIdx < vecEntries.size(); ++nIdx) {
+		if (vecBlocks.empty() || vecEntries[nIdx].nOffset >= vecBlocks.back().nOffset + vecBlocks.back().nLength) vecBlocks.push_back(vecEntries[nIdx]);
+	}
+	//块之间的时间大体递增但可能交错：按最晚时间的前缀最大值、最早时间的后缀最小值二分，得到可能匹配的块的范围
+	size_t nBlocks = vecBlocks.size();
+	size_t nFirst = 0, nLast = nBlocks;
+	if (query.bTime && nBlocks > 0) {
+		std::vector<uint64_t> vecMaxSoFar(nBlocks), vecMinAfter(nBlocks);
+		for (size_t nIdx = 0; nIdx < nBlocks; ++nIdx) {
+			uint64_t nTimeMax = (vecBlocks[nIdx].nRecords > 0) ? vecBlocks[nIdx].nTimeMax : 0;
+			vecMaxSoFar[nIdx] = (nIdx > 0 && vecMaxSoFar[nIdx - 1] > nTimeMax) ? vecMaxSoFar[nIdx - 1] : nTimeMax;
+		}
+		for (size_t nIdx = nBlocks; nIdx-- > 0;) {
+			uint64_t nTimeMin = vecBlocks[nIdx].nTimeMin;
+			vecMinAfter[nIdx] = (nIdx + 1 < nBlocks && vecMinAfter[nIdx + 1] < nTimeMin) ? vecMinAfter[nIdx + 1] : nTimeMin;
+		}
+		nFirst = (size_t)(std::lower_bound(vecMaxSoFar.begin(), vecMaxSoFar.end(), query.nFrom) - vecMaxSoFar.begin());
+		nLast = (size_t)(std::upper_bound(vecMinAfter.begin(), vecMinAfter.end(), query.nTo) - vecMinAfter.begin());
+	}
+	//索引没有覆盖的部分总是扫描；跳过的块紧接在要扫描的部分后面时，块开头不是日志头的行属于前一条日志，一起扫描
+	std::vector<query_range_t> vecRanges;
+	uint64_t nPos = 0;
+	unsigned long nSkipped = 0;
+	for (size_t nIdx = 0; nIdx < nBlocks; ++nIdx) {
+		const __wlog_index_entry_t* pBlock = &vecBlocks[nIdx];
+		query_add_range(&vecRanges, nPos, pBlock->nOffset);
+		uint64_t nBlockEnd = pBlock->nOffset + pBlock->nLength;
+		if (nIdx >= nFirst && nIdx < nLast && query_match_block(&query, pBlock)) {
+			query_add_range(&vecRanges, pBlock->nOffset, nBlockEnd);
+		} else {
+			++nSkipped;
+			if (!vecRanges.empty() && vecRanges.back().nEnd == pBlock->nOffset) {
+				const char* p = pData + pBlock->nOffset;
+				const char* pEnd = pData + nBlockEnd;
+				while (p < pEnd && !query_is_head(p, pEnd)) p = query_next_line(p, pEnd);
+				query_add_range(&vecRanges, pBlock->nOffset, (uint64_t)(p - pData));
+			}
+		}
+		nPos = nBlockEnd;
+	}
+	query_add_range(&vecRanges, nPos, nSize);
+	static char szOut[1 << 20];
+	setvbuf(stdout, szOut, _IOFBF, sizeof(szOut));
+	long nPage = sysconf(_SC_PAGESIZE);
+	for (size_t nIdx = 0; nIdx < vecRanges.size(); ++nIdx) {
+		uint64_t nAligned = vecRanges[nIdx].nBegin / nPage * nPage;
+		madvise((void*)(pData + nAligned), (size_t)(vecRanges[nIdx].nEnd - nAligned), MADV_WILLNEED);
+		query_scan(&query, pData + vecRanges[nIdx].nBegin, pData + vecRanges[nIdx].nEnd);
+	}
+	if (query.bCount) printf("%lu\n", query.nMatched);
+	fflush(stdout);
+	struct timespec tsEnd;
+	clock_gettime(CLOCK_MONOTONIC, &tsEnd);
+	fprintf(stderr, "%lu records, scanned %llu of %llu bytes, skipped %lu of %lu blocks, %.1f ms\n", query.nMatched,
+		(unsigned long long)query.nScanned, (unsigned long long)nSize, nSkipped, (unsigned long)nBlocks,
+		(tsEnd.tv_sec - tsStart.tv_sec) * 1e3 + (tsEnd.tv_nsec - tsStart.tv_nsec) / 1e6);
+	return 0;
+}